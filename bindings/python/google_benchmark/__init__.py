@@ -20,14 +20,15 @@ Example usage:
   def my_benchmark(state):
       ...  # Code executed outside `while` loop is not timed.
 
-      while state:
-        ...  # Code executed within `while` loop is timed.
+      for _ in state:
+        ...  # Code executed within the loop is timed.
 
   if __name__ == '__main__':
     benchmark.main()
 """
 
 import atexit
+import time
 
 from google_benchmark import _benchmark
 from google_benchmark._benchmark import (
@@ -120,17 +121,43 @@ def register(undefined=None, *, name=None):
     return options.func
 
 
+def _iteration_overhead_ns(iterations: int = 1_000_000, runs: int = 5) -> float:
+    """Time of an empty `for _ in state` iteration, which is not subtracted
+    from the results."""
+    best = float("inf")
+    for _ in range(runs):
+        start = time.perf_counter_ns()
+        for _ in _benchmark._countdown(iterations):
+            pass
+        best = min(best, time.perf_counter_ns() - start)
+    return best / iterations
+
+
+_calibrated = False
+
+
+def run_benchmarks() -> None:
+    """Run the registered benchmarks, after adding the per-iteration overhead
+    of the binding to the context as `python_iteration_overhead_ns`."""
+    global _calibrated
+    if not _calibrated:
+        _calibrated = True
+        _benchmark.AddCustomContext(
+            "python_iteration_overhead_ns", f"{_iteration_overhead_ns():.2f}"
+        )
+    return _benchmark.RunSpecifiedBenchmarks()
+
+
 def main(argv: list[str] | None = None) -> None:
     import sys
 
     _benchmark.Initialize(argv or sys.argv)
-    return _benchmark.RunSpecifiedBenchmarks()
+    return run_benchmarks()
 
 
 # FIXME: can we rerun with disabled ASLR?
 
 # Methods for use with custom main function.
 initialize = _benchmark.Initialize
-run_benchmarks = _benchmark.RunSpecifiedBenchmarks
 add_custom_context = _benchmark.AddCustomContext
 atexit.register(_benchmark.ClearRegisteredBenchmarks)
@@ -42,6 +42,48 @@ benchmark::Benchmark* RegisterBenchmark(const std::string& name,
       name, [f](benchmark::State& state) { f(&state); });
 }
 
+// Claims the iterations left in the current run with KeepRunningBatch() and
+// returns how many there are, or 0 once the run is over. While latencies are
+// sampled, every iteration is a batch of its own.
+benchmark::IterationCount NextBatch(benchmark::State& state) {
+  if (!state.KeepRunningBatch(1)) {
+    return 0;
+  }
+  const benchmark::IterationCount rest =
+      state.max_iterations - state.iterations();
+  if (rest > 0) {
+    state.KeepRunningBatch(rest);
+  }
+  return 1 + rest;
+}
+
+// The iterator of `for _ in state`. It counts down the batches claimed with
+// NextBatch(), so the loop only calls into the library once per batch. Without
+// a state, it counts down `remaining` iterations and stops, which measures the
+// cost of the loop itself.
+struct StateIterator {
+  benchmark::State* state;
+  benchmark::IterationCount remaining;
+};
+
+PyObject* StateIteratorNext(PyObject* self) {
+  StateIterator* it = nb::inst_ptr<StateIterator>(self);
+  if (it->remaining == 0 || (it->state != nullptr && it->state->skipped())) {
+    it->remaining = it->state != nullptr ? NextBatch(*it->state) : 0;
+    if (it->remaining == 0) {
+      // Ends the loop without raising StopIteration.
+      return nullptr;
+    }
+  }
+  --it->remaining;
+  Py_RETURN_NONE;
+}
+
+PyType_Slot state_iterator_slots[] = {
+    {Py_tp_iter, reinterpret_cast<void*>(PyObject_SelfIter)},
+    {Py_tp_iternext, reinterpret_cast<void*>(StateIteratorNext)},
+    {0, nullptr}};
+
 NB_MODULE(_benchmark, m) {
   using benchmark::TimeUnit;
   nb::enum_<TimeUnit>(m, "TimeUnit")
@@ -145,9 +187,20 @@ NB_MODULE(_benchmark, m) {
 
   nb::bind_map<benchmark::UserCounters>(m, "UserCounters");
 
+  // The slots are called straight from the bytecode of the `for` loop,
+  // without going through nanobind's method dispatch.
+  nb::class_<StateIterator>(m, "_StateIterator",
+                            nb::type_slots(state_iterator_slots));
+
   using benchmark::State;
   nb::class_<State>(m, "State")
       .def("__bool__", &State::KeepRunning)
+      .def(
+          "__iter__",
+          [](State& state) {
+            return StateIterator{&state, /*remaining=*/0};
+          },
+          nb::keep_alive<0, 1>())
       .def_prop_ro("keep_running", &State::KeepRunning)
       .def("pause_timing", &State::PauseTiming)
       .def("resume_timing", &State::ResumeTiming)
@@ -181,6 +234,9 @@ NB_MODULE(_benchmark, m) {
   m.def("RunSpecifiedBenchmarks",
         []() { benchmark::RunSpecifiedBenchmarks(); });
   m.def("ClearRegisteredBenchmarks", benchmark::ClearRegisteredBenchmarks);
+  m.def("_countdown", [](benchmark::IterationCount iterations) {
+    return StateIterator{nullptr, iterations};
+  });
   m.def("AddCustomContext", benchmark::AddCustomContext, nb::arg("key"),
         nb::arg("value"),
         "Add a key-value pair to output as part of the context stanza in the "
@@ -31,7 +31,9 @@ from google_benchmark import Counter
 
 @benchmark.register
 def empty(state):
-    while state:
+    # Only calls into the library once per batch of iterations, unlike
+    # `while state`, which calls into it on every iteration.
+    for _ in state:
         pass
 
 
@@ -17,5 +17,7 @@ pub mod ffi {
         unsafe fn SkipWithError(state: Pin<&mut State>, msg: &str);
         unsafe fn RegisterBenchmark(name: &str, func: fn(Pin<&mut State>));
         unsafe fn Initialize(argc: *mut i32, argv: usize);
+        fn NextBatch(state: Pin<&mut State>) -> u64;
+        fn AddCustomContext(key: &str, value: &str);
     }
 }
@@ -1,31 +1,88 @@
 pub mod ffi;
 
 use std::ffi::CString;
+use std::hint::black_box;
 use std::os::raw::c_char;
 use std::pin::Pin;
+use std::sync::Once;
+use std::time::Instant;
+
+/// Counts down the iterations of a batch claimed from the library.
+#[derive(Default)]
+struct Countdown {
+    remaining: u64,
+}
+
+impl Countdown {
+    #[inline(always)]
+    fn next(&mut self) -> bool {
+        if self.remaining == 0 {
+            return false;
+        }
+        self.remaining -= 1;
+        true
+    }
+}
 
 pub struct State<'a> {
     #[doc(hidden)]
     pub inner: Pin<&'a mut ffi::ffi::State>,
+    batch: Countdown,
 }
 
 impl<'a> State<'a> {
+    #[doc(hidden)]
+    pub fn new(inner: Pin<&'a mut ffi::ffi::State>) -> Self {
+        State {
+            inner,
+            batch: Countdown::default(),
+        }
+    }
+
     /// Returns true if the benchmark should continue running.
     ///
-    /// **Note:** `keep_running()` currently has a small per-iteration overhead due to the FFI boundary.
-    /// In the future, this could be optimized using `KeepRunningBatch` under the hood.
+    /// The iterations are claimed from the library in batches with
+    /// `KeepRunningBatch`, so most calls only count down the current batch
+    /// and do not cross the FFI boundary. The remaining cost of an iteration
+    /// is reported in the context as `rust_iteration_overhead_ns`.
     #[inline]
     pub fn keep_running(&mut self) -> bool {
-        self.inner.as_mut().KeepRunning()
+        self.batch.next() || self.next_batch()
+    }
+
+    #[cold]
+    #[inline(never)]
+    fn next_batch(&mut self) -> bool {
+        self.batch.remaining = ffi::ffi::NextBatch(self.inner.as_mut());
+        self.batch.next()
     }
 
+    /// Ends the benchmark loop at the next call to `keep_running()`.
     pub fn skip_with_error(&mut self, msg: &str) {
+        self.batch.remaining = 0;
         unsafe {
             ffi::ffi::SkipWithError(self.inner.as_mut(), msg);
         }
     }
 }
 
+/// Time of an empty `keep_running()` loop iteration in nanoseconds, which is
+/// not subtracted from the results.
+fn iteration_overhead_ns() -> f64 {
+    const ITERATIONS: u64 = 10_000_000;
+    const RUNS: usize = 5;
+    let mut best = f64::INFINITY;
+    for _ in 0..RUNS {
+        let mut batch = Countdown {
+            remaining: ITERATIONS,
+        };
+        let start = Instant::now();
+        while black_box(&mut batch).next() {}
+        best = best.min(start.elapsed().as_nanos() as f64);
+    }
+    best / ITERATIONS as f64
+}
+
 /// Initialize the benchmark library.
 /// This should be called before `run_specified_benchmarks`.
 pub fn initialize(args: &Vec<String>) {
@@ -50,7 +107,7 @@ macro_rules! register_benchmark {
     ($name:expr, $func:path) => {
         {
             fn trampoline(mut state: std::pin::Pin<&mut $crate::ffi::ffi::State>) {
-                let mut wrapped = $crate::State { inner: state.as_mut() };
+                let mut wrapped = $crate::State::new(state.as_mut());
                 $func(&mut wrapped);
             }
             unsafe {
@@ -62,5 +119,10 @@ macro_rules! register_benchmark {
 
 /// Run all registered benchmarks.
 pub fn run_specified_benchmarks() -> usize {
+    static CALIBRATE: Once = Once::new();
+    CALIBRATE.call_once(|| {
+        let overhead = format!("{:.2}", iteration_overhead_ns());
+        ffi::ffi::AddCustomContext("rust_iteration_overhead_ns", &overhead);
+    });
     ffi::ffi::RunSpecifiedBenchmarks()
 }
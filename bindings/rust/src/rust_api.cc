@@ -8,6 +8,8 @@ namespace rust_api {
 void RegisterBenchmark(rust::Str name, rust::Fn<void(benchmark::State&)> func);
 void Initialize(int* argc, size_t argv);
 void SkipWithError(benchmark::State& state, rust::Str msg);
+uint64_t NextBatch(benchmark::State& state);
+void AddCustomContext(rust::Str key, rust::Str value);
 
 void RegisterBenchmark(rust::Str name, rust::Fn<void(benchmark::State&)> func) {
   ::benchmark::RegisterBenchmark(std::string(name).c_str(),
@@ -29,5 +31,24 @@ void SkipWithError(benchmark::State& state, rust::Str msg) {
   state.SkipWithError(std::string(msg).c_str());
 }
 
+// Claims the iterations left in the current run with KeepRunningBatch() and
+// returns how many there are, or 0 once the run is over. While latencies are
+// sampled, every iteration is a batch of its own.
+uint64_t NextBatch(benchmark::State& state) {
+  if (!state.KeepRunningBatch(1)) {
+    return 0;
+  }
+  const benchmark::IterationCount rest =
+      state.max_iterations - state.iterations();
+  if (rest > 0) {
+    state.KeepRunningBatch(rest);
+  }
+  return static_cast<uint64_t>(1 + rest);
+}
+
+void AddCustomContext(rust::Str key, rust::Str value) {
+  ::benchmark::AddCustomContext(std::string(key), std::string(value));
+}
+
 }  // namespace rust_api
 }  // namespace benchmark
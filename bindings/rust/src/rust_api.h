@@ -9,6 +9,8 @@ namespace rust_api {
 void RegisterBenchmark(rust::Str name, rust::Fn<void(benchmark::State&)> func);
 void Initialize(int* argc, size_t argv);
 void SkipWithError(benchmark::State& state, rust::Str msg);
+uint64_t NextBatch(benchmark::State& state);
+void AddCustomContext(rust::Str key, rust::Str value);
 
 }  // namespace rust_api
 }  // namespace benchmark
@@ -71,6 +71,10 @@ BENCHMARK_EXPORT size_t
 RunSpecifiedBenchmarks(BenchmarkReporter* display_reporter,
                        BenchmarkReporter* file_reporter, std::string spec);
 
+// Returns the number of benchmarks that regressed against
+// --benchmark_baseline in the last call to RunSpecifiedBenchmarks().
+BENCHMARK_EXPORT size_t GetBaselineRegressionCount();
+
 BENCHMARK_EXPORT TimeUnit GetDefaultTimeUnit();
 
 BENCHMARK_EXPORT void SetDefaultTimeUnit(TimeUnit unit);
@@ -100,6 +104,7 @@ class BENCHMARK_EXPORT Benchmark {
   Benchmark* Unit(TimeUnit unit);
   Benchmark* Range(int64_t start, int64_t limit);
   Benchmark* DenseRange(int64_t start, int64_t limit, int step = 1);
+  Benchmark* WorkingSetRange(int64_t bytes_per_arg = 1);
   Benchmark* Args(const std::vector<int64_t>& args);
   Benchmark* ArgPair(int64_t x, int64_t y) {
     std::vector<int64_t> args;
@@ -142,6 +147,11 @@ class BENCHMARK_EXPORT Benchmark {
   Benchmark* DenseThreadRange(int min_threads, int max_threads, int stride = 1);
   Benchmark* ThreadPerCpu();
   Benchmark* ThreadRunner(threadrunner_factory&& factory);
+  Benchmark* Affinity(AffinityPolicy policy);
+  Benchmark* Affinity(const std::vector<int>& cpus);
+  Benchmark* ReportPerThread(bool value = true);
+  Benchmark* LatencyHistogram(bool value = true);
+  Benchmark* CompareTo(const std::string& baseline);
 
   virtual void Run(State& state) = 0;
 
@@ -160,10 +170,15 @@ class BENCHMARK_EXPORT Benchmark {
   friend class internal::BenchmarkFamilies;
   friend class internal::BenchmarkInstance;
 
+  void AddArgsProduct(std::vector<std::vector<int64_t>> arglists);
+
   std::string name_;
   internal::AggregationReportMode aggregation_report_mode_;
   std::vector<std::string> arg_names_;
-  std::vector<std::vector<int64_t>> args_;
+  // The cartesian products of argument values added so far, in order. They
+  // are only enumerated when the benchmarks are looked up. Args() adds the
+  // product of single values.
+  std::vector<std::vector<std::vector<int64_t>>> args_;
 
   TimeUnit time_unit_;
   bool use_default_time_unit_;
@@ -186,6 +201,13 @@ class BENCHMARK_EXPORT Benchmark {
 
   threadrunner_factory threadrunner_;
 
+  AffinityPolicy affinity_policy_;
+  std::vector<int> affinity_cpus_;
+
+  bool report_per_thread_;
+  bool latency_histogram_;
+  std::string compare_to_;
+
   BENCHMARK_DISALLOW_COPY_AND_ASSIGN(Benchmark);
 };
 
@@ -284,6 +306,11 @@ std::vector<int64_t> CreateRange(int64_t lo, int64_t hi, int multi);
 BENCHMARK_EXPORT
 std::vector<int64_t> CreateDenseRange(int64_t start, int64_t limit, int step);
 
+// Arguments whose working sets, at `bytes_per_arg` bytes per unit of the
+// argument, straddle every data cache level of this machine.
+BENCHMARK_EXPORT
+std::vector<int64_t> CreateWorkingSetRange(int64_t bytes_per_arg);
+
 }  // namespace benchmark
 
 #if defined(_MSC_VER)
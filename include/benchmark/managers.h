@@ -28,19 +28,33 @@ class MemoryManager {
  public:
   static constexpr int64_t TombstoneValue = std::numeric_limits<int64_t>::max();
 
+  // Number of buckets of Result::allocation_sizes.
+  static constexpr int kNumAllocationSizeBuckets = 32;
+
   struct Result {
     Result()
         : num_allocs(0),
           max_bytes_used(0),
           total_allocated_bytes(TombstoneValue),
           net_heap_growth(TombstoneValue),
-          memory_iterations(0) {}
+          memory_iterations(0),
+          allocation_sizes(),
+          peak_rss_bytes(TombstoneValue),
+          page_faults(TombstoneValue) {}
 
     int64_t num_allocs;
     int64_t max_bytes_used;
     int64_t total_allocated_bytes;
     int64_t net_heap_growth;
     IterationCount memory_iterations;
+    // Histogram of the requested allocation sizes: bucket 0 counts the empty
+    // allocations and bucket i > 0 those of [2^(i-1), 2^i) bytes, with the
+    // last bucket also counting all larger ones. All zero if not measured.
+    int64_t allocation_sizes[kNumAllocationSizeBuckets];
+    // Peak resident set size of the process during the run.
+    int64_t peak_rss_bytes;
+    // Minor and major page faults of the process during the run.
+    int64_t page_faults;
   };
 
   virtual ~MemoryManager() {}
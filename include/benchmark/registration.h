@@ -251,7 +251,7 @@ BENCHMARK_RESTORE_COUNTER_WARNING
     if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1; \
     ::benchmark::RunSpecifiedBenchmarks();                              \
     ::benchmark::Shutdown();                                            \
-    return 0;                                                           \
+    return ::benchmark::GetBaselineRegressionCount() == 0 ? 0 : 1;      \
   }                                                                     \
   int main(int, char**)
 
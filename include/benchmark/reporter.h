@@ -58,6 +58,7 @@ class BENCHMARK_EXPORT BenchmarkReporter {
   struct Context {
     CPUInfo const& cpu_info;
     SystemInfo const& sys_info;
+    TimerOverhead timer_overhead;
     size_t name_field_width = 0;
     static const char* executable_name;
     Context();
@@ -84,7 +85,10 @@ class BENCHMARK_EXPORT BenchmarkReporter {
           statistics(),
           report_big_o(false),
           report_rms(false),
-          allocs_per_iter(0.0) {}
+          allocs_per_iter(0.0),
+          overhead_subtracted(false),
+          working_set_bytes(0),
+          peak_memory_bandwidth(0) {}
 
     std::string benchmark_name() const;
     BenchmarkName run_name;
@@ -99,6 +103,9 @@ class BENCHMARK_EXPORT BenchmarkReporter {
 
     IterationCount iterations;
     int64_t threads;
+    // The CPU each thread was pinned to, indexed by thread index. Empty if
+    // the threads were not pinned.
+    std::vector<int> thread_cpus;
     int64_t repetition_index;
     int64_t repetitions;
     TimeUnit time_unit;
@@ -108,6 +115,37 @@ class BENCHMARK_EXPORT BenchmarkReporter {
     double GetAdjustedRealTime() const;
     double GetAdjustedCPUTime() const;
 
+    // The measurements of a single thread, for benchmarks that requested
+    // ReportPerThread(). Times are accumulated over the thread's iterations.
+    struct ThreadResult {
+      IterationCount iterations = 0;
+      double real_accumulated_time = 0;
+      double cpu_accumulated_time = 0;
+      // Seconds this thread waited for the others at the end of the run.
+      double barrier_wait_time = 0;
+      // Seconds after the first thread that this thread started measuring.
+      double start_delay = 0;
+      UserCounters counters;
+    };
+    // Indexed by thread index; empty unless ReportPerThread() was requested.
+    std::vector<ThreadResult> per_thread;
+
+    // Load imbalance between the threads, derived from `per_thread`. The
+    // times are per iteration and in `time_unit`, like GetAdjustedRealTime().
+    struct ThreadImbalance {
+      // Slowest over fastest per-iteration thread time.
+      double max_min_ratio = 0;
+      // How much slower than the average the slowest thread was.
+      double straggler_time = 0;
+      // Average time a thread waited for the others at the end of the run.
+      // Not per iteration, as the wait happens once.
+      double barrier_wait_time = 0;
+      // Time between the first and the last thread starting to measure. Not
+      // per iteration either.
+      double start_skew = 0;
+    };
+    ThreadImbalance GetThreadImbalance() const;
+
     double max_heapbytes_used;
     bool use_real_time_for_initial_big_o;
     BigO complexity;
@@ -119,6 +157,15 @@ class BENCHMARK_EXPORT BenchmarkReporter {
     UserCounters counters;
     MemoryManager::Result memory_result;
     double allocs_per_iter;
+    // Whether the calibrated TimerOverhead was subtracted from the times.
+    bool overhead_subtracted;
+    // Set by State::SetWorkingSetBytes(), or zero, along with the smallest
+    // cache level that holds it, e.g. "L2" or "DRAM".
+    int64_t working_set_bytes;
+    std::string cache_level;
+    // The peak bandwidth of the machine in bytes per second that the
+    // "bandwidth_utilization" counter relates "bytes_per_second" to, or zero.
+    double peak_memory_bandwidth;
   };
 
   struct PerFamilyRunReports {
@@ -134,6 +181,16 @@ class BENCHMARK_EXPORT BenchmarkReporter {
                                 bool /*has_explicit_iters*/,
                                 IterationCount /*iters*/) {}
   virtual void ReportRuns(const std::vector<Run>& report) = 0;
+
+  // Called with every repetition of a benchmark as soon as it has finished,
+  // unless only aggregates are to be reported or the number of repetitions is
+  // not known in advance (--benchmark_target_rel_ci, --benchmark_baseline).
+  // Returns whether the run was reported; if so, only the aggregates are
+  // passed to ReportRuns() once all repetitions are done. The default
+  // implementation returns false, so that all runs of a benchmark are passed
+  // to ReportRuns() together.
+  virtual bool ReportRepetition(const Run& /*run*/) { return false; }
+
   virtual void Finalize() {}
 
   // Called instead of running the benchmarks when `--benchmark_list_tests`
@@ -173,6 +230,7 @@ class BENCHMARK_EXPORT ConsoleReporter : public BenchmarkReporter {
 
   bool ReportContext(const Context& context) override;
   void ReportRuns(const std::vector<Run>& reports) override;
+  bool ReportRepetition(const Run& run) override;
 
  protected:
   virtual void PrintRunData(const Run& result);
@@ -186,15 +244,25 @@ class BENCHMARK_EXPORT ConsoleReporter : public BenchmarkReporter {
 
 class BENCHMARK_EXPORT JSONReporter : public BenchmarkReporter {
  public:
-  JSONReporter() : first_report_(true) {}
+  enum OutputFormat {
+    // A single JSON document, complete once Finalize() has been called.
+    OF_Document,
+    // JSON Lines: the context, then every run, each as a single-line object
+    // that is flushed as soon as it is written.
+    OF_Lines
+  };
+  explicit JSONReporter(OutputFormat format = OF_Document)
+      : format_(format), first_report_(true) {}
   bool ReportContext(const Context& context) override;
   void ReportRuns(const std::vector<Run>& reports) override;
+  bool ReportRepetition(const Run& run) override;
   void Finalize() override;
   void List(
       const std::vector<internal::BenchmarkInstance>& benchmarks) override;
 
  private:
-  void PrintRunData(const Run& run);
+  void PrintRunData(const Run& run, std::ostream& out);
+  OutputFormat format_;
   bool first_report_;
 };
 
@@ -205,6 +273,7 @@ class BENCHMARK_EXPORT BENCHMARK_DEPRECATED_MSG(
   CSVReporter() : printed_header_(false) {}
   bool ReportContext(const Context& context) override;
   void ReportRuns(const std::vector<Run>& reports) override;
+  bool ReportRepetition(const Run& run) override;
   void List(
       const std::vector<internal::BenchmarkInstance>& benchmarks) override;
 
@@ -36,6 +36,7 @@ class BenchmarkInstance;
 class ThreadTimer;
 class ThreadManager;
 class PerfCountersMeasurement;
+class LatencySampler;
 }  // namespace internal
 
 class ProfilerManager;
@@ -87,6 +88,14 @@ class BENCHMARK_EXPORT BENCHMARK_INTERNAL_CACHELINE_ALIGNED State {
   BENCHMARK_ALWAYS_INLINE
   ComplexityN complexity_length_n() const { return complexity_n_; }
 
+  // Sets the bytes of memory an iteration works on, which annotates the
+  // results with the cache level they fit in.
+  BENCHMARK_ALWAYS_INLINE
+  void SetWorkingSetBytes(int64_t bytes) { working_set_bytes_ = bytes; }
+
+  BENCHMARK_ALWAYS_INLINE
+  int64_t working_set_bytes() const { return working_set_bytes_; }
+
   BENCHMARK_ALWAYS_INLINE
   void SetItemsProcessed(int64_t items) {
     counters["items_per_second"] =
@@ -149,6 +158,7 @@ class BENCHMARK_EXPORT BENCHMARK_INTERNAL_CACHELINE_ALIGNED State {
   std::vector<int64_t> range_;
 
   ComplexityN complexity_n_;
+  int64_t working_set_bytes_;
 
  public:
   UserCounters counters;
@@ -163,6 +173,7 @@ class BENCHMARK_EXPORT BENCHMARK_INTERNAL_CACHELINE_ALIGNED State {
   void StartKeepRunning();
   inline bool KeepRunningInternal(IterationCount n, bool is_batch);
   void FinishKeepRunning();
+  bool NextLatencySample(IterationCount n);
 
   const std::string name_;
   const int thread_index_;
@@ -172,6 +183,7 @@ class BENCHMARK_EXPORT BENCHMARK_INTERNAL_CACHELINE_ALIGNED State {
   internal::ThreadManager* const manager_;
   internal::PerfCountersMeasurement* const perf_counters_measurement_;
   ProfilerManager* const profiler_manager_;
+  internal::LatencySampler* const latency_sampler_;
 
   friend class internal::BenchmarkInstance;
 };
@@ -204,6 +216,10 @@ inline BENCHMARK_ALWAYS_INLINE bool State::KeepRunningInternal(IterationCount n,
     total_iterations_ = 0;
     return true;
   }
+  if (BENCHMARK_BUILTIN_EXPECT(latency_sampler_ != nullptr, false) &&
+      NextLatencySample(n)) {
+    return true;
+  }
   FinishKeepRunning();
   return false;
 }
@@ -223,7 +239,10 @@ struct State::StateIterator {
 
   BENCHMARK_ALWAYS_INLINE
   explicit StateIterator(State* st)
-      : cached_(st->skipped() ? 0 : st->max_iterations), parent_(st) {}
+      : cached_(st->skipped() || st->latency_sampler_ != nullptr
+                    ? 0
+                    : st->max_iterations),
+        parent_(st) {}
 
  public:
   BENCHMARK_ALWAYS_INLINE
@@ -239,12 +258,18 @@ struct State::StateIterator {
   BENCHMARK_ALWAYS_INLINE
   bool operator!=(StateIterator const&) const {
     if (BENCHMARK_BUILTIN_EXPECT(cached_ != 0, true)) return true;
+    if (BENCHMARK_BUILTIN_EXPECT(parent_->latency_sampler_ != nullptr, false) &&
+        parent_->NextLatencySample(1)) {
+      cached_ = 1;
+      return true;
+    }
     parent_->FinishKeepRunning();
     return false;
   }
 
  private:
-  IterationCount cached_;
+  // Only reset from the const operator!= while sampling latencies.
+  mutable IterationCount cached_;
   State* const parent_;
 };
 
@@ -26,7 +26,8 @@ enum BigO { oNone, o1, oN, oNSquared, oNCubed, oLogN, oNLogN, oAuto, oLambda };
 
 typedef int64_t ComplexityN;
 
-enum StatisticUnit { kTime, kPercentage };
+// kProbability values, such as p-values, are reported as they are, in [0, 1].
+enum StatisticUnit { kTime, kPercentage, kProbability };
 
 typedef double(BigOFunc)(ComplexityN);
 
@@ -62,6 +62,17 @@ struct BENCHMARK_EXPORT SystemInfo {
   BENCHMARK_DISALLOW_COPY_AND_ASSIGN(SystemInfo);
 };
 
+// The cost of the benchmark loop itself, calibrated before the benchmarks run
+// when --benchmark_subtract_overhead is set, and zero otherwise.
+struct BENCHMARK_EXPORT TimerOverhead {
+  // Seconds per iteration of an empty `for (auto _ : state)` loop.
+  double empty_loop = 0;
+  // Seconds a PauseTiming()/ResumeTiming() pair adds to the measured time.
+  double pause_resume = 0;
+  // Whether these have been subtracted from the reported times.
+  bool subtracted = false;
+};
+
 }  // namespace benchmark
 
 #if defined(_MSC_VER)
@@ -45,6 +45,18 @@ using callback_function = std::function<void(const benchmark::State&)>;
 
 enum TimeUnit { kNanosecond, kMicrosecond, kMillisecond, kSecond };
 
+// How the threads of a benchmark are placed on CPUs. kAffinityUnspecified
+// defers to the --benchmark_affinity flag.
+enum AffinityPolicy {
+  kAffinityUnspecified,
+  kAffinityNone,
+  kAffinityCompact,
+  kAffinityScatter,
+  kAffinityPhysicalCores,
+  kAffinityNumaNodes,
+  kAffinityCpuList
+};
+
 }  // namespace benchmark
 
 #endif  // BENCHMARK_TYPES_H_
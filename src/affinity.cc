@@ -0,0 +1,350 @@
+// Copyright 2025 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "affinity.h"
+
+#include "internal_macros.h"
+
+#ifdef BENCHMARK_OS_WINDOWS
+#include <windows.h>
+#endif
+
+#if defined(BENCHMARK_HAS_PTHREAD_AFFINITY)
+#if defined(BENCHMARK_OS_FREEBSD)
+#include <pthread_np.h>
+#endif
+#include <pthread.h>
+#endif
+
+#if defined(BENCHMARK_OS_LINUX)
+#include <dirent.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <tuple>
+#include <utility>
+
+#include "benchmark/sysinfo.h"
+#include "log.h"
+#include "string_util.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+#if defined(BENCHMARK_HAS_PTHREAD_AFFINITY)
+static_assert(sizeof(cpu_set_t) <= 128, "cpu_set_t does not fit");
+#endif
+
+std::vector<int> GetAllowedCpus() {
+  std::vector<int> cpus;
+#if defined(BENCHMARK_HAS_PTHREAD_AFFINITY)
+  cpu_set_t mask;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(mask), &mask) == 0) {
+    for (int i = 0; i < CPU_SETSIZE; ++i) {
+      if (CPU_ISSET(i, &mask)) {
+        cpus.push_back(i);
+      }
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    for (int i = 0; i < CPUInfo::Get().num_cpus; ++i) {
+      cpus.push_back(i);
+    }
+  }
+  return cpus;
+}
+
+#if defined(BENCHMARK_OS_LINUX)
+bool ReadIntFromFile(const std::string& fname, int* value) {
+  std::ifstream f(fname.c_str());
+  return static_cast<bool>(f >> *value);
+}
+
+int GetNumaNode(int cpu) {
+  int node = 0;
+  DIR* dir = opendir(StrCat("/sys/devices/system/cpu/cpu", cpu).c_str());
+  if (dir == nullptr) {
+    return node;
+  }
+  while (const dirent* entry = readdir(dir)) {
+    if (std::sscanf(entry->d_name, "node%d", &node) == 1) {
+      break;
+    }
+    node = 0;
+  }
+  closedir(dir);
+  return node;
+}
+#endif
+
+std::vector<LogicalCpu> ComputeCpuTopology() {
+  std::vector<LogicalCpu> topology;
+  for (int id : GetAllowedCpus()) {
+    LogicalCpu cpu;
+    cpu.id = id;
+    cpu.core = id;
+#if defined(BENCHMARK_OS_LINUX)
+    const std::string dir =
+        StrCat("/sys/devices/system/cpu/cpu", id, "/topology/");
+    int value = 0;
+    if (ReadIntFromFile(dir + "core_id", &value) && value >= 0) {
+      cpu.core = value;
+    }
+    if (ReadIntFromFile(dir + "physical_package_id", &value) && value >= 0) {
+      cpu.package = value;
+    }
+    cpu.node = GetNumaNode(id);
+#endif
+    topology.push_back(cpu);
+  }
+
+  // Rank the hardware threads of each core, lowest CPU id first.
+  std::sort(topology.begin(), topology.end(),
+            [](const LogicalCpu& a, const LogicalCpu& b) {
+              return std::tie(a.package, a.core, a.id) <
+                     std::tie(b.package, b.core, b.id);
+            });
+  for (size_t i = 1; i < topology.size(); ++i) {
+    const LogicalCpu& prev = topology[i - 1];
+    LogicalCpu& cpu = topology[i];
+    if (prev.package == cpu.package && prev.core == cpu.core) {
+      cpu.smt_rank = prev.smt_rank + 1;
+    }
+  }
+  std::sort(topology.begin(), topology.end(),
+            [](const LogicalCpu& a, const LogicalCpu& b) {
+              return a.id < b.id;
+            });
+  return topology;
+}
+
+// Returns, for every CPU, the position of its core among the physical cores
+// that share the same key (package or NUMA node).
+template <class KeyFn>
+std::vector<int> CoreOrdinals(const std::vector<LogicalCpu>& topology,
+                              KeyFn key) {
+  std::map<int, std::vector<std::pair<int, int>>> cores;
+  for (const LogicalCpu& cpu : topology) {
+    std::vector<std::pair<int, int>>& v = cores[key(cpu)];
+    const std::pair<int, int> core(cpu.package, cpu.core);
+    if (std::find(v.begin(), v.end(), core) == v.end()) {
+      v.push_back(core);
+    }
+  }
+  for (auto& kv : cores) {
+    std::sort(kv.second.begin(), kv.second.end());
+  }
+  std::vector<int> ordinals;
+  ordinals.reserve(topology.size());
+  for (const LogicalCpu& cpu : topology) {
+    const std::vector<std::pair<int, int>>& v = cores[key(cpu)];
+    ordinals.push_back(static_cast<int>(
+        std::find(v.begin(), v.end(), std::make_pair(cpu.package, cpu.core)) -
+        v.begin()));
+  }
+  return ordinals;
+}
+
+bool ParseCpuList(const std::string& value, std::vector<int>* cpus) {
+  std::vector<int> result;
+  for (const std::string& item : StrSplit(value, ',')) {
+    int first = 0;
+    int last = 0;
+    char extra = 0;
+    const int n =
+        std::sscanf(item.c_str(), "%d-%d%c", &first, &last, &extra);
+    if (n == 1) {
+      if (std::sscanf(item.c_str(), "%d%c", &first, &extra) != 1) {
+        return false;
+      }
+      last = first;
+    } else if (n != 2) {
+      return false;
+    }
+    if (first < 0 || last < first) {
+      return false;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      result.push_back(cpu);
+    }
+  }
+  if (result.empty()) {
+    return false;
+  }
+  *cpus = std::move(result);
+  return true;
+}
+
+}  // end namespace
+
+const std::vector<LogicalCpu>& GetCpuTopology() {
+  static const std::vector<LogicalCpu>* topology =
+      new std::vector<LogicalCpu>(ComputeCpuTopology());
+  return *topology;
+}
+
+bool ParseAffinity(const std::string& value, AffinityPolicy* policy,
+                   std::vector<int>* cpus) {
+  static const std::pair<const char*, AffinityPolicy> kPolicies[] = {
+      {"", kAffinityUnspecified},
+      {"none", kAffinityNone},
+      {"compact", kAffinityCompact},
+      {"scatter", kAffinityScatter},
+      {"physical_cores", kAffinityPhysicalCores},
+      {"numa_nodes", kAffinityNumaNodes},
+  };
+  for (const auto& p : kPolicies) {
+    if (value == p.first) {
+      *policy = p.second;
+      cpus->clear();
+      return true;
+    }
+  }
+  if (ParseCpuList(value, cpus)) {
+    *policy = kAffinityCpuList;
+    return true;
+  }
+  return false;
+}
+
+std::vector<int> PlanThreadAffinity(AffinityPolicy policy,
+                                    const std::vector<int>& cpus,
+                                    const std::vector<LogicalCpu>& topology,
+                                    int num_threads) {
+  std::vector<int> order;
+  switch (policy) {
+    case kAffinityUnspecified:
+    case kAffinityNone:
+      return {};
+    case kAffinityCpuList:
+      order = cpus;
+      break;
+    case kAffinityCompact:
+    case kAffinityPhysicalCores: {
+      // Fill all hardware threads of a core, then the cores of a package,
+      // before moving on. For one-per-core, only the first hardware thread
+      // of each core is used.
+      std::vector<LogicalCpu> sorted;
+      for (const LogicalCpu& cpu : topology) {
+        if (policy == kAffinityCompact || cpu.smt_rank == 0) {
+          sorted.push_back(cpu);
+        }
+      }
+      std::sort(sorted.begin(), sorted.end(),
+                [](const LogicalCpu& a, const LogicalCpu& b) {
+                  return std::tie(a.node, a.package, a.core, a.smt_rank) <
+                         std::tie(b.node, b.package, b.core, b.smt_rank);
+                });
+      for (const LogicalCpu& cpu : sorted) {
+        order.push_back(cpu.id);
+      }
+      break;
+    }
+    case kAffinityScatter:
+    case kAffinityNumaNodes: {
+      // Round-robin over packages (or NUMA nodes), using every physical core
+      // before any SMT sibling. For one-per-node, SMT siblings are skipped.
+      const bool by_node = policy == kAffinityNumaNodes;
+      const std::vector<int> ordinals = CoreOrdinals(
+          topology, [by_node](const LogicalCpu& cpu) {
+            return by_node ? cpu.node : cpu.package;
+          });
+      std::vector<std::tuple<int, int, int, int>> sorted;
+      for (size_t i = 0; i < topology.size(); ++i) {
+        const LogicalCpu& cpu = topology[i];
+        if (by_node && cpu.smt_rank != 0) {
+          continue;
+        }
+        sorted.emplace_back(cpu.smt_rank, ordinals[i],
+                            by_node ? cpu.node : cpu.package, cpu.id);
+      }
+      std::sort(sorted.begin(), sorted.end());
+      for (const auto& t : sorted) {
+        order.push_back(std::get<3>(t));
+      }
+      break;
+    }
+  }
+  if (order.empty()) {
+    return {};
+  }
+
+  std::vector<int> plan;
+  plan.reserve(static_cast<size_t>(num_threads));
+  for (int i = 0; i < num_threads; ++i) {
+    plan.push_back(order[static_cast<size_t>(i) % order.size()]);
+  }
+  return plan;
+}
+
+ScopedThreadAffinity::ScopedThreadAffinity(int cpu) {
+  if (cpu < 0) {
+    return;
+  }
+#if defined(BENCHMARK_HAS_PTHREAD_AFFINITY)
+  cpu_set_t previous;
+  if (cpu < CPU_SETSIZE &&
+      pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) ==
+          0) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0) {
+      std::memcpy(previous_affinity_, &previous, sizeof(previous));
+      pinned_ = true;
+    }
+  }
+#elif defined(BENCHMARK_OS_WINDOWS_WIN32)
+  if (cpu < static_cast<int>(8 * sizeof(DWORD_PTR))) {
+    const DWORD_PTR previous = SetThreadAffinityMask(
+        GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu);
+    if (previous != 0) {
+      std::memcpy(previous_affinity_, &previous, sizeof(previous));
+      pinned_ = true;
+    }
+  }
+#endif
+  if (!pinned_) {
+    static std::atomic<bool> warned(false);
+    if (!warned.exchange(true)) {
+      GetErrorLogInstance() << "***WARNING*** Failed to pin a thread to CPU "
+                            << cpu << "; affinity will not be applied.\n";
+    }
+  }
+}
+
+ScopedThreadAffinity::~ScopedThreadAffinity() {
+  if (!pinned_) {
+    return;
+  }
+#if defined(BENCHMARK_HAS_PTHREAD_AFFINITY)
+  cpu_set_t previous;
+  std::memcpy(&previous, previous_affinity_, sizeof(previous));
+  pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+#elif defined(BENCHMARK_OS_WINDOWS_WIN32)
+  DWORD_PTR previous = 0;
+  std::memcpy(&previous, previous_affinity_, sizeof(previous));
+  SetThreadAffinityMask(GetCurrentThread(), previous);
+#endif
+}
+
+}  // namespace internal
+}  // namespace benchmark
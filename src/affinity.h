@@ -0,0 +1,61 @@
+#ifndef BENCHMARK_AFFINITY_H_
+#define BENCHMARK_AFFINITY_H_
+
+#include <string>
+#include <vector>
+
+#include "benchmark/export.h"
+#include "benchmark/types.h"
+
+namespace benchmark {
+namespace internal {
+
+// A logical CPU the process is allowed to run on, and where it sits in the
+// machine.
+struct LogicalCpu {
+  int id = 0;
+  int package = 0;   // Physical socket.
+  int core = 0;      // Physical core id, unique within its package.
+  int node = 0;      // NUMA node.
+  int smt_rank = 0;  // Index among the hardware threads of its core.
+};
+
+// Returns the CPUs of the process' affinity mask at the time of the first
+// call. Falls back to a flat topology of `CPUInfo::num_cpus` independent cores
+// when the platform does not expose one.
+BENCHMARK_EXPORT const std::vector<LogicalCpu>& GetCpuTopology();
+
+// Parses a `--benchmark_affinity` value: `none`, `compact`, `scatter`,
+// `physical_cores`, `numa_nodes` or a CPU list such as `0,2,4-7`. An empty
+// value parses as kAffinityUnspecified.
+BENCHMARK_EXPORT bool ParseAffinity(const std::string& value,
+                                    AffinityPolicy* policy,
+                                    std::vector<int>* cpus);
+
+// Returns the CPU thread `i` of a `num_threads` run should be pinned to, for
+// every `i`, or an empty vector if the threads are not to be pinned.
+BENCHMARK_EXPORT std::vector<int> PlanThreadAffinity(
+    AffinityPolicy policy, const std::vector<int>& cpus,
+    const std::vector<LogicalCpu>& topology, int num_threads);
+
+// Pins the calling thread to `cpu` and restores its previous affinity on
+// destruction. Does nothing if `cpu` is negative.
+class ScopedThreadAffinity {
+ public:
+  explicit ScopedThreadAffinity(int cpu);
+  ~ScopedThreadAffinity();
+
+  ScopedThreadAffinity(const ScopedThreadAffinity&) = delete;
+  ScopedThreadAffinity& operator=(const ScopedThreadAffinity&) = delete;
+
+ private:
+  bool pinned_ = false;
+  // Platform-specific affinity mask of the thread before it was pinned. Kept
+  // opaque so that this header does not depend on the platform headers.
+  alignas(8) unsigned char previous_affinity_[128];
+};
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_AFFINITY_H_
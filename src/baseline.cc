@@ -0,0 +1,281 @@
+// Copyright 2025 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "baseline.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <locale>
+#include <sstream>
+#include <utility>
+
+#include "json_reader.h"
+#include "statistics.h"
+#include "string_util.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+bool TimeUnitFromString(const std::string& name, TimeUnit* unit) {
+  static const std::pair<const char*, TimeUnit> kUnits[] = {
+      {"ns", kNanosecond},
+      {"us", kMicrosecond},
+      {"ms", kMillisecond},
+      {"s", kSecond},
+  };
+  for (const auto& u : kUnits) {
+    if (name == u.first) {
+      *unit = u.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reads the name and times of a run object, or returns false if it is not a
+// run that can serve as a baseline.
+bool ReadRun(const JsonValue& run, std::string* name, double* real_time,
+             double* cpu_time) {
+  for (const char* failed : {"error_occurred", "skipped"}) {
+    const JsonValue* flag = run.Find(failed);
+    if (flag != nullptr && flag->type == JsonValue::kBool && flag->boolean) {
+      return false;
+    }
+  }
+  const JsonValue* run_name = run.Find("run_name");
+  const JsonValue* real = run.Find("real_time");
+  const JsonValue* cpu = run.Find("cpu_time");
+  const JsonValue* unit_name = run.Find("time_unit");
+  TimeUnit unit = kNanosecond;
+  if (run_name == nullptr || run_name->type != JsonValue::kString ||
+      real == nullptr || real->type != JsonValue::kNumber || cpu == nullptr ||
+      cpu->type != JsonValue::kNumber || unit_name == nullptr ||
+      unit_name->type != JsonValue::kString ||
+      !TimeUnitFromString(unit_name->string, &unit)) {
+    return false;
+  }
+  *name = run_name->string;
+  *real_time = real->number / GetTimeUnitMultiplier(unit);
+  *cpu_time = cpu->number / GetTimeUnitMultiplier(unit);
+  return true;
+}
+
+void AddRuns(const std::vector<JsonValue>& runs, Baseline* baseline) {
+  Baseline medians;
+  for (const JsonValue& run : runs) {
+    const JsonValue* run_type = run.Find("run_type");
+    if (run_type == nullptr || run_type->type != JsonValue::kString) {
+      continue;
+    }
+    Baseline* target = nullptr;
+    if (run_type->string == "iteration") {
+      target = baseline;
+    } else if (run_type->string == "aggregate") {
+      const JsonValue* aggregate = run.Find("aggregate_name");
+      if (aggregate != nullptr && aggregate->type == JsonValue::kString &&
+          aggregate->string == "median") {
+        target = &medians;
+      }
+    }
+    std::string name;
+    double real_time = 0;
+    double cpu_time = 0;
+    if (target == nullptr || !ReadRun(run, &name, &real_time, &cpu_time)) {
+      continue;
+    }
+    BaselineTimes& times = (*target)[name];
+    times.real_time.push_back(real_time);
+    times.cpu_time.push_back(cpu_time);
+  }
+  // Medians only stand in for benchmarks whose repetitions were not reported.
+  for (auto& kv : medians) {
+    baseline->insert(kv);
+  }
+}
+
+// Reads the run objects of a report written by the JSON reporter, in either
+// of its formats.
+bool ReadReportRuns(const std::string& text, std::vector<JsonValue>* runs,
+                    std::string* error) {
+  runs->clear();
+  JsonValue document;
+  if (ParseJson(text, &document, error)) {
+    const JsonValue* benchmarks = document.Find("benchmarks");
+    if (benchmarks == nullptr || benchmarks->type != JsonValue::kArray) {
+      *error = "no \"benchmarks\" array";
+      return false;
+    }
+    *runs = benchmarks->values;
+    return true;
+  }
+  // JSON Lines: the context, then one run per line. The last line may have
+  // been cut short by a run that did not finish.
+  std::istringstream in(text);
+  std::string line;
+  std::string line_error;
+  size_t line_number = 0;
+  bool truncated = false;
+  while (std::getline(in, line)) {
+    ++line_number;
+    if (line.empty()) {
+      continue;
+    }
+    if (truncated) {
+      *error = StrCat("line ", line_number - 1, ": ", line_error);
+      return false;
+    }
+    JsonValue value;
+    if (!ParseJson(line, &value, &line_error)) {
+      if (line_number == 1) {
+        return false;  // Neither format; `error` is about the document.
+      }
+      truncated = true;
+      continue;
+    }
+    if (value.Find("context") == nullptr) {
+      runs->push_back(std::move(value));
+    }
+  }
+  return true;
+}
+
+bool ReadFile(const std::string& path, std::string* text, std::string* error) {
+  std::ifstream f(path.c_str());
+  if (!f.is_open()) {
+    *error = "cannot open file";
+    return false;
+  }
+  std::stringstream contents;
+  contents << f.rdbuf();
+  *text = contents.str();
+  return true;
+}
+
+}  // namespace
+
+bool ParseBaseline(const std::string& text, Baseline* baseline,
+                   std::string* error) {
+  baseline->clear();
+  std::vector<JsonValue> runs;
+  if (!ReadReportRuns(text, &runs, error)) {
+    return false;
+  }
+  AddRuns(runs, baseline);
+  return true;
+}
+
+bool LoadBaseline(const std::string& path, Baseline* baseline,
+                  std::string* error) {
+  std::string text;
+  return ReadFile(path, &text, error) && ParseBaseline(text, baseline, error);
+}
+
+bool ParseRunDurations(const std::string& text, RunDurations* durations,
+                       std::string* error) {
+  durations->clear();
+  std::vector<JsonValue> runs;
+  if (!ReadReportRuns(text, &runs, error)) {
+    return false;
+  }
+  for (const JsonValue& run : runs) {
+    const JsonValue* run_type = run.Find("run_type");
+    const JsonValue* iterations = run.Find("iterations");
+    std::string name;
+    double real_time = 0;
+    double cpu_time = 0;
+    if (run_type == nullptr || run_type->type != JsonValue::kString ||
+        run_type->string != "iteration" || iterations == nullptr ||
+        iterations->type != JsonValue::kNumber ||
+        !ReadRun(run, &name, &real_time, &cpu_time)) {
+      continue;
+    }
+    (*durations)[name] += real_time * iterations->number;
+  }
+  return true;
+}
+
+bool LoadRunDurations(const std::string& path, RunDurations* durations,
+                      std::string* error) {
+  std::string text;
+  return ReadFile(path, &text, error) &&
+         ParseRunDurations(text, durations, error);
+}
+
+bool ParseMaxRegression(const std::string& value, double* fraction) {
+  if (value.empty()) {
+    return false;
+  }
+  const bool percent = value.back() == '%';
+  std::istringstream ss(percent ? value.substr(0, value.size() - 1) : value);
+  ss.imbue(std::locale::classic());
+  double v = 0;
+  ss >> v;
+  if (ss.fail() || !ss.eof() || !(v >= 0)) {
+    return false;
+  }
+  *fraction = percent ? v / 100 : v;
+  return true;
+}
+
+BaselineComparison CompareToBaseline(const std::vector<double>& times,
+                                     const std::vector<double>& baseline,
+                                     double max_regression) {
+  BaselineComparison comparison;
+  const double base = StatisticsMedian(baseline);
+  if (times.empty() || baseline.empty() || !(base > 0)) {
+    return comparison;
+  }
+  comparison.diff = StatisticsMedian(times) / base - 1;
+  if (times.size() < 3) {
+    return comparison;
+  }
+
+  std::vector<double> ratios;
+  ratios.reserve(times.size());
+  for (double t : times) {
+    ratios.push_back(t / base);
+  }
+  const double mean = StatisticsMean(ratios);
+  // Half-widths of the intervals of the current mean and, if it has enough
+  // repetitions to tell, of the baseline, both relative to the baseline.
+  const double current_ci = StatisticsRelCI(ratios) * mean;
+  const double baseline_ci = StatisticsRelCI(baseline);
+  const double ci = std::sqrt(current_ci * current_ci +
+                              baseline_ci * baseline_ci);
+  if (mean - 1 - ci > max_regression) {
+    comparison.verdict = kBaselineRegressed;
+  } else if (mean - 1 + ci <= max_regression) {
+    comparison.verdict = kBaselineWithinTolerance;
+  }
+  return comparison;
+}
+
+std::vector<double> PerIterationTimes(
+    const std::vector<BenchmarkReporter::Run>& runs, bool use_real_time) {
+  std::vector<double> times;
+  for (const BenchmarkReporter::Run& run : runs) {
+    if (run.skipped != NotSkipped || run.iterations <= 0) {
+      continue;
+    }
+    times.push_back((use_real_time ? run.real_accumulated_time
+                                   : run.cpu_accumulated_time) /
+                    static_cast<double>(run.iterations));
+  }
+  return times;
+}
+
+}  // namespace internal
+}  // namespace benchmark
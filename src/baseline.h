@@ -0,0 +1,85 @@
+#ifndef BENCHMARK_BASELINE_H_
+#define BENCHMARK_BASELINE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "benchmark/export.h"
+#include "benchmark/reporter.h"
+
+namespace benchmark {
+namespace internal {
+
+// The per-iteration times, in seconds, of the repetitions of a benchmark in a
+// previous report.
+struct BaselineTimes {
+  std::vector<double> real_time;
+  std::vector<double> cpu_time;
+};
+
+// Baseline times by run name, see --benchmark_baseline.
+typedef std::map<std::string, BaselineTimes> Baseline;
+
+// Reads the iteration runs of a report written by the JSON reporter, in
+// either of its formats. A report with aggregates only contributes their
+// medians. On failure, returns false and sets `error`.
+BENCHMARK_EXPORT bool ParseBaseline(const std::string& text,
+                                    Baseline* baseline, std::string* error);
+BENCHMARK_EXPORT bool LoadBaseline(const std::string& path,
+                                   Baseline* baseline, std::string* error);
+
+// The estimated wall time, in seconds, that each benchmark of a previous
+// report took: the real time of its iterations, summed over its repetitions.
+typedef std::map<std::string, double> RunDurations;
+
+// Reads the durations of the iteration runs of a report written by the JSON
+// reporter, in either of its formats. On failure, returns false and sets
+// `error`.
+BENCHMARK_EXPORT bool ParseRunDurations(const std::string& text,
+                                        RunDurations* durations,
+                                        std::string* error);
+BENCHMARK_EXPORT bool LoadRunDurations(const std::string& path,
+                                       RunDurations* durations,
+                                       std::string* error);
+
+// Parses a `--benchmark_max_regression` value, either a fraction such as
+// `0.03` or a percentage such as `3%`.
+BENCHMARK_EXPORT bool ParseMaxRegression(const std::string& value,
+                                         double* fraction);
+
+enum BaselineVerdict {
+  kBaselineUndecided,
+  kBaselineWithinTolerance,
+  kBaselineRegressed,
+};
+
+struct BaselineComparison {
+  // Relative difference of the median times, (current - baseline) / baseline.
+  double diff = 0;
+  // Whether the 95% confidence interval of the mean difference lies entirely
+  // below or above the tolerance. Needs at least three repetitions.
+  BaselineVerdict verdict = kBaselineUndecided;
+
+  // Whether the benchmark counts as a regression: clearly so, or, when the
+  // interval is inconclusive, by its median.
+  bool Regressed(double max_regression) const {
+    return verdict == kBaselineRegressed ||
+           (verdict == kBaselineUndecided && diff > max_regression);
+  }
+};
+
+// Compares per-iteration `times` against `baseline` ones.
+BENCHMARK_EXPORT BaselineComparison CompareToBaseline(
+    const std::vector<double>& times, const std::vector<double>& baseline,
+    double max_regression);
+
+// Returns the per-iteration times, in seconds, of the runs that did not fail,
+// using the real time if `use_real_time`, and the CPU time otherwise.
+BENCHMARK_EXPORT std::vector<double> PerIterationTimes(
+    const std::vector<BenchmarkReporter::Run>& runs, bool use_real_time);
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_BASELINE_H_
@@ -55,19 +55,30 @@
 #include <thread>
 #include <utility>
 
+#include "affinity.h"
+#include "baseline.h"
 #include "check.h"
 #include "colorprint.h"
 #include "commandlineflags.h"
 #include "complexity.h"
 #include "counter.h"
+#include "isolation.h"
+#include "latency_histogram.h"
 #include "log.h"
 #include "mutex.h"
+#include "parallel_jobs.h"
 #include "perf_counters.h"
 #include "re.h"
+#include "sampling_profiler.h"
+#include "sharding.h"
 #include "statistics.h"
 #include "string_util.h"
 #include "thread_manager.h"
+#include "thread_pool.h"
 #include "thread_timer.h"
+#include "timer_overhead.h"
+#include "timers.h"
+#include "working_set.h"
 
 namespace benchmark {
 // Print a list of benchmarks. This option overrides all other options.
@@ -75,7 +86,8 @@ BM_DEFINE_bool(benchmark_list_tests, false);
 
 // A regular expression that specifies the set of benchmarks to execute.  If
 // this flag is empty, or if this flag is the string \"all\", all benchmarks
-// linked into the binary are run.
+// linked into the binary are run. With the prefix "glob:", it is a
+// comma-separated list of glob patterns instead.
 BM_DEFINE_string(benchmark_filter, "");
 
 // Specification of how long to run the benchmark.
@@ -92,7 +104,10 @@ BM_DEFINE_string(benchmark_filter, "");
 // on the total cpu time used by all threads that make up the test.  For
 // real-time based tests, this is the lower bound on the elapsed time of the
 // benchmark execution, regardless of number of threads.
-BM_DEFINE_string(benchmark_min_time, kDefaultMinTimeStr);
+//
+// Empty unless given, in which case kDefaultMinTimeStr applies, or a shorter
+// time with --benchmark_target_rel_ci.
+BM_DEFINE_string(benchmark_min_time, "");
 
 // Minimum number of seconds a benchmark should be run before results should be
 // taken into account. This e.g can be necessary for benchmarks of code which
@@ -114,6 +129,75 @@ BM_DEFINE_bool(benchmark_dry_run, false);
 // See http://github.com/google/benchmark/issues/1051 for details.
 BM_DEFINE_bool(benchmark_enable_random_interleaving, false);
 
+// If set, the threads of multi-threaded benchmarks are taken from a persistent
+// pool of workers that is reused across iteration-count probes, repetitions
+// and benchmark instances, instead of being created and joined for every run.
+// Benchmarks that provide their own ThreadRunner are not affected.
+BM_DEFINE_bool(benchmark_thread_pool, false);
+
+// How to place the threads of benchmarks on CPUs, unless a benchmark sets its
+// own policy with Affinity(). Valid values are 'none', 'compact', 'scatter',
+// 'physical_cores', 'numa_nodes' or a list of CPUs such as '0,2,4-7'. An empty
+// value leaves thread placement to the OS scheduler.
+BM_DEFINE_string(benchmark_affinity, "");
+
+// If set, StartTimer/StopTimer (and thus PauseTiming/ResumeTiming) only read
+// the cycle clock, and the real and CPU time clocks are read about once a
+// millisecond. The calibrated cost of the timer itself is subtracted.
+BM_DEFINE_bool(benchmark_fast_timing, false);
+
+// If set, the calibrated cost of an empty benchmark loop iteration and of a
+// PauseTiming/ResumeTiming pair is subtracted from the measured times. Has no
+// effect on benchmarks that use manual timing.
+BM_DEFINE_bool(benchmark_subtract_overhead, false);
+
+// If positive, repetitions are added until the 95% confidence interval of the
+// mean time is within this fraction of the mean, e.g. '0.01' for +/-1%. Each
+// repetition then runs for 0.05s unless --benchmark_min_time is given.
+BM_DEFINE_double(benchmark_target_rel_ci, 0.0);
+
+// The wall time in seconds after which --benchmark_target_rel_ci stops adding
+// repetitions to a benchmark, whether it has converged or not.
+BM_DEFINE_double(benchmark_target_rel_ci_max_time, 5.0);
+
+// The path of a previous report written by the JSON reporter. Every benchmark
+// is compared to the run of the same name in it, stops repeating once it is
+// clearly within or beyond --benchmark_max_regression, and
+// GetBaselineRegressionCount() counts the ones that regressed.
+BM_DEFINE_string(benchmark_baseline, "");
+
+// The largest slowdown against --benchmark_baseline that is not a regression,
+// as a fraction ('0.03') or a percentage ('3%').
+BM_DEFINE_string(benchmark_max_regression, "5%");
+
+// Where to run the benchmarks: 'none' runs them all in this process, and
+// 'process' forks a child process for every benchmark instance, so that one
+// instance's heap, caches and threads do not affect the next and a crash only
+// fails that instance.
+BM_DEFINE_string(benchmark_isolation, "none");
+
+// The number of benchmark instances to run at the same time, each in a child
+// process pinned to a physical core of its own. Instances that use more than
+// one thread still run alone. Values above 1 imply process isolation.
+BM_DEFINE_int32(benchmark_parallel_jobs, 1);
+
+// Splits the benchmarks that match --benchmark_filter into
+// --benchmark_shard_count shards and only runs shard --benchmark_shard_index,
+// starting at 0. Every shard makes the same split, so running all of them,
+// e.g. on separate machines, runs every benchmark once.
+BM_DEFINE_int32(benchmark_shard_index, 0);
+BM_DEFINE_int32(benchmark_shard_count, 1);
+
+// The path of a previous report written by the JSON reporter. The shards are
+// then balanced by how long their benchmarks took to run in it, instead of by
+// their number.
+BM_DEFINE_string(benchmark_shard_durations, "");
+
+// With --benchmark_isolation=process, the number of seconds after which a
+// child process is killed and its benchmark reported as failed. Zero means no
+// limit.
+BM_DEFINE_double(benchmark_isolation_timeout, 0.0);
+
 // Report the result of each benchmark repetitions. When 'true' is specified
 // only the mean, standard deviation, and other statistics are reported for
 // repeated benchmarks. Affects all reporters.
@@ -127,11 +211,11 @@ BM_DEFINE_bool(benchmark_report_aggregates_only, false);
 BM_DEFINE_bool(benchmark_display_aggregates_only, false);
 
 // The format to use for console output.
-// Valid values are 'console', 'json', or 'csv'.
+// Valid values are 'console', 'json', 'jsonl', or 'csv'.
 BM_DEFINE_string(benchmark_format, "console");
 
 // The format to use for file output.
-// Valid values are 'console', 'json', or 'csv'.
+// Valid values are 'console', 'json', 'jsonl', or 'csv'.
 BM_DEFINE_string(benchmark_out_format, "json");
 
 // The file to write additional output to.
@@ -149,8 +233,27 @@ BM_DEFINE_bool(benchmark_counters_tabular, false);
 
 // List of additional perf counters to collect, in libpfm format. For more
 // information about libpfm: https://man7.org/linux/man-pages/man3/libpfm.3.html
+// Entries starting with '@' name presets of counters with derived metrics,
+// e.g. '@topdown'.
 BM_DEFINE_string(benchmark_perf_counters, "");
 
+// Whether to count only one group of perf counters per repetition, taking
+// turns, instead of multiplexing all groups on the PMU in every repetition.
+BM_DEFINE_bool(benchmark_perf_counters_rotate, false);
+
+// Directory to write a sampled CPU profile of each benchmark instance to, as
+// collapsed stacks for flame graph tools. Empty means no profiling.
+BM_DEFINE_string(benchmark_profile_dir, "");
+
+// How the profiler of --benchmark_profile_dir records call stacks: 'fp' walks
+// the frame pointers, 'lbr' uses the CPU's last branch records and 'none' only
+// records the sampled instruction.
+BM_DEFINE_string(benchmark_profile_callchain, "fp");
+
+// Maximum number of iterations of the separate run that measures memory usage
+// when a MemoryManager is registered. Zero means as many as the timed runs.
+BM_DEFINE_int32(benchmark_memory_iterations, 16);
+
 // Extra context to include in the output formatted as comma-separated key-value
 // pairs. Kept internal as it's only used for parsing from env/command line.
 BM_DEFINE_kvpairs(benchmark_context, {});
@@ -200,13 +303,16 @@ State::State(std::string name, IterationCount max_iters,
       skipped_(internal::NotSkipped),
       range_(ranges),
       complexity_n_(0),
+      working_set_bytes_(0),
       name_(std::move(name)),
       thread_index_(thread_i),
       threads_(n_threads),
       timer_(timer),
       manager_(manager),
       perf_counters_measurement_(perf_counters_measurement),
-      profiler_manager_(profiler_manager) {
+      profiler_manager_(profiler_manager),
+      latency_sampler_(manager != nullptr ? manager->GetLatencySampler(thread_i)
+                                          : nullptr) {
   BM_CHECK(max_iterations != 0) << "At least one iteration must be run";
   BM_CHECK_LT(thread_index_, threads_)
       << "thread_index must be less than threads";
@@ -216,9 +322,12 @@ State::State(std::string name, IterationCount max_iters,
   // won't have the flag.  Inserting them now also reduces the allocations
   // during the benchmark.
   if (perf_counters_measurement_ != nullptr) {
-    for (const std::string& counter_name :
-         perf_counters_measurement_->names()) {
-      counters[counter_name] = Counter(0.0, Counter::kAvgIterations);
+    const std::vector<std::string>& counter_names =
+        perf_counters_measurement_->names();
+    for (size_t i = 0; i < counter_names.size(); ++i) {
+      if (perf_counters_measurement_->IsMeasured(i)) {
+        counters[counter_names[i]] = Counter(0.0, Counter::kAvgIterations);
+      }
     }
   }
 
@@ -263,6 +372,11 @@ State::State(std::string name, IterationCount max_iters,
 void State::PauseTiming() {
   // Add in time accumulated so far
   BM_CHECK(started_ && !finished_ && !skipped());
+  // The latency sample stops first and restarts last, so that it includes
+  // none of the cost of pausing.
+  if (latency_sampler_ != nullptr) {
+    latency_sampler_->Pause();
+  }
   timer_->StopTimer();
   if (perf_counters_measurement_ != nullptr) {
     std::vector<std::pair<std::string, double>> measurements;
@@ -285,6 +399,9 @@ void State::ResumeTiming() {
   if (perf_counters_measurement_ != nullptr) {
     perf_counters_measurement_->Start();
   }
+  if (latency_sampler_ != nullptr) {
+    latency_sampler_->Resume();
+  }
 }
 
 void State::SkipWithMessage(const std::string& msg) {
@@ -330,10 +447,17 @@ void State::StartKeepRunning() {
   BM_CHECK(!started_ && !finished_);
   started_ = true;
   total_iterations_ = skipped() ? 0 : max_iterations;
+  if (latency_sampler_ != nullptr) {
+    // The sampler counts the iterations, one call to NextLatencySample() at a
+    // time, so that each of them can be timed.
+    latency_sampler_->Start(total_iterations_);
+    total_iterations_ = 0;
+  }
   if (BENCHMARK_BUILTIN_EXPECT(profiler_manager_ != nullptr, false)) {
     profiler_manager_->AfterSetupStart();
   }
   manager_->StartStopBarrier();
+  manager_->GetThreadResult(thread_index_).start_time = ChronoClockNow();
   if (!skipped()) {
     ResumeTiming();
   }
@@ -344,15 +468,23 @@ void State::FinishKeepRunning() {
   if (!skipped()) {
     PauseTiming();
   }
+  timer_->Finish();
   // Total iterations has now wrapped around past 0. Fix this.
   total_iterations_ = 0;
   finished_ = true;
+  const double barrier_start = ChronoClockNow();
   manager_->StartStopBarrier();
+  manager_->GetThreadResult(thread_index_).barrier_wait_time =
+      ChronoClockNow() - barrier_start;
   if (BENCHMARK_BUILTIN_EXPECT(profiler_manager_ != nullptr, false)) {
     profiler_manager_->BeforeTeardownStop();
   }
 }
 
+bool State::NextLatencySample(IterationCount n) {
+  return !skipped() && latency_sampler_->Next(n);
+}
+
 namespace internal {
 namespace {
 
@@ -366,15 +498,120 @@ void FlushStreams(BenchmarkReporter* reporter) {
   std::flush(reporter->GetErrorStream());
 }
 
-// Reports in both display and file reporters.
+// Returns, for every benchmark, the index of the benchmark it is compared to
+// with CompareTo(), or -1. The baseline is the benchmark of that family with
+// the same arguments and thread count. A baseline is paired with the first
+// candidate that names it only.
+std::vector<int> FindComparisonBaselines(
+    const std::vector<BenchmarkInstance>& benchmarks) {
+  std::vector<int> baselines(benchmarks.size(), -1);
+  std::vector<bool> paired(benchmarks.size(), false);
+  for (size_t i = 0; i < benchmarks.size(); ++i) {
+    const BenchmarkInstance& candidate = benchmarks[i];
+    if (candidate.compare_to().empty()) {
+      continue;
+    }
+    for (size_t j = 0; j < benchmarks.size(); ++j) {
+      const BenchmarkName& name = benchmarks[j].name();
+      if (j != i && !paired[j] && !paired[i] &&
+          name.function_name == candidate.compare_to() &&
+          name.args == candidate.name().args &&
+          name.threads == candidate.name().threads) {
+        baselines[i] = static_cast<int>(j);
+        paired[i] = paired[j] = true;
+        break;
+      }
+    }
+    if (baselines[i] < 0) {
+      GetErrorLogInstance()
+          << "***WARNING*** " << candidate.name().str()
+          << " is compared to " << candidate.compare_to()
+          << ", but no such benchmark with the same arguments is run or it is "
+             "already compared to another one.\n";
+    }
+  }
+  return baselines;
+}
+
+// Returns the order in which to run the repetitions of the benchmarks, as
+// indices into `num_repeats`. The repetitions of a candidate and its
+// baseline alternate, with the order within a pair alternating as well
+// (ABBA...) so that neither side always runs first, and the last pair ending
+// with the candidate. The shuffle keeps the pairs together.
+std::vector<size_t> ScheduleRepetitions(const std::vector<int>& num_repeats,
+                                        const std::vector<int>& baselines,
+                                        bool shuffle) {
+  std::vector<int> partners(num_repeats.size(), -1);
+  for (size_t i = 0; i < baselines.size(); ++i) {
+    if (baselines[i] >= 0) {
+      partners[i] = baselines[i];
+      partners[static_cast<size_t>(baselines[i])] = static_cast<int>(i);
+    }
+  }
+
+  std::vector<std::vector<size_t>> units;
+  std::vector<bool> scheduled(num_repeats.size(), false);
+  for (size_t i = 0; i < num_repeats.size(); ++i) {
+    if (scheduled[i]) {
+      continue;
+    }
+    scheduled[i] = true;
+    if (partners[i] < 0) {
+      units.insert(units.end(), static_cast<size_t>(num_repeats[i]), {i});
+      continue;
+    }
+    const size_t partner = static_cast<size_t>(partners[i]);
+    scheduled[partner] = true;
+    const size_t candidate = baselines[i] >= 0 ? i : partner;
+    const size_t baseline = baselines[i] >= 0 ? partner : i;
+    const int pairs = std::min(num_repeats[i], num_repeats[partner]);
+    for (int k = 0; k < pairs; ++k) {
+      if ((pairs - 1 - k) % 2 == 0) {
+        units.push_back({baseline, candidate});
+      } else {
+        units.push_back({candidate, baseline});
+      }
+    }
+    units.insert(units.end(),
+                 static_cast<size_t>(num_repeats[baseline] - pairs),
+                 {baseline});
+    units.insert(units.end(),
+                 static_cast<size_t>(num_repeats[candidate] - pairs),
+                 {candidate});
+  }
+
+  if (shuffle) {
+    std::random_device rd;
+    std::mt19937 g(rd());
+    std::shuffle(units.begin(), units.end(), g);
+  }
+
+  std::vector<size_t> order;
+  for (const std::vector<size_t>& unit : units) {
+    order.insert(order.end(), unit.begin(), unit.end());
+  }
+  return order;
+}
+
+// Which reporters were passed the repetitions of an instance as they finished.
+struct StreamedRuns {
+  bool config = false;   // ReportRunsConfig() has been called.
+  bool display = false;  // The display reporter took every repetition.
+  bool file = false;     // The file reporter took every repetition.
+};
+
+// Reports in both display and file reporters, leaving out the runs that were
+// already streamed to them.
 void Report(BenchmarkReporter* display_reporter,
-            BenchmarkReporter* file_reporter, const RunResults& run_results) {
+            BenchmarkReporter* file_reporter, const RunResults& run_results,
+            const StreamedRuns& streamed) {
   auto report_one = [](BenchmarkReporter* reporter, bool aggregates_only,
+                       bool non_aggregates_streamed,
                        const RunResults& results) {
     assert(reporter);
     // If there are no aggregates, do output non-aggregates.
     aggregates_only &= !results.aggregates_only.empty();
-    if (!aggregates_only) {
+    if (!aggregates_only && !non_aggregates_streamed) {
       reporter->ReportRuns(results.non_aggregates);
     }
     if (!results.aggregates_only.empty()) {
@@ -383,24 +620,30 @@ void Report(BenchmarkReporter* display_reporter,
   };
 
   report_one(display_reporter, run_results.display_report_aggregates_only,
-             run_results);
+             streamed.display, run_results);
   if (file_reporter != nullptr) {
     report_one(file_reporter, run_results.file_report_aggregates_only,
-               run_results);
+               streamed.file, run_results);
   }
 
   FlushStreams(display_reporter);
   FlushStreams(file_reporter);
 }
 
+// The number of benchmarks that regressed against --benchmark_baseline in
+// the last call to RunSpecifiedBenchmarks().
+size_t num_baseline_regressions = 0;
+
 void RunBenchmarks(const std::vector<BenchmarkInstance>& benchmarks,
                    BenchmarkReporter* display_reporter,
-                   BenchmarkReporter* file_reporter) {
+                   BenchmarkReporter* file_reporter,
+                   const Baseline* baseline) {
   // Note the file_reporter can be null.
   BM_CHECK(display_reporter != nullptr);
 
   // Determine the width of the name field using a minimum width of 10.
-  bool might_have_aggregates = FLAGS_benchmark_repetitions > 1;
+  bool might_have_aggregates =
+      FLAGS_benchmark_repetitions > 1 || FLAGS_benchmark_target_rel_ci > 0;
   size_t name_field_width = 10;
   size_t stat_field_width = 0;
   for (const BenchmarkInstance& benchmark : benchmarks) {
@@ -411,6 +654,27 @@ void RunBenchmarks(const std::vector<BenchmarkInstance>& benchmarks,
     for (const auto& Stat : benchmark.statistics()) {
       stat_field_width = std::max<size_t>(stat_field_width, Stat.name_.size());
     }
+    if (benchmark.latency_histogram()) {
+      // Latency percentiles are reported even without repetitions.
+      might_have_aggregates = true;
+      stat_field_width = std::max<size_t>(stat_field_width, strlen("p99.9"));
+    }
+  }
+  if (FLAGS_benchmark_target_rel_ci > 0) {
+    stat_field_width = std::max<size_t>(stat_field_width, strlen("rel_ci"));
+  }
+  if (std::any_of(benchmarks.begin(), benchmarks.end(),
+                  [](const BenchmarkInstance& benchmark) {
+                    return !benchmark.compare_to().empty();
+                  })) {
+    might_have_aggregates = true;
+    stat_field_width =
+        std::max<size_t>(stat_field_width, strlen("paired_ci_high"));
+  }
+  if (baseline != nullptr) {
+    might_have_aggregates = true;
+    stat_field_width =
+        std::max<size_t>(stat_field_width, strlen("baseline_diff"));
   }
   if (might_have_aggregates) {
     name_field_width += 1 + stat_field_width;
@@ -419,6 +683,13 @@ void RunBenchmarks(const std::vector<BenchmarkInstance>& benchmarks,
   // Print header here
   BenchmarkReporter::Context context;
   context.name_field_width = name_field_width;
+  // Calibrating takes a while, so it is only done when the overhead is
+  // subtracted. Doing it here, before any benchmark runs, also keeps it out of
+  // the isolated benchmark processes.
+  if (FLAGS_benchmark_subtract_overhead) {
+    context.timer_overhead = GetTimerOverhead(FLAGS_benchmark_fast_timing);
+    context.timer_overhead.subtracted = true;
+  }
 
   // Keep track of running times of all instances of each benchmark family.
   std::map<int /*family_index*/, BenchmarkReporter::PerFamilyRunReports>
@@ -436,22 +707,26 @@ void RunBenchmarks(const std::vector<BenchmarkInstance>& benchmarks,
     PerfCountersMeasurement perfcounters(
         StrSplit(FLAGS_benchmark_perf_counters, ','));
 
+    double max_regression = 0;
+    ParseMaxRegression(FLAGS_benchmark_max_regression, &max_regression);
+
     // Vector of benchmarks to run
     std::vector<internal::BenchmarkRunner> runners;
     runners.reserve(benchmarks.size());
 
-    // Count the number of benchmarks with threads to warn the user in case
-    // performance counters are used.
-    int benchmarks_with_threads = 0;
-
     // Loop through all benchmarks
     for (const BenchmarkInstance& benchmark : benchmarks) {
       BenchmarkReporter::PerFamilyRunReports* reports_for_family = nullptr;
       if (benchmark.complexity() != oNone) {
         reports_for_family = &per_family_reports[benchmark.family_index()];
       }
-      benchmarks_with_threads += static_cast<int>(benchmark.threads() > 1);
       runners.emplace_back(benchmark, &perfcounters, reports_for_family);
+      if (baseline != nullptr) {
+        auto it = baseline->find(benchmark.name().str());
+        if (it != baseline->end()) {
+          runners.back().SetBaseline(&it->second, max_regression);
+        }
+      }
       int num_repeats_of_this_instance = runners.back().GetNumRepeats();
       num_repetitions_total +=
           static_cast<size_t>(num_repeats_of_this_instance);
@@ -461,55 +736,147 @@ void RunBenchmarks(const std::vector<BenchmarkInstance>& benchmarks,
     }
     assert(runners.size() == benchmarks.size() && "Unexpected runner count.");
 
-    // The use of performance counters with threads would be unintuitive for
-    // the average user so we need to warn them about this case
-    if ((benchmarks_with_threads > 0) && (perfcounters.num_counters() > 0)) {
-      GetErrorLogInstance()
-          << "***WARNING*** There are " << benchmarks_with_threads
-          << " benchmarks with threads and " << perfcounters.num_counters()
-          << " performance counters were requested. Beware counters will "
-             "reflect the combined usage across all "
-             "threads.\n";
+    // With rotation, a benchmark only sees the counter groups whose turn
+    // came up in one of its repetitions.
+    if (FLAGS_benchmark_perf_counters_rotate &&
+        perfcounters.num_groups() > 1) {
+      const size_t num_groups = perfcounters.num_groups();
+      const bool too_few_repeats = std::any_of(
+          runners.begin(), runners.end(),
+          [num_groups](const internal::BenchmarkRunner& runner) {
+            return static_cast<size_t>(runner.GetNumRepeats()) < num_groups;
+          });
+      if (too_few_repeats) {
+        GetErrorLogInstance()
+            << "***WARNING*** The performance counters are split into "
+            << num_groups << " groups, counted in turns across repetitions. "
+            << "Benchmarks with fewer repetitions will miss some counters.\n";
+      }
     }
 
-    std::vector<size_t> repetition_indices;
-    repetition_indices.reserve(num_repetitions_total);
-    for (size_t runner_index = 0, num_runners = runners.size();
-         runner_index != num_runners; ++runner_index) {
-      const internal::BenchmarkRunner& runner = runners[runner_index];
-      std::fill_n(std::back_inserter(repetition_indices),
-                  runner.GetNumRepeats(), runner_index);
+    const std::vector<int> baselines = FindComparisonBaselines(benchmarks);
+    std::vector<int> num_repeats;
+    num_repeats.reserve(runners.size());
+    for (const internal::BenchmarkRunner& runner : runners) {
+      num_repeats.push_back(runner.GetNumRepeats());
     }
+    const std::vector<size_t> repetition_indices = ScheduleRepetitions(
+        num_repeats, baselines, FLAGS_benchmark_enable_random_interleaving);
     assert(repetition_indices.size() == num_repetitions_total &&
            "Unexpected number of repetition indexes.");
+    (void)num_repetitions_total;
 
-    if (FLAGS_benchmark_enable_random_interleaving) {
-      std::random_device rd;
-      std::mt19937 g(rd());
-      std::shuffle(repetition_indices.begin(), repetition_indices.end(), g);
-    }
-
-    for (size_t repetition_index : repetition_indices) {
-      internal::BenchmarkRunner& runner = runners[repetition_index];
-      runner.DoOneRepetition();
-      if (runner.HasRepeatsRemaining()) {
-        continue;
+    // Compares an instance with its run in the baseline report, if any.
+    auto add_baseline_stats = [&](size_t runner_index,
+                                  RunResults& run_results) {
+      if (baseline == nullptr) {
+        return;
+      }
+      const BenchmarkInstance& benchmark = benchmarks[runner_index];
+      auto it = baseline->find(benchmark.name().str());
+      const auto successful_run = std::find_if(
+          run_results.non_aggregates.begin(), run_results.non_aggregates.end(),
+          [](const BenchmarkReporter::Run& run) {
+            return run.skipped == internal::NotSkipped;
+          });
+      if (it == baseline->end() ||
+          successful_run == run_results.non_aggregates.end()) {
+        return;
       }
-      // FIXME: report each repetition separately, not all of them in bulk.
+      const BaselineComparison real = CompareToBaseline(
+          PerIterationTimes(run_results.non_aggregates, true),
+          it->second.real_time, max_regression);
+      const BaselineComparison cpu = CompareToBaseline(
+          PerIterationTimes(run_results.non_aggregates, false),
+          it->second.cpu_time, max_regression);
+      const bool regressed =
+          benchmark.use_real_time() || benchmark.use_manual_time()
+              ? real.Regressed(max_regression)
+              : cpu.Regressed(max_regression);
+
+      BenchmarkReporter::Run data;
+      data.run_name = successful_run->run_name;
+      data.family_index = successful_run->family_index;
+      data.per_family_instance_index =
+          successful_run->per_family_instance_index;
+      data.run_type = BenchmarkReporter::Run::RT_Aggregate;
+      data.threads = successful_run->threads;
+      data.repetitions = successful_run->repetitions;
+      data.repetition_index = BenchmarkReporter::Run::no_repetition_index;
+      data.aggregate_name = "baseline_diff";
+      data.aggregate_unit = StatisticUnit::kPercentage;
+      data.report_label = regressed ? "REGRESSION" : "";
+      data.iterations =
+          static_cast<IterationCount>(run_results.non_aggregates.size());
+      data.real_accumulated_time = real.diff;
+      data.cpu_accumulated_time = cpu.diff;
+      data.time_unit = successful_run->time_unit;
+      run_results.aggregates_only.push_back(data);
+
+      if (regressed) {
+        ++num_baseline_regressions;
+        const double diff =
+            benchmark.use_real_time() || benchmark.use_manual_time()
+                ? real.diff
+                : cpu.diff;
+        GetErrorLogInstance()
+            << "***REGRESSION*** " << benchmark.name().str() << " is "
+            << StrFormat("%.1f%%", 100 * diff)
+            << " slower than the baseline, more than the allowed "
+            << StrFormat("%.1f%%", 100 * max_regression) << ".\n";
+      }
+    };
+
+    const ThreadPool::Stats pool_stats_before = ThreadPool::Get().GetStats();
 
+    auto report_config = [&](const internal::BenchmarkRunner& runner) {
       display_reporter->ReportRunsConfig(
           runner.GetMinTime(), runner.HasExplicitIters(), runner.GetIters());
       if (file_reporter != nullptr) {
         file_reporter->ReportRunsConfig(
             runner.GetMinTime(), runner.HasExplicitIters(), runner.GetIters());
       }
-
-      RunResults run_results = runner.GetResults();
+    };
+
+    // Passes the repetition that has just finished to the reporters that are
+    // not limited to aggregates, so that it shows up without waiting for the
+    // other repetitions of the instance. Runs whose number of repetitions can
+    // still change are held back until it is final.
+    auto report_repetition = [&](const internal::BenchmarkRunner& runner,
+                                 StreamedRuns* streamed) {
+      if (!runner.HasFixedRepetitions()) {
+        return;
+      }
+      if (!streamed->config) {
+        report_config(runner);
+        streamed->config = true;
+      }
+      const RunResults& partial = runner.GetPartialResults();
+      const BenchmarkReporter::Run& run = partial.non_aggregates.back();
+      if (!partial.display_report_aggregates_only) {
+        streamed->display = display_reporter->ReportRepetition(run);
+      }
+      if (file_reporter != nullptr && !partial.file_report_aggregates_only) {
+        streamed->file = file_reporter->ReportRepetition(run);
+      }
+      FlushStreams(display_reporter);
+      FlushStreams(file_reporter);
+    };
+
+    // Reports the aggregates of an instance, and its repetitions if they
+    // have not been streamed already.
+    auto report_results = [&](internal::BenchmarkRunner& runner,
+                              RunResults& run_results,
+                              const StreamedRuns& streamed) {
+      if (!streamed.config) {
+        report_config(runner);
+      }
 
       // Maybe calculate complexity report
       if (const auto* reports_for_family = runner.GetReportsForFamily()) {
         if (reports_for_family->num_runs_done ==
-            reports_for_family->num_runs_total) {
+                reports_for_family->num_runs_total &&
+            !reports_for_family->Runs.empty()) {
           auto additional_run_stats = ComputeBigO(reports_for_family->Runs);
           run_results.aggregates_only.insert(run_results.aggregates_only.end(),
                                              additional_run_stats.begin(),
@@ -519,7 +886,182 @@ void RunBenchmarks(const std::vector<BenchmarkInstance>& benchmarks,
         }
       }
 
-      Report(display_reporter, file_reporter, run_results);
+      Report(display_reporter, file_reporter, run_results, streamed);
+    };
+
+    // The paired statistics of a comparison belong to the candidate, so a
+    // candidate that finishes before its baseline is only reported once the
+    // baseline is done. Every benchmark takes part in one comparison at most.
+    struct PendingCandidate {
+      size_t runner_index;
+      RunResults results;
+      StreamedRuns streamed;
+    };
+    std::map<size_t, PendingCandidate> pending_candidates;
+    std::vector<bool> baseline_done(runners.size(), false);
+    std::vector<std::vector<BenchmarkReporter::Run>> baseline_runs(
+        runners.size());
+    auto report_finished = [&](size_t runner_index, RunResults& run_results,
+                               const StreamedRuns& streamed) {
+      add_baseline_stats(runner_index, run_results);
+      report_results(runners[runner_index], run_results, streamed);
+    };
+    auto add_paired_stats =
+        [](const std::vector<BenchmarkReporter::Run>& baseline_non_aggregates,
+           RunResults& candidate_results) {
+          const std::vector<BenchmarkReporter::Run> paired =
+              ComputePairedStats(baseline_non_aggregates,
+                                 candidate_results.non_aggregates);
+          candidate_results.aggregates_only.insert(
+              candidate_results.aggregates_only.end(), paired.begin(),
+              paired.end());
+        };
+    auto finish_runner = [&](size_t runner_index, RunResults run_results,
+                             const StreamedRuns& streamed) {
+      const int baseline_index = baselines[runner_index];
+      if (baseline_index >= 0) {
+        const size_t b = static_cast<size_t>(baseline_index);
+        if (!baseline_done[b]) {
+          pending_candidates.emplace(
+              b, PendingCandidate{runner_index, std::move(run_results),
+                                  streamed});
+          return;
+        }
+        add_paired_stats(baseline_runs[b], run_results);
+        baseline_runs[b].clear();
+      }
+      report_finished(runner_index, run_results, streamed);
+
+      baseline_done[runner_index] = true;
+      auto pending = pending_candidates.find(runner_index);
+      if (pending != pending_candidates.end()) {
+        add_paired_stats(run_results.non_aggregates, pending->second.results);
+        report_finished(pending->second.runner_index, pending->second.results,
+                        pending->second.streamed);
+        pending_candidates.erase(pending);
+      } else if (std::find(baselines.begin(), baselines.end(),
+                           static_cast<int>(runner_index)) !=
+                 baselines.end()) {
+        baseline_runs[runner_index] = run_results.non_aggregates;
+      }
+    };
+
+    IsolationMode isolation = kIsolationNone;
+    ParseIsolation(FLAGS_benchmark_isolation, &isolation);
+    std::vector<int> parallel_cpus;
+    if (FLAGS_benchmark_parallel_jobs > 1) {
+      parallel_cpus = PlanParallelJobCpus(FLAGS_benchmark_parallel_jobs,
+                                          GetCpuTopology());
+      isolation = kIsolationProcess;
+    }
+    if (isolation != kIsolationNone && !IsolationSupported()) {
+      GetErrorLogInstance() << "***WARNING*** Process isolation is not "
+                               "supported on this platform, running the "
+                               "benchmarks in this process.\n";
+      isolation = kIsolationNone;
+    }
+
+    if (isolation == kIsolationProcess) {
+      // The children inherit the peak memory bandwidth rather than each
+      // measuring it, possibly while other jobs are being timed. Any of them
+      // might call SetWorkingSetBytes(), so it is always measured.
+      if (!FLAGS_benchmark_dry_run) {
+        GetPeakMemoryBandwidth();
+      }
+      DisallowMemoryBandwidthProbe();
+
+      // Each child runs all repetitions of an instance, so interleaving only
+      // shuffles the instances.
+      std::vector<size_t> order;
+      std::vector<bool> seen(runners.size(), false);
+      for (size_t runner_index : repetition_indices) {
+        if (!seen[runner_index]) {
+          seen[runner_index] = true;
+          order.push_back(runner_index);
+        }
+      }
+      std::vector<ChildJob> jobs;
+      jobs.reserve(order.size());
+      for (size_t runner_index : order) {
+        internal::BenchmarkRunner& runner = runners[runner_index];
+        ChildJob job;
+        job.exclusive = !runner.CanRunInParallel();
+        job.fn = [&runner, &perfcounters, &parallel_cpus](int slot) {
+          ScopedThreadAffinity affinity(
+              slot < 0 || parallel_cpus.empty()
+                  ? -1
+                  : parallel_cpus[static_cast<size_t>(slot)]);
+          if (perfcounters.num_counters() > 0) {
+            perfcounters.Reopen();
+          }
+          while (runner.HasRepeatsRemaining() ||
+                 runner.AddRepetitionIfUnconverged()) {
+            runner.DoOneRepetition();
+          }
+          return runner.GetResults();
+        };
+        jobs.push_back(std::move(job));
+      }
+
+      RunInChildProcesses(
+          jobs, std::max<int>(1, static_cast<int>(parallel_cpus.size())),
+          FLAGS_benchmark_isolation_timeout,
+          [&](size_t job, bool ok, RunResults& results,
+              const std::string& error) {
+            internal::BenchmarkRunner& runner = runners[order[job]];
+            RunResults run_results =
+                ok ? std::move(results)
+                   : runner.GetFailedResults("benchmark process " + error);
+            if (auto* reports_for_family = runner.GetReportsForFamily()) {
+              // The child only added its runs to its own copy of the family.
+              const int num_runs =
+                  static_cast<int>(run_results.non_aggregates.size());
+              reports_for_family->num_runs_total +=
+                  num_runs - runner.GetNumRepeats();
+              reports_for_family->num_runs_done += num_runs;
+              for (const BenchmarkReporter::Run& run :
+                   run_results.non_aggregates) {
+                if (run.skipped == 0u) {
+                  reports_for_family->Runs.push_back(run);
+                }
+              }
+            }
+            finish_runner(order[job], std::move(run_results), StreamedRuns());
+          });
+    } else {
+      std::vector<StreamedRuns> streamed(runners.size());
+      for (size_t repetition_index : repetition_indices) {
+        internal::BenchmarkRunner& runner = runners[repetition_index];
+        if (!runner.HasRepeatsRemaining()) {
+          // Stopped early against the baseline.
+          continue;
+        }
+        runner.DoOneRepetition();
+        report_repetition(runner, &streamed[repetition_index]);
+        while (!runner.HasRepeatsRemaining() &&
+               runner.AddRepetitionIfUnconverged()) {
+          runner.DoOneRepetition();
+          report_repetition(runner, &streamed[repetition_index]);
+        }
+        if (runner.HasRepeatsRemaining()) {
+          continue;
+        }
+        finish_runner(repetition_index, runner.GetResults(),
+                      streamed[repetition_index]);
+      }
+    }
+
+    if (FLAGS_benchmark_thread_pool) {
+      const ThreadPool::Stats pool_stats = ThreadPool::Get().GetStats();
+      const int64_t created =
+          pool_stats.threads_created - pool_stats_before.threads_created;
+      const int64_t reused =
+          pool_stats.threads_reused - pool_stats_before.threads_reused;
+      if (created + reused > 0) {
+        GetErrorLogInstance()
+            << "Thread pool: " << created << " worker threads created, "
+            << reused << " reused.\n";
+      }
     }
   }
   display_reporter->Finalize();
@@ -543,6 +1085,9 @@ std::unique_ptr<BenchmarkReporter> CreateReporter(
   if (name == "json") {
     return PtrType(new JSONReporter());
   }
+  if (name == "jsonl") {
+    return PtrType(new JSONReporter(JSONReporter::OF_Lines));
+  }
   if (name == "csv") {
     return PtrType(new CSVReporter());
   }
@@ -590,6 +1135,10 @@ std::unique_ptr<BenchmarkReporter> CreateDefaultDisplayReporter() {
                                   internal::GetOutputOptions());
 }
 
+size_t GetBaselineRegressionCount() {
+  return internal::num_baseline_regressions;
+}
+
 size_t RunSpecifiedBenchmarks() {
   return RunSpecifiedBenchmarks(nullptr, nullptr, FLAGS_benchmark_filter);
 }
@@ -659,6 +1208,34 @@ size_t RunSpecifiedBenchmarks(BenchmarkReporter* display_reporter,
     file_reporter->SetErrorStream(&output_file);
   }
 
+  internal::num_baseline_regressions = 0;
+  internal::Baseline baseline;
+  if (!FLAGS_benchmark_baseline.empty() && !FLAGS_benchmark_dry_run) {
+    std::string error;
+    if (!internal::LoadBaseline(FLAGS_benchmark_baseline, &baseline,
+                                &error)) {
+      Err << "invalid baseline '" << FLAGS_benchmark_baseline
+          << "': " << error << "\n";
+      Out.flush();
+      Err.flush();
+      std::exit(1);
+    }
+  }
+
+  if (!FLAGS_benchmark_profile_dir.empty() &&
+      internal::sampling_profiler == nullptr) {
+    if (internal::profiler_manager != nullptr) {
+      Err << "A ProfilerManager is already registered; ignoring "
+             "--benchmark_profile_dir.\n";
+    } else {
+      internal::ProfileCallchain callchain = internal::PC_FramePointer;
+      internal::ParseProfileCallchain(FLAGS_benchmark_profile_callchain,
+                                      &callchain);
+      internal::sampling_profiler = new internal::SamplingProfiler(callchain);
+      internal::profiler_manager = internal::sampling_profiler;
+    }
+  }
+
   std::vector<internal::BenchmarkInstance> benchmarks;
   if (!FindBenchmarksInternal(spec, &benchmarks, &Err)) {
     Out.flush();
@@ -673,10 +1250,41 @@ size_t RunSpecifiedBenchmarks(BenchmarkReporter* display_reporter,
     return 0;
   }
 
+  if (FLAGS_benchmark_shard_count > 1) {
+    internal::RunDurations durations;
+    std::string error;
+    if (!FLAGS_benchmark_shard_durations.empty() &&
+        !internal::LoadRunDurations(FLAGS_benchmark_shard_durations,
+                                    &durations, &error)) {
+      Err << "invalid shard durations '" << FLAGS_benchmark_shard_durations
+          << "': " << error << "\n";
+      Out.flush();
+      Err.flush();
+      std::exit(1);
+    }
+    std::vector<internal::BenchmarkInstance> shard;
+    for (size_t i : internal::SelectShard(benchmarks, durations,
+                                          FLAGS_benchmark_shard_index,
+                                          FLAGS_benchmark_shard_count)) {
+      shard.push_back(std::move(benchmarks[i]));
+    }
+    benchmarks.swap(shard);
+    // An empty shard still reports its context, so that the reports of all
+    // shards can be merged.
+    if (benchmarks.empty()) {
+      Err << "Shard " << FLAGS_benchmark_shard_index << " of "
+          << FLAGS_benchmark_shard_count << " has no benchmarks to run.\n";
+    }
+  }
+
   if (FLAGS_benchmark_list_tests) {
     display_reporter->List(benchmarks);
   } else {
-    internal::RunBenchmarks(benchmarks, display_reporter, file_reporter);
+    internal::RunBenchmarks(
+        benchmarks, display_reporter, file_reporter,
+        FLAGS_benchmark_baseline.empty() || FLAGS_benchmark_dry_run
+            ? nullptr
+            : &baseline);
   }
 
   Out.flush();
@@ -768,9 +1376,37 @@ void ParseCommandLineFlags(int* argc, char** argv) {
                         &FLAGS_benchmark_min_warmup_time) ||
         ParseInt32Flag(argv[i], "benchmark_repetitions",
                        &FLAGS_benchmark_repetitions) ||
+        ParseDoubleFlag(argv[i], "benchmark_target_rel_ci",
+                        &FLAGS_benchmark_target_rel_ci) ||
+        ParseDoubleFlag(argv[i], "benchmark_target_rel_ci_max_time",
+                        &FLAGS_benchmark_target_rel_ci_max_time) ||
+        ParseStringFlag(argv[i], "benchmark_baseline",
+                        &FLAGS_benchmark_baseline) ||
+        ParseStringFlag(argv[i], "benchmark_max_regression",
+                        &FLAGS_benchmark_max_regression) ||
         ParseBoolFlag(argv[i], "benchmark_dry_run", &FLAGS_benchmark_dry_run) ||
         ParseBoolFlag(argv[i], "benchmark_enable_random_interleaving",
                       &FLAGS_benchmark_enable_random_interleaving) ||
+        ParseBoolFlag(argv[i], "benchmark_thread_pool",
+                      &FLAGS_benchmark_thread_pool) ||
+        ParseStringFlag(argv[i], "benchmark_affinity",
+                        &FLAGS_benchmark_affinity) ||
+        ParseBoolFlag(argv[i], "benchmark_fast_timing",
+                      &FLAGS_benchmark_fast_timing) ||
+        ParseBoolFlag(argv[i], "benchmark_subtract_overhead",
+                      &FLAGS_benchmark_subtract_overhead) ||
+        ParseStringFlag(argv[i], "benchmark_isolation",
+                        &FLAGS_benchmark_isolation) ||
+        ParseDoubleFlag(argv[i], "benchmark_isolation_timeout",
+                        &FLAGS_benchmark_isolation_timeout) ||
+        ParseInt32Flag(argv[i], "benchmark_parallel_jobs",
+                       &FLAGS_benchmark_parallel_jobs) ||
+        ParseInt32Flag(argv[i], "benchmark_shard_index",
+                       &FLAGS_benchmark_shard_index) ||
+        ParseInt32Flag(argv[i], "benchmark_shard_count",
+                       &FLAGS_benchmark_shard_count) ||
+        ParseStringFlag(argv[i], "benchmark_shard_durations",
+                        &FLAGS_benchmark_shard_durations) ||
         ParseBoolFlag(argv[i], "benchmark_report_aggregates_only",
                       &FLAGS_benchmark_report_aggregates_only) ||
         ParseBoolFlag(argv[i], "benchmark_display_aggregates_only",
@@ -784,6 +1420,14 @@ void ParseCommandLineFlags(int* argc, char** argv) {
                       &FLAGS_benchmark_counters_tabular) ||
         ParseStringFlag(argv[i], "benchmark_perf_counters",
                         &FLAGS_benchmark_perf_counters) ||
+        ParseBoolFlag(argv[i], "benchmark_perf_counters_rotate",
+                      &FLAGS_benchmark_perf_counters_rotate) ||
+        ParseStringFlag(argv[i], "benchmark_profile_dir",
+                        &FLAGS_benchmark_profile_dir) ||
+        ParseStringFlag(argv[i], "benchmark_profile_callchain",
+                        &FLAGS_benchmark_profile_callchain) ||
+        ParseInt32Flag(argv[i], "benchmark_memory_iterations",
+                       &FLAGS_benchmark_memory_iterations) ||
         ParseKeyValueFlag(argv[i], "benchmark_context",
                           &FLAGS_benchmark_context) ||
         ParseStringFlag(argv[i], "benchmark_time_unit",
@@ -801,17 +1445,83 @@ void ParseCommandLineFlags(int* argc, char** argv) {
   }
   for (auto const* flag :
        {&FLAGS_benchmark_format, &FLAGS_benchmark_out_format}) {
-    if (*flag != "console" && *flag != "json" && *flag != "csv") {
+    if (*flag != "console" && *flag != "json" && *flag != "jsonl" &&
+        *flag != "csv") {
       PrintUsageAndExit();
     }
   }
   SetDefaultTimeUnitFromFlag(FLAGS_benchmark_time_unit);
+  {
+    AffinityPolicy policy = kAffinityUnspecified;
+    std::vector<int> cpus;
+    if (!ParseAffinity(FLAGS_benchmark_affinity, &policy, &cpus)) {
+      PrintUsageAndExit();
+    }
+  }
+  {
+    ProfileCallchain callchain = PC_None;
+    if (!ParseProfileCallchain(FLAGS_benchmark_profile_callchain,
+                               &callchain)) {
+      PrintUsageAndExit();
+    }
+  }
+  {
+    double max_regression = 0;
+    if (!ParseMaxRegression(FLAGS_benchmark_max_regression, &max_regression)) {
+      PrintUsageAndExit();
+    }
+  }
+  {
+    IsolationMode isolation = kIsolationNone;
+    if (!ParseIsolation(FLAGS_benchmark_isolation, &isolation)) {
+      PrintUsageAndExit();
+    }
+    if (isolation == kIsolationProcess) {
+      AddCustomContext("isolation", "process");
+    }
+  }
+  if (FLAGS_benchmark_shard_count < 1 || FLAGS_benchmark_shard_index < 0 ||
+      FLAGS_benchmark_shard_index >= FLAGS_benchmark_shard_count) {
+    PrintUsageAndExit();
+  }
+  if (FLAGS_benchmark_shard_count > 1) {
+    // Lets tools merge the reports of all shards.
+    AddCustomContext("shard_index", StrCat(FLAGS_benchmark_shard_index));
+    AddCustomContext("shard_count", StrCat(FLAGS_benchmark_shard_count));
+  }
+  if (FLAGS_benchmark_parallel_jobs > 1 && IsolationSupported()) {
+    const std::vector<int> cpus =
+        PlanParallelJobCpus(FLAGS_benchmark_parallel_jobs, GetCpuTopology());
+    if (static_cast<int>(cpus.size()) < FLAGS_benchmark_parallel_jobs) {
+      GetErrorLogInstance()
+          << "***WARNING*** Only " << cpus.size()
+          << " physical cores are available, running that many parallel "
+             "jobs.\n";
+    }
+    // Measure how much the jobs slow each other down.
+    AddCustomContext("parallel_jobs", StrCat(cpus.size()));
+    AddCustomContext(
+        "parallel_jobs_slowdown",
+        StrFormat("%.1f%%", MeasureParallelSlowdown(cpus) * 100));
+  }
   if (FLAGS_benchmark_color.empty()) {
     PrintUsageAndExit();
   }
   if (FLAGS_benchmark_dry_run) {
     AddCustomContext("dry_run", "true");
   }
+  if (FLAGS_benchmark_thread_pool) {
+    AddCustomContext("thread_pool", "true");
+  }
+  if (FLAGS_benchmark_fast_timing) {
+    const CycleClockTimerCalibration& calibration =
+        GetCycleClockTimerCalibration();
+    AddCustomContext("timer", "cycleclock");
+    AddCustomContext("timer_overhead_ns",
+                     StrFormat("%.2f", calibration.overhead * 1e9));
+    AddCustomContext("timer_residual_overhead_ns",
+                     StrFormat("%.2f", calibration.residual_overhead * 1e9));
+  }
   for (const auto& kv : FLAGS_benchmark_context) {
     AddCustomContext(kv.first, kv.second);
   }
@@ -967,22 +1677,41 @@ void PrintDefaultHelp() {
   fprintf(stdout,
           "benchmark"
           " [--benchmark_list_tests={true|false}]\n"
-          "          [--benchmark_filter=<regex>]\n"
+          "          [--benchmark_filter=<regex>|glob:<patterns>]\n"
           "          [--benchmark_min_time=`<integer>x` OR `<float>s` ]\n"
           "          [--benchmark_min_warmup_time=<min_warmup_time>]\n"
           "          [--benchmark_repetitions=<num_repetitions>]\n"
+          "          [--benchmark_target_rel_ci=<fraction>]\n"
+          "          [--benchmark_target_rel_ci_max_time=<seconds>]\n"
+          "          [--benchmark_baseline=<report.json>]\n"
+          "          [--benchmark_max_regression=<fraction>|<percent>%%]\n"
           "          [--benchmark_dry_run={true|false}]\n"
           "          [--benchmark_enable_random_interleaving={true|false}]\n"
+          "          [--benchmark_thread_pool={true|false}]\n"
+          "          [--benchmark_affinity={none|compact|scatter|"
+          "physical_cores|numa_nodes|<cpu list>}]\n"
+          "          [--benchmark_fast_timing={true|false}]\n"
+          "          [--benchmark_subtract_overhead={true|false}]\n"
+          "          [--benchmark_isolation={none|process}]\n"
+          "          [--benchmark_isolation_timeout=<seconds>]\n"
+          "          [--benchmark_parallel_jobs=<num_jobs>]\n"
+          "          [--benchmark_shard_index=<index>]\n"
+          "          [--benchmark_shard_count=<count>]\n"
+          "          [--benchmark_shard_durations=<report.json>]\n"
           "          [--benchmark_report_aggregates_only={true|false}]\n"
           "          [--benchmark_display_aggregates_only={true|false}]\n"
-          "          [--benchmark_format=<console|json|csv>]\n"
+          "          [--benchmark_format=<console|json|jsonl|csv>]\n"
           "          [--benchmark_out=<filename>]\n"
-          "          [--benchmark_out_format=<json|console|csv>]\n"
+          "          [--benchmark_out_format=<json|jsonl|console|csv>]\n"
           "          [--benchmark_color={auto|true|false}]\n"
           "          [--benchmark_counters_tabular={true|false}]\n"
 #if defined HAVE_LIBPFM
-          "          [--benchmark_perf_counters=<counter>,...]\n"
+          "          [--benchmark_perf_counters=<counter|@preset>,...]\n"
+          "          [--benchmark_perf_counters_rotate={true|false}]\n"
 #endif
+          "          [--benchmark_profile_dir=<directory>]\n"
+          "          [--benchmark_profile_callchain={fp|lbr|none}]\n"
+          "          [--benchmark_memory_iterations=<count>]\n"
           "          [--benchmark_context=<key>=<value>,...]\n"
           "          [--benchmark_time_unit={ns|us|ms|s}]\n"
           "          [--v=<verbosity>]\n");
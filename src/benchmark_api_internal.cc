@@ -1,6 +1,7 @@
 #include "benchmark_api_internal.h"
 
 #include <cinttypes>
+#include <utility>
 
 #include "string_util.h"
 
@@ -12,7 +13,19 @@ BenchmarkInstance::BenchmarkInstance(benchmark::Benchmark* benchmark,
                                      int per_family_instance_idx,
                                      const std::vector<int64_t>& args,
                                      int thread_count)
-    : benchmark_(*benchmark),
+    : BenchmarkInstance(benchmark, family_idx, per_family_instance_idx, args,
+                        thread_count, FamilyName(*benchmark)) {
+  name_.args = ArgsName(*benchmark, args);
+  name_.threads = ThreadsName(*benchmark, thread_count);
+}
+
+BenchmarkInstance::BenchmarkInstance(benchmark::Benchmark* benchmark,
+                                     int family_idx,
+                                     int per_family_instance_idx,
+                                     const std::vector<int64_t>& args,
+                                     int thread_count, BenchmarkName name)
+    : name_(std::move(name)),
+      benchmark_(*benchmark),
       family_index_(family_idx),
       per_family_instance_index_(per_family_instance_idx),
       aggregation_report_mode_(benchmark_.aggregation_report_mode_),
@@ -29,64 +42,82 @@ BenchmarkInstance::BenchmarkInstance(benchmark::Benchmark* benchmark,
       min_warmup_time_(benchmark_.min_warmup_time_),
       iterations_(benchmark_.iterations_),
       threads_(thread_count),
+      affinity_policy_(benchmark_.affinity_policy_),
+      affinity_cpus_(benchmark_.affinity_cpus_),
+      report_per_thread_(benchmark_.report_per_thread_),
+      latency_histogram_(benchmark_.latency_histogram_),
       setup_(benchmark_.setup_),
-      teardown_(benchmark_.teardown_) {
-  name_.function_name = benchmark_.name_;
+      teardown_(benchmark_.teardown_) {}
 
-  size_t arg_i = 0;
-  for (const auto& arg : args) {
-    if (!name_.args.empty()) {
-      name_.args += '/';
-    }
-
-    if (arg_i < benchmark->arg_names_.size()) {
-      const auto& arg_name = benchmark_.arg_names_[arg_i];
-      if (!arg_name.empty()) {
-        name_.args += StrFormat("%s:", arg_name.c_str());
-      }
-    }
+BenchmarkName BenchmarkInstance::FamilyName(
+    const benchmark::Benchmark& benchmark) {
+  BenchmarkName name;
+  name.function_name = benchmark.name_;
 
-    name_.args += StrFormat("%" PRId64, arg);
-    ++arg_i;
+  if (!IsZero(benchmark.min_time_)) {
+    name.min_time = StrFormat("min_time:%0.3f", benchmark.min_time_);
   }
 
-  if (!IsZero(benchmark->min_time_)) {
-    name_.min_time = StrFormat("min_time:%0.3f", benchmark_.min_time_);
+  if (!IsZero(benchmark.min_warmup_time_)) {
+    name.min_warmup_time =
+        StrFormat("min_warmup_time:%0.3f", benchmark.min_warmup_time_);
   }
 
-  if (!IsZero(benchmark->min_warmup_time_)) {
-    name_.min_warmup_time =
-        StrFormat("min_warmup_time:%0.3f", benchmark_.min_warmup_time_);
+  if (benchmark.iterations_ != 0) {
+    name.iterations = StrFormat(
+        "iterations:%lu", static_cast<unsigned long>(benchmark.iterations_));
   }
 
-  if (benchmark_.iterations_ != 0) {
-    name_.iterations = StrFormat(
-        "iterations:%lu", static_cast<unsigned long>(benchmark_.iterations_));
+  if (benchmark.repetitions_ != 0) {
+    name.repetitions = StrFormat("repeats:%d", benchmark.repetitions_);
   }
 
-  if (benchmark_.repetitions_ != 0) {
-    name_.repetitions = StrFormat("repeats:%d", benchmark_.repetitions_);
+  if (benchmark.measure_process_cpu_time_) {
+    name.time_type = "process_time";
   }
 
-  if (benchmark_.measure_process_cpu_time_) {
-    name_.time_type = "process_time";
+  if (benchmark.use_manual_time_) {
+    if (!name.time_type.empty()) {
+      name.time_type += '/';
+    }
+    name.time_type += "manual_time";
+  } else if (benchmark.use_real_time_) {
+    if (!name.time_type.empty()) {
+      name.time_type += '/';
+    }
+    name.time_type += "real_time";
   }
+  return name;
+}
 
-  if (benchmark_.use_manual_time_) {
-    if (!name_.time_type.empty()) {
-      name_.time_type += '/';
+std::string BenchmarkInstance::ArgsName(const benchmark::Benchmark& benchmark,
+                                        const std::vector<int64_t>& args) {
+  std::string name;
+  size_t arg_i = 0;
+  for (const auto& arg : args) {
+    if (!name.empty()) {
+      name += '/';
     }
-    name_.time_type += "manual_time";
-  } else if (benchmark_.use_real_time_) {
-    if (!name_.time_type.empty()) {
-      name_.time_type += '/';
+
+    if (arg_i < benchmark.arg_names_.size()) {
+      const auto& arg_name = benchmark.arg_names_[arg_i];
+      if (!arg_name.empty()) {
+        name += StrFormat("%s:", arg_name.c_str());
+      }
     }
-    name_.time_type += "real_time";
+
+    name += StrFormat("%" PRId64, arg);
+    ++arg_i;
   }
+  return name;
+}
 
-  if (!benchmark_.thread_counts_.empty()) {
-    name_.threads = StrFormat("threads:%d", threads_);
+std::string BenchmarkInstance::ThreadsName(
+    const benchmark::Benchmark& benchmark, int thread_count) {
+  if (benchmark.thread_counts_.empty()) {
+    return std::string();
   }
+  return StrFormat("threads:%d", thread_count);
 }
 
 State BenchmarkInstance::Run(
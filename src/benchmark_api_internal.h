@@ -22,6 +22,20 @@ class BenchmarkInstance {
   BenchmarkInstance(benchmark::Benchmark* benchmark, int family_idx,
                     int per_family_instance_idx,
                     const std::vector<int64_t>& args, int thread_count);
+  // Takes the name built with the functions below.
+  BenchmarkInstance(benchmark::Benchmark* benchmark, int family_idx,
+                    int per_family_instance_idx,
+                    const std::vector<int64_t>& args, int thread_count,
+                    BenchmarkName name);
+
+  // The parts of the name of an instance, which the benchmarks are matched
+  // against before their instances are created: those shared by the family,
+  // and those of the arguments and thread count of the instance.
+  static BenchmarkName FamilyName(const benchmark::Benchmark& benchmark);
+  static std::string ArgsName(const benchmark::Benchmark& benchmark,
+                              const std::vector<int64_t>& args);
+  static std::string ThreadsName(const benchmark::Benchmark& benchmark,
+                                 int thread_count);
 
   const BenchmarkName& name() const { return name_; }
   int family_index() const { return family_index_; }
@@ -41,6 +55,11 @@ class BenchmarkInstance {
   double min_warmup_time() const { return min_warmup_time_; }
   IterationCount iterations() const { return iterations_; }
   int threads() const { return threads_; }
+  AffinityPolicy affinity_policy() const { return affinity_policy_; }
+  const std::vector<int>& affinity_cpus() const { return affinity_cpus_; }
+  bool report_per_thread() const { return report_per_thread_; }
+  bool latency_histogram() const { return latency_histogram_; }
+  const std::string& compare_to() const { return benchmark_.compare_to_; }
   void Setup() const;
   void Teardown() const;
   const auto& GetUserThreadRunnerFactory() const {
@@ -58,7 +77,7 @@ class BenchmarkInstance {
   const int family_index_;
   const int per_family_instance_index_;
   AggregationReportMode aggregation_report_mode_;
-  const std::vector<int64_t>& args_;
+  std::vector<int64_t> args_;
   TimeUnit time_unit_;
   bool measure_process_cpu_time_;
   bool use_real_time_;
@@ -72,6 +91,10 @@ class BenchmarkInstance {
   double min_warmup_time_;
   IterationCount iterations_;
   int threads_;  // Number of concurrent threads to us
+  AffinityPolicy affinity_policy_;
+  const std::vector<int>& affinity_cpus_;
+  bool report_per_thread_;
+  bool latency_histogram_;
 
   callback_function setup_;
   callback_function teardown_;
@@ -0,0 +1,147 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark_filter.h"
+
+#include <cctype>
+#include <cstring>
+
+#include "string_util.h"
+
+namespace benchmark {
+namespace internal {
+
+bool BenchmarkFilter::Init(std::string spec, std::string* error) {
+  if (!spec.empty() && spec[0] == '-') {
+    spec.erase(0, 1);
+    negative_ = true;
+  }
+  if (spec.compare(0, std::strlen(kGlobFilterPrefix), kGlobFilterPrefix) !=
+      0) {
+    regex_spec_ = spec;
+    return regex_.Init(spec, error);
+  }
+  globs_ = StrSplit(spec.substr(std::strlen(kGlobFilterPrefix)), ',');
+  for (const std::string& glob : globs_) {
+    if (glob.empty()) {
+      globs_.clear();
+      break;
+    }
+  }
+  if (globs_.empty()) {
+    if (error != nullptr) {
+      *error = "empty glob pattern in '" + spec + "'";
+    }
+    return false;
+  }
+  return true;
+}
+
+bool BenchmarkFilter::Match(const std::string& name) {
+  bool matched = false;
+  if (globs_.empty()) {
+    matched = regex_.Match(name);
+  } else {
+    for (const std::string& glob : globs_) {
+      if (GlobMatch(glob, name)) {
+        matched = true;
+        break;
+      }
+    }
+  }
+  return matched != negative_;
+}
+
+bool BenchmarkFilter::LiteralPrefixes(
+    std::vector<std::string>* prefixes) const {
+  if (negative_) {
+    return false;
+  }
+  prefixes->clear();
+  if (globs_.empty()) {
+    prefixes->push_back(RegexLiteralPrefix(regex_spec_));
+  } else {
+    for (const std::string& glob : globs_) {
+      prefixes->push_back(glob.substr(0, glob.find_first_of("*?")));
+    }
+  }
+  for (const std::string& prefix : *prefixes) {
+    if (prefix.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool GlobMatch(const std::string& pattern, const std::string& name) {
+  size_t p = 0;
+  size_t n = 0;
+  // Where to resume after the last '*' if the rest does not match: the
+  // pattern after it, and the name one character further than last time.
+  size_t star = std::string::npos;
+  size_t star_n = 0;
+  while (n < name.size()) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+      ++p;
+      ++n;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = ++p;
+      star_n = n;
+    } else if (star != std::string::npos) {
+      p = star;
+      n = ++star_n;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    ++p;
+  }
+  return p == pattern.size();
+}
+
+std::string RegexLiteralPrefix(const std::string& regex) {
+  if (regex.empty() || regex[0] != '^' ||
+      regex.find('|') != std::string::npos) {
+    return std::string();
+  }
+  std::string prefix;
+  size_t i = 1;
+  while (i < regex.size()) {
+    char literal = regex[i];
+    size_t length = 1;
+    if (literal == '\\') {
+      // An escaped punctuation character stands for itself; other escapes
+      // are character classes.
+      if (i + 1 == regex.size() ||
+          std::isalnum(static_cast<unsigned char>(regex[i + 1]))) {
+        break;
+      }
+      literal = regex[i + 1];
+      length = 2;
+    } else if (std::strchr(".[]()*+?{}^$", literal) != nullptr) {
+      break;
+    }
+    i += length;
+    // The character may not be there at all.
+    if (i < regex.size() && std::strchr("*?{", regex[i]) != nullptr) {
+      break;
+    }
+    prefix += literal;
+  }
+  return prefix;
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,55 @@
+#ifndef BENCHMARK_FILTER_H_
+#define BENCHMARK_FILTER_H_
+
+#include <string>
+#include <vector>
+
+#include "benchmark/export.h"
+#include "re.h"
+
+namespace benchmark {
+namespace internal {
+
+// The prefix of --benchmark_filter values made of glob patterns.
+constexpr char kGlobFilterPrefix[] = "glob:";
+
+// A --benchmark_filter. It is either a regular expression that is searched for
+// in the benchmark names, or "glob:" followed by comma-separated glob patterns
+// that each match whole names, with '*' matching any characters and '?' any
+// one character. A leading '-' selects the names that do not match instead.
+class BENCHMARK_EXPORT BenchmarkFilter {
+ public:
+  BenchmarkFilter() = default;
+  BenchmarkFilter(const BenchmarkFilter&) = delete;
+  BenchmarkFilter& operator=(const BenchmarkFilter&) = delete;
+
+  // Parses `spec`. On failure, `error` describes the problem.
+  bool Init(std::string spec, std::string* error);
+
+  bool Match(const std::string& name);
+
+  // Returns whether every name that matches starts with one of `prefixes`,
+  // which it then fills in, so that names starting otherwise can be skipped
+  // without matching them.
+  bool LiteralPrefixes(std::vector<std::string>* prefixes) const;
+
+ private:
+  bool negative_ = false;
+  std::string regex_spec_;
+  Regex regex_;
+  std::vector<std::string> globs_;
+};
+
+// Whether the glob `pattern` matches all of `name`.
+BENCHMARK_EXPORT bool GlobMatch(const std::string& pattern,
+                                const std::string& name);
+
+// The literal text that every string matched by `regex` starts with. It is
+// only found for regular expressions anchored with '^' and without any
+// alternation, and is empty otherwise.
+BENCHMARK_EXPORT std::string RegexLiteralPrefix(const std::string& regex);
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_FILTER_H_
@@ -0,0 +1,234 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A MemoryManager that counts the allocations of the process, registered by
+// linking this library (benchmark::benchmark_memory) into a benchmark. It
+// replaces malloc and friends, which is also how operator new allocates, and
+// needs glibc to forward to the real allocator. Elsewhere it does nothing.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "benchmark/managers.h"
+
+#if defined(__GLIBC__)
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
+#include <string>
+
+// The allocator of glibc, under the names it exports for this purpose.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void* __libc_valloc(size_t size);
+void* __libc_pvalloc(size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace benchmark {
+namespace {
+
+constexpr int kNumBuckets = MemoryManager::kNumAllocationSizeBuckets;
+
+// The counters are updated by every thread that allocates, without locking.
+// Only the peak usage needs more than a relaxed increment.
+std::atomic<bool> tracking{false};
+std::atomic<int64_t> num_allocs{0};
+std::atomic<int64_t> total_allocated_bytes{0};
+// Usable bytes of the blocks allocated minus those freed since Start, and
+// their maximum.
+std::atomic<int64_t> bytes_in_use{0};
+std::atomic<int64_t> max_bytes_in_use{0};
+std::atomic<int64_t> allocation_sizes[kNumBuckets];
+
+int SizeBucket(size_t size) {
+  if (size == 0) return 0;
+  const int bucket = 64 - __builtin_clzll(static_cast<uint64_t>(size));
+  return bucket < kNumBuckets ? bucket : kNumBuckets - 1;
+}
+
+void RecordAllocation(void* ptr, size_t size) {
+  if (ptr == nullptr || !tracking.load(std::memory_order_relaxed)) return;
+  num_allocs.fetch_add(1, std::memory_order_relaxed);
+  total_allocated_bytes.fetch_add(static_cast<int64_t>(size),
+                                  std::memory_order_relaxed);
+  allocation_sizes[SizeBucket(size)].fetch_add(1, std::memory_order_relaxed);
+  const int64_t usable = static_cast<int64_t>(malloc_usable_size(ptr));
+  const int64_t in_use =
+      bytes_in_use.fetch_add(usable, std::memory_order_relaxed) + usable;
+  int64_t max = max_bytes_in_use.load(std::memory_order_relaxed);
+  while (in_use > max && !max_bytes_in_use.compare_exchange_weak(
+                             max, in_use, std::memory_order_relaxed)) {
+  }
+}
+
+void RecordFree(void* ptr) {
+  if (ptr == nullptr || !tracking.load(std::memory_order_relaxed)) return;
+  bytes_in_use.fetch_sub(static_cast<int64_t>(malloc_usable_size(ptr)),
+                         std::memory_order_relaxed);
+}
+
+void* Reallocate(void* old_ptr, size_t size) {
+  // The old block may be gone after the call, so look up its size first.
+  const bool tracked =
+      old_ptr != nullptr && tracking.load(std::memory_order_relaxed);
+  const size_t old_size = tracked ? malloc_usable_size(old_ptr) : 0;
+  void* ptr = __libc_realloc(old_ptr, size);
+  if (tracked && (ptr != nullptr || size == 0)) {
+    bytes_in_use.fetch_sub(static_cast<int64_t>(old_size),
+                           std::memory_order_relaxed);
+  }
+  RecordAllocation(ptr, size);
+  return ptr;
+}
+
+int64_t PageFaults() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return static_cast<int64_t>(usage.ru_minflt) +
+         static_cast<int64_t>(usage.ru_majflt);
+}
+
+// Resets the peak resident set size of the process, see proc(5).
+bool ResetPeakRss() {
+  const int fd = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  const bool reset = write(fd, "5", 1) == 1;
+  close(fd);
+  return reset;
+}
+
+int64_t PeakRss() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return std::stoll(line.substr(6)) * 1024;
+    }
+  }
+  return MemoryManager::TombstoneValue;
+}
+
+class AllocationTracker : public MemoryManager {
+ public:
+  void Start() override {
+    rss_reset_ = ResetPeakRss();
+    start_page_faults_ = PageFaults();
+    num_allocs = 0;
+    total_allocated_bytes = 0;
+    bytes_in_use = 0;
+    max_bytes_in_use = 0;
+    for (std::atomic<int64_t>& count : allocation_sizes) {
+      count = 0;
+    }
+    tracking = true;
+  }
+
+  void Stop(Result& result) override {
+    tracking = false;
+    result.num_allocs = num_allocs;
+    result.max_bytes_used = max_bytes_in_use;
+    result.total_allocated_bytes = total_allocated_bytes;
+    result.net_heap_growth = bytes_in_use;
+    for (int i = 0; i < kNumBuckets; ++i) {
+      result.allocation_sizes[i] = allocation_sizes[i];
+    }
+    result.page_faults = PageFaults() - start_page_faults_;
+    if (rss_reset_) {
+      result.peak_rss_bytes = PeakRss();
+    }
+  }
+
+ private:
+  bool rss_reset_ = false;
+  int64_t start_page_faults_ = 0;
+};
+
+AllocationTracker* const tracker = [] {
+  AllocationTracker* t = new AllocationTracker();
+  RegisterMemoryManager(t);
+  return t;
+}();
+
+}  // namespace
+}  // namespace benchmark
+
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+  void* ptr = __libc_malloc(size);
+  benchmark::RecordAllocation(ptr, size);
+  return ptr;
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+  void* ptr = __libc_calloc(count, size);
+  benchmark::RecordAllocation(ptr, count * size);
+  return ptr;
+}
+
+void* realloc(void* old_ptr, size_t size) noexcept {
+  return benchmark::Reallocate(old_ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+  void* ptr = __libc_memalign(alignment, size);
+  benchmark::RecordAllocation(ptr, size);
+  return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+  return memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) noexcept {
+  if (alignment % sizeof(void*) != 0 ||
+      (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  void* ptr = memalign(alignment, size);
+  if (ptr == nullptr) return ENOMEM;
+  *out = ptr;
+  return 0;
+}
+
+void* valloc(size_t size) noexcept {
+  void* ptr = __libc_valloc(size);
+  benchmark::RecordAllocation(ptr, size);
+  return ptr;
+}
+
+void* pvalloc(size_t size) noexcept {
+  void* ptr = __libc_pvalloc(size);
+  benchmark::RecordAllocation(ptr, size);
+  return ptr;
+}
+
+void free(void* ptr) noexcept {
+  benchmark::RecordFree(ptr);
+  __libc_free(ptr);
+}
+
+}  // extern "C"
+
+#endif  // defined(__GLIBC__)
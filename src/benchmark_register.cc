@@ -32,6 +32,7 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <sstream>
@@ -43,16 +44,17 @@
 #include "benchmark/statistics.h"
 #include "benchmark/types.h"
 #include "benchmark_api_internal.h"
+#include "benchmark_filter.h"
 #include "check.h"
 #include "commandlineflags.h"
 #include "complexity.h"
 #include "internal_macros.h"
 #include "log.h"
 #include "mutex.h"
-#include "re.h"
 #include "statistics.h"
 #include "string_util.h"
 #include "timers.h"
+#include "working_set.h"
 
 namespace benchmark {
 
@@ -86,15 +88,27 @@ class BenchmarkFamilies {
   void ClearBenchmarks();
 
   // Extract the list of benchmark instances that match the specified
-  // regular expression.
+  // filter.
   bool FindBenchmarks(std::string spec,
                       std::vector<BenchmarkInstance>* benchmarks,
                       std::ostream* Err);
 
+  // Called when a family may have been renamed after it was registered.
+  void InvalidateIndex();
+
  private:
   BenchmarkFamilies() {}
 
+  // The positions in `families_` of the families whose names may start with
+  // one of `prefixes`, in registration order.
+  std::vector<size_t> FamiliesWithPrefixes(
+      const std::vector<std::string>& prefixes) REQUIRES(mutex_);
+
   std::vector<std::unique_ptr<benchmark::Benchmark>> families_;
+  // The positions of the families by name, which is maintained as families
+  // are registered, and rebuilt if one of them was renamed.
+  std::multimap<std::string, size_t> name_index_ GUARDED_BY(mutex_);
+  bool index_stale_ GUARDED_BY(mutex_) = false;
   Mutex mutex_;
 };
 
@@ -107,6 +121,7 @@ size_t BenchmarkFamilies::AddBenchmark(
     std::unique_ptr<benchmark::Benchmark> family) {
   MutexLock l(mutex_);
   size_t index = families_.size();
+  name_index_.emplace(family->name_, index);
   families_.push_back(std::move(family));
   return index;
 }
@@ -115,6 +130,47 @@ void BenchmarkFamilies::ClearBenchmarks() {
   MutexLock l(mutex_);
   families_.clear();
   families_.shrink_to_fit();
+  name_index_.clear();
+  index_stale_ = false;
+}
+
+void BenchmarkFamilies::InvalidateIndex() {
+  MutexLock l(mutex_);
+  index_stale_ = true;
+}
+
+std::vector<size_t> BenchmarkFamilies::FamiliesWithPrefixes(
+    const std::vector<std::string>& prefixes) {
+  if (index_stale_) {
+    name_index_.clear();
+    for (size_t i = 0; i < families_.size(); ++i) {
+      if (families_[i]) {
+        name_index_.emplace(families_[i]->name_, i);
+      }
+    }
+    index_stale_ = false;
+  }
+  std::vector<size_t> positions;
+  for (const std::string& prefix : prefixes) {
+    // Families named with the prefix.
+    for (auto it = name_index_.lower_bound(prefix);
+         it != name_index_.end() &&
+         it->first.compare(0, prefix.size(), prefix) == 0;
+         ++it) {
+      positions.push_back(it->second);
+    }
+    // Families whose instance names may add the rest of it.
+    for (size_t length = 1; length < prefix.size(); ++length) {
+      const auto range = name_index_.equal_range(prefix.substr(0, length));
+      for (auto it = range.first; it != range.second; ++it) {
+        positions.push_back(it->second);
+      }
+    }
+  }
+  std::sort(positions.begin(), positions.end());
+  positions.erase(std::unique(positions.begin(), positions.end()),
+                  positions.end());
+  return positions;
 }
 
 bool BenchmarkFamilies::FindBenchmarks(
@@ -122,16 +178,11 @@ bool BenchmarkFamilies::FindBenchmarks(
     std::ostream* ErrStream) {
   BM_CHECK(ErrStream);
   auto& Err = *ErrStream;
-  // Make regular expression out of command-line flag
+  // Make a filter out of command-line flag
   std::string error_msg;
-  Regex re;
-  bool is_negative_filter = false;
-  if (spec[0] == '-') {
-    spec.replace(0, 1, "");
-    is_negative_filter = true;
-  }
-  if (!re.Init(spec, &error_msg)) {
-    Err << "Could not compile benchmark re: " << error_msg << '\n';
+  BenchmarkFilter filter;
+  if (!filter.Init(spec, &error_msg)) {
+    Err << "Could not compile benchmark filter: " << error_msg << '\n';
     return false;
   }
 
@@ -141,7 +192,18 @@ bool BenchmarkFamilies::FindBenchmarks(
   int next_family_index = 0;
 
   MutexLock l(mutex_);
-  for (std::unique_ptr<benchmark::Benchmark>& family : families_) {
+  // When the filter only matches names that start with known text, the
+  // families whose names cannot are skipped without matching any name.
+  std::vector<std::string> prefixes;
+  std::vector<size_t> positions;
+  if (filter.LiteralPrefixes(&prefixes)) {
+    positions = FamiliesWithPrefixes(prefixes);
+  } else {
+    positions.resize(families_.size());
+    std::iota(positions.begin(), positions.end(), size_t{0});
+  }
+  for (size_t position : positions) {
+    std::unique_ptr<benchmark::Benchmark>& family = families_[position];
     int family_index = next_family_index;
     int per_family_instance_index = 0;
 
@@ -153,11 +215,18 @@ bool BenchmarkFamilies::FindBenchmarks(
     if (family->ArgsCnt() == -1) {
       family->Args({});
     }
+    if (family->name_.rfind(kDisabledPrefix, 0) == 0) {
+      continue;
+    }
     const std::vector<int>* thread_counts =
         (family->thread_counts_.empty()
              ? &one_thread
              : &static_cast<const std::vector<int>&>(family->thread_counts_));
-    const size_t family_size = family->args_.size() * thread_counts->size();
+    size_t family_size = 0;
+    for (const auto& arglists : family->args_) {
+      family_size += ArgsProductSize(arglists);
+    }
+    family_size *= thread_counts->size();
     // The benchmark will be run at least 'family_size' different inputs.
     // If 'family_size' is very large warn the user.
     if (family_size > kMaxFamilySize) {
@@ -165,23 +234,25 @@ bool BenchmarkFamilies::FindBenchmarks(
           << " will be repeated at least " << family_size << " times.\n";
     }
     // reserve in the special case the regex ".", since we know the final
-    // family size.  this doesn't take into account any disabled benchmarks
-    // so worst case we reserve more than we need.
+    // family size.
     if (spec == ".") {
       benchmarks->reserve(benchmarks->size() + family_size);
     }
 
-    for (auto const& args : family->args_) {
-      for (int num_threads : *thread_counts) {
-        BenchmarkInstance instance(family.get(), family_index,
-                                   per_family_instance_index, args,
-                                   num_threads);
-
-        const auto full_name = instance.name().str();
-        if (full_name.rfind(kDisabledPrefix, 0) != 0 &&
-            ((re.Match(full_name) && !is_negative_filter) ||
-             (!re.Match(full_name) && is_negative_filter))) {
-          benchmarks->push_back(std::move(instance));
+    // The argument products are walked one argument list at a time, and only
+    // the instances whose name matches are created.
+    BenchmarkName name = BenchmarkInstance::FamilyName(*family);
+    for (const auto& arglists : family->args_) {
+      for (ArgsProductIterator it(arglists); !it.done(); it.Next()) {
+        name.args = BenchmarkInstance::ArgsName(*family, it.args());
+        for (int num_threads : *thread_counts) {
+          name.threads = BenchmarkInstance::ThreadsName(*family, num_threads);
+          if (!filter.Match(name.str())) {
+            continue;
+          }
+          benchmarks->emplace_back(family.get(), family_index,
+                                   per_family_instance_index, it.args(),
+                                   num_threads, name);
 
           ++per_family_instance_index;
 
@@ -233,7 +304,10 @@ Benchmark::Benchmark(const std::string& name)
       use_real_time_(false),
       use_manual_time_(false),
       complexity_(oNone),
-      complexity_lambda_(nullptr) {
+      complexity_lambda_(nullptr),
+      affinity_policy_(kAffinityUnspecified),
+      report_per_thread_(false),
+      latency_histogram_(false) {
   ComputeStatistics("mean", StatisticsMean);
   ComputeStatistics("median", StatisticsMedian);
   ComputeStatistics("stddev", StatisticsStdDev);
@@ -244,12 +318,13 @@ Benchmark::~Benchmark() {}
 
 Benchmark* Benchmark::Name(const std::string& name) {
   SetName(name);
+  internal::BenchmarkFamilies::GetInstance()->InvalidateIndex();
   return this;
 }
 
 Benchmark* Benchmark::Arg(int64_t x) {
   BM_CHECK(ArgsCnt() == -1 || ArgsCnt() == 1);
-  args_.push_back({x});
+  AddArgsProduct({{x}});
   return this;
 }
 
@@ -263,10 +338,7 @@ Benchmark* Benchmark::Range(int64_t start, int64_t limit) {
   BM_CHECK(ArgsCnt() == -1 || ArgsCnt() == 1);
   std::vector<int64_t> arglist;
   internal::AddRange(&arglist, start, limit, range_multiplier_);
-
-  for (int64_t i : arglist) {
-    args_.push_back({i});
-  }
+  AddArgsProduct({std::move(arglist)});
   return this;
 }
 
@@ -287,28 +359,7 @@ Benchmark* Benchmark::Ranges(
 Benchmark* Benchmark::ArgsProduct(
     const std::vector<std::vector<int64_t>>& arglists) {
   BM_CHECK(ArgsCnt() == -1 || ArgsCnt() == static_cast<int>(arglists.size()));
-
-  std::vector<std::size_t> indices(arglists.size());
-  const std::size_t total = std::accumulate(
-      std::begin(arglists), std::end(arglists), std::size_t{1},
-      [](const std::size_t res, const std::vector<int64_t>& arglist) {
-        return res * arglist.size();
-      });
-  std::vector<int64_t> args;
-  args.reserve(arglists.size());
-  for (std::size_t i = 0; i < total; i++) {
-    for (std::size_t arg = 0; arg < arglists.size(); arg++) {
-      args.push_back(arglists[arg][indices[arg]]);
-    }
-    args_.push_back(args);
-    args.clear();
-
-    std::size_t arg = 0;
-    do {
-      indices[arg] = (indices[arg] + 1) % arglists[arg].size();
-    } while (indices[arg++] == 0 && arg < arglists.size());
-  }
-
+  AddArgsProduct(arglists);
   return this;
 }
 
@@ -327,18 +378,42 @@ Benchmark* Benchmark::ArgNames(const std::vector<std::string>& names) {
 Benchmark* Benchmark::DenseRange(int64_t start, int64_t limit, int step) {
   BM_CHECK(ArgsCnt() == -1 || ArgsCnt() == 1);
   BM_CHECK_LE(start, limit);
+  std::vector<int64_t> arglist;
   for (int64_t arg = start; arg <= limit; arg += step) {
-    args_.push_back({arg});
+    arglist.push_back(arg);
   }
+  AddArgsProduct({std::move(arglist)});
+  return this;
+}
+
+Benchmark* Benchmark::WorkingSetRange(int64_t bytes_per_arg) {
+  BM_CHECK(ArgsCnt() == -1 || ArgsCnt() == 1);
+  AddArgsProduct({CreateWorkingSetRange(bytes_per_arg)});
   return this;
 }
 
 Benchmark* Benchmark::Args(const std::vector<int64_t>& args) {
   BM_CHECK(ArgsCnt() == -1 || ArgsCnt() == static_cast<int>(args.size()));
-  args_.push_back(args);
+  std::vector<std::vector<int64_t>> arglists;
+  arglists.reserve(args.size());
+  for (int64_t arg : args) {
+    arglists.push_back({arg});
+  }
+  AddArgsProduct(std::move(arglists));
   return this;
 }
 
+void Benchmark::AddArgsProduct(std::vector<std::vector<int64_t>> arglists) {
+  // Consecutive lists of single arguments are kept as one list, so that
+  // Arg() and DenseRange() cost a value per argument.
+  if (arglists.size() == 1 && !args_.empty() && args_.back().size() == 1) {
+    std::vector<int64_t>& last = args_.back().front();
+    last.insert(last.end(), arglists.front().begin(), arglists.front().end());
+    return;
+  }
+  args_.push_back(std::move(arglists));
+}
+
 Benchmark* Benchmark::Apply(
     const std::function<void(Benchmark* benchmark)>& custom_arguments) {
   custom_arguments(this);
@@ -501,6 +576,39 @@ Benchmark* Benchmark::ThreadRunner(threadrunner_factory&& factory) {
   return this;
 }
 
+Benchmark* Benchmark::Affinity(AffinityPolicy policy) {
+  BM_CHECK(policy != kAffinityCpuList)
+      << "Use Affinity(const std::vector<int>&) to pin to a CPU list.";
+  affinity_policy_ = policy;
+  affinity_cpus_.clear();
+  return this;
+}
+
+Benchmark* Benchmark::Affinity(const std::vector<int>& cpus) {
+  BM_CHECK(!cpus.empty());
+  BM_CHECK(std::all_of(cpus.begin(), cpus.end(),
+                       [](int cpu) { return cpu >= 0; }));
+  affinity_policy_ = kAffinityCpuList;
+  affinity_cpus_ = cpus;
+  return this;
+}
+
+Benchmark* Benchmark::ReportPerThread(bool value) {
+  report_per_thread_ = value;
+  return this;
+}
+
+Benchmark* Benchmark::LatencyHistogram(bool value) {
+  latency_histogram_ = value;
+  return this;
+}
+
+Benchmark* Benchmark::CompareTo(const std::string& baseline) {
+  BM_CHECK(!baseline.empty());
+  compare_to_ = baseline;
+  return this;
+}
+
 void Benchmark::SetName(const std::string& name) { name_ = name; }
 
 const char* Benchmark::GetName() const { return name_.c_str(); }
@@ -555,4 +663,16 @@ std::vector<int64_t> CreateDenseRange(int64_t start, int64_t limit, int step) {
   return args;
 }
 
+std::vector<int64_t> CreateWorkingSetRange(int64_t bytes_per_arg) {
+  BM_CHECK_GT(bytes_per_arg, 0);
+  std::vector<int64_t> args;
+  for (int64_t bytes : internal::WorkingSetSizes(CPUInfo::Get().caches)) {
+    const int64_t arg = std::max<int64_t>(1, bytes / bytes_per_arg);
+    if (args.empty() || args.back() != arg) {
+      args.push_back(arg);
+    }
+  }
+  return args;
+}
+
 }  // end namespace benchmark
@@ -2,6 +2,7 @@
 #define BENCHMARK_REGISTER_H
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -104,6 +105,57 @@ void AddRange(std::vector<T>* dst, T lo, T hi, int mult) {
   }
 }
 
+// Walks the argument lists of the cartesian product of `arglists`, with the
+// first argument changing fastest, without storing the product.
+class ArgsProductIterator {
+ public:
+  explicit ArgsProductIterator(
+      const std::vector<std::vector<int64_t>>& arglists)
+      : arglists_(arglists),
+        indices_(arglists.size()),
+        args_(arglists.size()),
+        done_(false) {
+    for (size_t arg = 0; arg < arglists_.size(); ++arg) {
+      if (arglists_[arg].empty()) {
+        done_ = true;
+        return;
+      }
+      args_[arg] = arglists_[arg].front();
+    }
+  }
+
+  bool done() const { return done_; }
+  const std::vector<int64_t>& args() const { return args_; }
+
+  void Next() {
+    for (size_t arg = 0; arg < arglists_.size(); ++arg) {
+      if (++indices_[arg] < arglists_[arg].size()) {
+        args_[arg] = arglists_[arg][indices_[arg]];
+        return;
+      }
+      indices_[arg] = 0;
+      args_[arg] = arglists_[arg].front();
+    }
+    done_ = true;
+  }
+
+ private:
+  const std::vector<std::vector<int64_t>>& arglists_;
+  std::vector<size_t> indices_;
+  std::vector<int64_t> args_;
+  bool done_;
+};
+
+// The number of argument lists in the cartesian product of `arglists`.
+inline size_t ArgsProductSize(
+    const std::vector<std::vector<int64_t>>& arglists) {
+  size_t size = 1;
+  for (const std::vector<int64_t>& arglist : arglists) {
+    size *= arglist.size();
+  }
+  return size;
+}
+
 }  // namespace internal
 }  // namespace benchmark
 
@@ -18,7 +18,9 @@
 #include "benchmark/managers.h"
 #include "benchmark/reporter.h"
 #include "benchmark/state.h"
+#include "benchmark/sysinfo.h"
 #include "benchmark/types.h"
+#include "affinity.h"
 #include "benchmark_api_internal.h"
 #include "internal_macros.h"
 
@@ -52,6 +54,7 @@
 #include "commandlineflags.h"
 #include "complexity.h"
 #include "counter.h"
+#include "cycleclock.h"
 #include "log.h"
 #include "mutex.h"
 #include "perf_counters.h"
@@ -59,7 +62,11 @@
 #include "statistics.h"
 #include "string_util.h"
 #include "thread_manager.h"
+#include "thread_pool.h"
 #include "thread_timer.h"
+#include "timer_overhead.h"
+#include "timers.h"
+#include "working_set.h"
 
 namespace benchmark {
 
@@ -70,6 +77,15 @@ BM_DECLARE_int32(benchmark_repetitions);
 BM_DECLARE_bool(benchmark_report_aggregates_only);
 BM_DECLARE_bool(benchmark_display_aggregates_only);
 BM_DECLARE_string(benchmark_perf_counters);
+BM_DECLARE_bool(benchmark_perf_counters_rotate);
+BM_DECLARE_bool(benchmark_thread_pool);
+BM_DECLARE_bool(benchmark_fast_timing);
+BM_DECLARE_bool(benchmark_subtract_overhead);
+BM_DECLARE_double(benchmark_target_rel_ci);
+BM_DECLARE_double(benchmark_target_rel_ci_max_time);
+BM_DECLARE_string(benchmark_affinity);
+BM_DECLARE_string(benchmark_profile_dir);
+BM_DECLARE_int32(benchmark_memory_iterations);
 
 namespace internal {
 
@@ -83,12 +99,39 @@ constexpr IterationCount kMaxIterations = 1000000000000;
 const double kDefaultMinTime =
     std::strtod(::benchmark::kDefaultMinTimeStr, /*p_end*/ nullptr);
 
+// With --benchmark_target_rel_ci, the confidence interval is computed over at
+// least this many repetitions, and each one runs for kDefaultRelCIMinTime
+// unless a minimum time is given explicitly.
+constexpr int kMinRelCIRepetitions = 3;
+constexpr double kDefaultRelCIMinTime = 0.05;
+
+// Flags the perf counters that were multiplexed, and so only estimated, with
+// the fraction of the run they were actually counting.
+void AddRunningFractions(const PerfCountersMeasurement& perf_counters,
+                         UserCounters* counters) {
+  const std::vector<std::string>& names = perf_counters.names();
+  for (size_t c = 0; c < names.size(); ++c) {
+    const double fraction = perf_counters.running_fraction(c);
+    if (!perf_counters.IsMeasured(c) || fraction >= 1.0) {
+      continue;
+    }
+    // A name counted more than once, e.g. on several PMUs or by several
+    // threads, reports its least covered instance.
+    const std::string name = names[c] + ".running";
+    auto it = counters->find(name);
+    if (it == counters->end() || fraction < it->second.value) {
+      (*counters)[name] = Counter(fraction);
+    }
+  }
+}
+
 BenchmarkReporter::Run CreateRunReport(
     const benchmark::internal::BenchmarkInstance& b,
     const internal::ThreadManager::Result& results,
     IterationCount memory_iterations,
     const MemoryManager::Result& memory_result, double seconds,
-    int64_t repetition_index, int64_t repeats) {
+    int64_t repetition_index, int64_t repeats,
+    const std::vector<int>& thread_cpus) {
   // Create report about this benchmark run.
   BenchmarkReporter::Run report;
 
@@ -102,6 +145,7 @@ BenchmarkReporter::Run CreateRunReport(
   report.iterations = results.iterations;
   report.time_unit = b.time_unit();
   report.threads = b.threads();
+  report.thread_cpus = thread_cpus;
   report.repetition_index = repetition_index;
   report.repetitions = repeats;
 
@@ -135,20 +179,70 @@ BenchmarkReporter::Run CreateRunReport(
     const double thread_seconds = seconds / b.threads();
     internal::Finish(&report.counters, results.iterations, thread_seconds,
                      b.threads());
+
+    if (results.working_set_bytes > 0) {
+      report.working_set_bytes = results.working_set_bytes;
+      // The working sets of the threads were added up.
+      report.cache_level =
+          CacheLevelOf(results.working_set_bytes / b.threads(), b.threads(),
+                       CPUInfo::Get().caches);
+      const auto bytes = report.counters.find("bytes_per_second");
+      if (bytes != report.counters.end() && !FLAGS_benchmark_dry_run) {
+        const double bytes_per_second = bytes->second.value;
+        report.peak_memory_bandwidth = GetPeakMemoryBandwidth();
+        if (report.peak_memory_bandwidth > 0) {
+          report.counters["bandwidth_utilization"] =
+              Counter(bytes_per_second / report.peak_memory_bandwidth);
+        }
+      }
+    }
+
+    if (b.report_per_thread()) {
+      double first_start = std::numeric_limits<double>::max();
+      for (const internal::ThreadManager::ThreadResult& t :
+           results.per_thread) {
+        first_start = std::min(first_start, t.start_time);
+      }
+      report.per_thread.reserve(results.per_thread.size());
+      for (const internal::ThreadManager::ThreadResult& t :
+           results.per_thread) {
+        BenchmarkReporter::Run::ThreadResult thread_report;
+        thread_report.iterations = t.iterations;
+        thread_report.real_accumulated_time =
+            b.use_manual_time() ? t.manual_time_used : t.real_time_used;
+        thread_report.cpu_accumulated_time = t.cpu_time_used;
+        thread_report.barrier_wait_time = t.barrier_wait_time;
+        thread_report.start_delay = t.start_time - first_start;
+        thread_report.counters = t.counters;
+        // Use the same time base as the whole run for the thread's rates.
+        double own_seconds = t.cpu_time_used;
+        if (b.use_manual_time()) {
+          own_seconds = t.manual_time_used;
+        } else if (b.use_real_time()) {
+          own_seconds = t.real_time_used;
+        }
+        internal::Finish(&thread_report.counters, t.iterations, own_seconds,
+                         1);
+        report.per_thread.push_back(std::move(thread_report));
+      }
+    }
   }
   return report;
 }
 
 // Execute one thread of benchmark b for the specified number of iterations.
-// Adds the stats collected for the thread into manager->results.
+// Stores the stats collected for the thread in its slot of the manager.
 void RunInThread(const BenchmarkInstance* b, IterationCount iters,
                  int thread_id, ThreadManager* manager,
                  PerfCountersMeasurement* perf_counters_measurement,
                  ProfilerManager* profiler_manager_) {
   internal::ThreadTimer timer(
-      b->measure_process_cpu_time()
-          ? internal::ThreadTimer::CreateProcessCpuTime()
-          : internal::ThreadTimer::Create());
+      FLAGS_benchmark_fast_timing
+          ? internal::ThreadTimer::CreateCycleClock(
+                b->measure_process_cpu_time())
+          : (b->measure_process_cpu_time()
+                 ? internal::ThreadTimer::CreateProcessCpuTime()
+                 : internal::ThreadTimer::Create()));
 
   State st = b->Run(iters, thread_id, &timer, manager,
                     perf_counters_measurement, profiler_manager_);
@@ -157,16 +251,16 @@ void RunInThread(const BenchmarkInstance* b, IterationCount iters,
         "The benchmark didn't run, nor was it explicitly skipped. Please call "
         "'SkipWithXXX` in your benchmark as appropriate.");
   }
-  {
-    MutexLock l(manager->GetBenchmarkMutex());
-    internal::ThreadManager::Result& results = manager->results;
-    results.iterations += st.iterations();
-    results.cpu_time_used += timer.cpu_time_used();
-    results.real_time_used += timer.real_time_used();
-    results.manual_time_used += timer.manual_time_used();
-    results.complexity_n += st.complexity_length_n();
-    internal::Increment(&results.counters, st.counters);
-  }
+  internal::ThreadManager::ThreadResult& result =
+      manager->GetThreadResult(thread_id);
+  result.iterations = st.iterations();
+  result.cpu_time_used = timer.cpu_time_used();
+  result.real_time_used = timer.real_time_used();
+  result.manual_time_used = timer.manual_time_used();
+  result.complexity_n = st.complexity_length_n();
+  result.working_set_bytes = st.working_set_bytes();
+  result.timer_slices = timer.slices();
+  result.counters = std::move(st.counters);
   manager->NotifyThreadComplete();
 }
 
@@ -180,6 +274,12 @@ double ComputeMinTime(const benchmark::internal::BenchmarkInstance& b,
   if (iters_or_time.tag == BenchTimeType::ITERS) {
     return kDefaultMinTime;
   }
+  // The flag is empty unless given, so that a value given explicitly is used
+  // even if it is the default. Adaptive repetitions make up for shorter ones.
+  if (FLAGS_benchmark_min_time.empty()) {
+    return FLAGS_benchmark_target_rel_ci > 0 ? kDefaultRelCIMinTime
+                                             : kDefaultMinTime;
+  }
 
   return iters_or_time.time;
 }
@@ -221,12 +321,46 @@ class ThreadRunnerDefault : public ThreadRunnerBase {
   std::vector<std::thread> pool;
 };
 
+// Hands the non-main threads to the process-wide ThreadPool instead of
+// spawning and joining fresh threads for every DoNIterations() call.
+class ThreadRunnerPooled : public ThreadRunnerBase {
+ public:
+  explicit ThreadRunnerPooled(int num_threads) : num_threads_(num_threads) {}
+
+  void RunThreads(const std::function<void(int)>& fn) override final {
+    ThreadPool::Get().Run(num_threads_, fn);
+  }
+
+ private:
+  const int num_threads_;
+};
+
 std::unique_ptr<ThreadRunnerBase> GetThreadRunner(
     const benchmark::threadrunner_factory& userThreadRunnerFactory,
     int num_threads) {
-  return userThreadRunnerFactory
-             ? userThreadRunnerFactory(num_threads)
-             : std::make_unique<ThreadRunnerDefault>(num_threads);
+  if (userThreadRunnerFactory) {
+    return userThreadRunnerFactory(num_threads);
+  }
+  if (FLAGS_benchmark_thread_pool) {
+    return std::make_unique<ThreadRunnerPooled>(num_threads);
+  }
+  return std::make_unique<ThreadRunnerDefault>(num_threads);
+}
+
+std::vector<int> ComputeThreadCpus(
+    const benchmark::internal::BenchmarkInstance& b) {
+  AffinityPolicy policy = b.affinity_policy();
+  std::vector<int> cpus = b.affinity_cpus();
+  if (policy == kAffinityUnspecified) {
+    const bool parsed = ParseAffinity(FLAGS_benchmark_affinity, &policy, &cpus);
+    BM_CHECK(parsed) << "Malformed value passed to --benchmark_affinity: `"
+                     << FLAGS_benchmark_affinity << "`.";
+    (void)parsed;
+  }
+  if (policy == kAffinityUnspecified || policy == kAffinityNone) {
+    return {};
+  }
+  return PlanThreadAffinity(policy, cpus, GetCpuTopology(), b.threads());
 }
 
 }  // end namespace
@@ -305,8 +439,11 @@ BenchmarkRunner::BenchmarkRunner(
       has_explicit_iteration_count(b.iterations() != 0 ||
                                    parsed_benchtime_flag.tag ==
                                        BenchTimeType::ITERS),
+      target_rel_ci(FLAGS_benchmark_dry_run ? 0
+                                            : FLAGS_benchmark_target_rel_ci),
       thread_runner(
           GetThreadRunner(b.GetUserThreadRunnerFactory(), b.threads())),
+      thread_cpus(ComputeThreadCpus(b_)),
       iters(FLAGS_benchmark_dry_run
                 ? 1
                 : (has_explicit_iteration_count
@@ -329,6 +466,9 @@ BenchmarkRunner::BenchmarkRunner(
              (perf_counters_measurement_ptr->num_counters() == 0))
         << "Perf counters were requested but could not be set up.";
   }
+  if (target_rel_ci > 0) {
+    repeats = std::max(repeats, kMinRelCIRepetitions);
+  }
 }
 
 BenchmarkRunner::IterationResults BenchmarkRunner::DoNIterations() {
@@ -337,16 +477,64 @@ BenchmarkRunner::IterationResults BenchmarkRunner::DoNIterations() {
   std::unique_ptr<internal::ThreadManager> manager;
   manager.reset(new internal::ThreadManager(b.threads()));
 
+  // A thread's perf counters only count that thread, so every thread of a
+  // threaded benchmark counts with its own, opened on the thread itself. The
+  // shared counters, and the copies the threads inherit, are stopped in the
+  // meantime so that they do not compete with them for the PMU.
+  const bool per_thread_perf_counters =
+      perf_counters_measurement_ptr != nullptr &&
+      perf_counters_measurement_ptr->num_counters() > 0 && b.threads() > 1;
+  std::vector<std::unique_ptr<PerfCountersMeasurement>> thread_perf_counters(
+      per_thread_perf_counters ? static_cast<size_t>(b.threads()) : 0);
+  if (per_thread_perf_counters) {
+    perf_counters_measurement_ptr->SuspendCounting();
+  }
+  if (perf_counters_measurement_ptr != nullptr && !per_thread_perf_counters) {
+    if (FLAGS_benchmark_perf_counters_rotate) {
+      perf_counters_measurement_ptr->RotateGroups(
+          static_cast<size_t>(num_repetitions_done));
+    }
+    perf_counters_measurement_ptr->ResetRunningFraction();
+  }
+
   thread_runner->RunThreads([&](int thread_idx) {
-    RunInThread(&b, iters, thread_idx, manager.get(),
-                perf_counters_measurement_ptr, /*profiler_manager=*/nullptr);
+    ScopedThreadAffinity affinity(
+        thread_cpus.empty() ? -1
+                            : thread_cpus[static_cast<size_t>(thread_idx)]);
+    PerfCountersMeasurement* perf_counters = perf_counters_measurement_ptr;
+    if (per_thread_perf_counters) {
+      std::unique_ptr<PerfCountersMeasurement>& own =
+          thread_perf_counters[static_cast<size_t>(thread_idx)];
+      own.reset(
+          new PerfCountersMeasurement(perf_counters_measurement_ptr->names()));
+      if (FLAGS_benchmark_perf_counters_rotate) {
+        own->RotateGroups(static_cast<size_t>(num_repetitions_done));
+      }
+      perf_counters = own.get();
+    }
+    RunInThread(&b, iters, thread_idx, manager.get(), perf_counters,
+                /*profiler_manager=*/nullptr);
   });
 
   IterationResults i;
-  // Acquire the measurements/counters from the manager, UNDER THE LOCK!
-  {
-    MutexLock l(manager->GetBenchmarkMutex());
-    i.results = manager->results;
+  // All threads have been joined, so their slots can be reduced.
+  i.results = manager->TakeResults();
+
+  if (per_thread_perf_counters) {
+    perf_counters_measurement_ptr->ResumeCounting();
+    for (size_t t = 0; t < thread_perf_counters.size(); ++t) {
+      UserCounters& thread_counters = i.results.per_thread[t].counters;
+      AddRunningFractions(*thread_perf_counters[t], &thread_counters);
+      AddRunningFractions(*thread_perf_counters[t], &i.results.counters);
+      perf_counters_measurement_ptr->AddDerivedMetrics(&thread_counters);
+    }
+  } else if (perf_counters_measurement_ptr != nullptr) {
+    AddRunningFractions(*perf_counters_measurement_ptr, &i.results.counters);
+  }
+  // The metrics of counter presets are ratios of the summed counters, which
+  // makes them independent of the per-iteration normalization.
+  if (perf_counters_measurement_ptr != nullptr) {
+    perf_counters_measurement_ptr->AddDerivedMetrics(&i.results.counters);
   }
 
   // And get rid of the manager.
@@ -486,12 +674,90 @@ void BenchmarkRunner::RunProfilerManager(IterationCount profile_iterations) {
               /*profiler_manager=*/profiler_manager);
   manager.reset();
   b.Teardown();
+  if (sampling_profiler != nullptr && profiler_manager == sampling_profiler) {
+    sampling_profiler->TakeSamples(&profile_samples);
+  }
+}
+
+void BenchmarkRunner::RunLatencySampler(IterationCount sample_iterations) {
+  std::unique_ptr<internal::ThreadManager> manager;
+  manager.reset(new internal::ThreadManager(b.threads()));
+  manager->EnableLatencySampling();
+  b.Setup();
+  const double start_seconds = ChronoClockNow();
+  const int64_t start_ticks = cycleclock::Now();
+  thread_runner->RunThreads([&](int thread_idx) {
+    ScopedThreadAffinity affinity(
+        thread_cpus.empty() ? -1
+                            : thread_cpus[static_cast<size_t>(thread_idx)]);
+    RunInThread(&b, sample_iterations, thread_idx, manager.get(),
+                /*perf_counters_measurement_ptr=*/nullptr,
+                /*profiler_manager=*/nullptr);
+  });
+  latency_ticks += cycleclock::Now() - start_ticks;
+  latency_seconds += ChronoClockNow() - start_seconds;
+  for (int t = 0; t < b.threads(); ++t) {
+    latency_histogram.Merge(manager->GetLatencySampler(t)->histogram());
+  }
+  manager.reset();
+  b.Teardown();
+}
+
+std::vector<BenchmarkReporter::Run> BenchmarkRunner::ComputeLatencyAggregates()
+    const {
+  std::vector<BenchmarkReporter::Run> aggregates;
+  const auto successful_run = std::find_if(
+      run_results.non_aggregates.begin(), run_results.non_aggregates.end(),
+      [](const BenchmarkReporter::Run& run) {
+        return run.skipped == internal::NotSkipped;
+      });
+  if (successful_run == run_results.non_aggregates.end() ||
+      latency_histogram.count() == 0) {
+    return aggregates;
+  }
+
+  // Convert ticks using the rate the cycle clock ran at during the sampling
+  // passes, which is more reliable than the nominal CPU frequency.
+  double seconds_per_tick = 1.0 / CPUInfo::Get().cycles_per_second;
+  if (latency_ticks > 0 && latency_seconds > 0) {
+    seconds_per_tick = latency_seconds / static_cast<double>(latency_ticks);
+  }
+
+  static const std::pair<const char*, double> kQuantiles[] = {
+      {"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p99.9", 0.999}};
+  const auto add = [&](const char* name, int64_t ticks) {
+    BenchmarkReporter::Run data;
+    data.run_name = successful_run->run_name;
+    data.family_index = successful_run->family_index;
+    data.per_family_instance_index = successful_run->per_family_instance_index;
+    data.run_type = BenchmarkReporter::Run::RT_Aggregate;
+    data.threads = successful_run->threads;
+    data.repetitions = successful_run->repetitions;
+    data.repetition_index = BenchmarkReporter::Run::no_repetition_index;
+    data.aggregate_name = name;
+    data.aggregate_unit = StatisticUnit::kTime;
+    data.report_label = successful_run->report_label;
+    data.time_unit = successful_run->time_unit;
+    // The aggregate is computed over the samples. Reporters divide the
+    // accumulated times by the iteration count, so scale them up by it.
+    data.iterations = latency_histogram.count();
+    const double seconds = static_cast<double>(ticks) * seconds_per_tick;
+    data.real_accumulated_time = seconds * static_cast<double>(data.iterations);
+    data.cpu_accumulated_time = data.real_accumulated_time;
+    aggregates.push_back(data);
+  };
+  for (const auto& q : kQuantiles) {
+    add(q.first, latency_histogram.ValueAtQuantile(q.second));
+  }
+  add("max", latency_histogram.max());
+  return aggregates;
 }
 
 void BenchmarkRunner::DoOneRepetition() {
   assert(HasRepeatsRemaining() && "Already done all repetitions?");
 
   const bool is_the_first_repetition = num_repetitions_done == 0;
+  const double repetition_start = ChronoClockNow();
 
   // In case a warmup phase is requested by the benchmark, run it now.
   // After running the warmup phase the BenchmarkRunner should be in a state as
@@ -536,13 +802,28 @@ void BenchmarkRunner::DoOneRepetition() {
            "then we should have accepted the current iteration run.");
   }
 
+  // Remove the calibrated cost of the benchmark loop and of the timer itself.
+  // Manual timing does not include either.
+  const bool subtract_overhead = FLAGS_benchmark_subtract_overhead &&
+                                 !b.use_manual_time() &&
+                                 i.results.skipped_ == internal::NotSkipped;
+  if (subtract_overhead) {
+    SubtractTimerOverhead(GetTimerOverhead(FLAGS_benchmark_fast_timing),
+                          &i.results);
+    i.seconds = b.use_real_time() ? i.results.real_time_used
+                                  : i.results.cpu_time_used;
+  }
+
   // Produce memory measurements if requested.
   MemoryManager::Result memory_result;
   IterationCount memory_iterations = 0;
   if (memory_manager != nullptr) {
-    // Only run a few iterations to reduce the impact of one-time
+    // Only run a few iterations by default to reduce the impact of one-time
     // allocations in benchmarks that are not properly managed.
-    memory_iterations = std::min<IterationCount>(16, iters);
+    memory_iterations =
+        FLAGS_benchmark_memory_iterations > 0
+            ? std::min<IterationCount>(FLAGS_benchmark_memory_iterations, iters)
+            : iters;
     memory_result = RunMemoryManager(memory_iterations);
   }
 
@@ -553,10 +834,18 @@ void BenchmarkRunner::DoOneRepetition() {
     RunProfilerManager(iters);
   }
 
+  if (b.latency_histogram() && !FLAGS_benchmark_dry_run &&
+      i.results.skipped_ == internal::NotSkipped) {
+    // Time every iteration in a separate pass, so that the overhead of doing
+    // so does not affect the regular measurements.
+    RunLatencySampler(iters);
+  }
+
   // Ok, now actually report.
   BenchmarkReporter::Run report =
       CreateRunReport(b, i.results, memory_iterations, memory_result, i.seconds,
-                      num_repetitions_done, repeats);
+                      num_repetitions_done, repeats, thread_cpus);
+  report.overhead_subtracted = subtract_overhead;
 
   if (reports_for_family != nullptr) {
     ++reports_for_family->num_runs_done;
@@ -568,14 +857,138 @@ void BenchmarkRunner::DoOneRepetition() {
   run_results.non_aggregates.push_back(report);
 
   ++num_repetitions_done;
+  repetitions_time += ChronoClockNow() - repetition_start;
+
+  if (HasRepeatsRemaining() && BaselineDecided()) {
+    // The remaining repetitions would not change the outcome.
+    if (reports_for_family != nullptr) {
+      reports_for_family->num_runs_total -= repeats - num_repetitions_done;
+    }
+    repeats = num_repetitions_done;
+  }
+}
+
+void BenchmarkRunner::SetBaseline(const BaselineTimes* baseline_,
+                                  double max_regression_) {
+  baseline = baseline_;
+  max_regression = max_regression_;
+}
+
+bool BenchmarkRunner::BaselineDecided() const {
+  if (baseline == nullptr) {
+    return false;
+  }
+  const bool use_real_time = b.use_real_time() || b.use_manual_time();
+  return CompareToBaseline(
+             PerIterationTimes(run_results.non_aggregates, use_real_time),
+             use_real_time ? baseline->real_time : baseline->cpu_time,
+             max_regression)
+             .verdict != kBaselineUndecided;
+}
+
+bool BenchmarkRunner::CanRunInParallel() const {
+  return b.threads() == 1 && !b.GetUserThreadRunnerFactory() &&
+         thread_cpus.empty();
+}
+
+RunResults BenchmarkRunner::GetFailedResults(
+    const std::string& message) const {
+  internal::ThreadManager::Result results;
+  results.skipped_ = internal::SkippedWithError;
+  results.skip_message_ = message;
+  RunResults failed;
+  failed.display_report_aggregates_only =
+      run_results.display_report_aggregates_only;
+  failed.file_report_aggregates_only = run_results.file_report_aggregates_only;
+  failed.non_aggregates.push_back(CreateRunReport(
+      b, results, /*memory_iterations=*/0, MemoryManager::Result(),
+      /*seconds=*/0, /*repetition_index=*/0, repeats, thread_cpus));
+  return failed;
+}
+
+bool BenchmarkRunner::AddRepetitionIfUnconverged() {
+  if (!(target_rel_ci > 0) ||
+      repetitions_time >= FLAGS_benchmark_target_rel_ci_max_time ||
+      BaselineDecided()) {
+    return false;
+  }
+  std::vector<double> times;
+  times.reserve(run_results.non_aggregates.size());
+  for (const BenchmarkReporter::Run& run : run_results.non_aggregates) {
+    if (run.skipped != 0u) {
+      // Errors are not going to converge.
+      return false;
+    }
+    // All repetitions run the same number of iterations.
+    times.push_back(b.use_real_time() || b.use_manual_time()
+                        ? run.real_accumulated_time
+                        : run.cpu_accumulated_time);
+  }
+  if (times.size() >= static_cast<size_t>(kMinRelCIRepetitions) &&
+      StatisticsRelCI(times) <= target_rel_ci) {
+    return false;
+  }
+  ++repeats;
+  if (reports_for_family != nullptr) {
+    ++reports_for_family->num_runs_total;
+  }
+  return true;
 }
 
 RunResults&& BenchmarkRunner::GetResults() {
   assert(!HasRepeatsRemaining() && "Did not run all repetitions yet?");
 
+  if (target_rel_ci > 0 || baseline != nullptr) {
+    // The repetitions were planned one at a time, or cut short.
+    for (BenchmarkReporter::Run& run : run_results.non_aggregates) {
+      run.repetitions = num_repetitions_done;
+    }
+  }
+
   // Calculate additional statistics over the repetitions of this instance.
   run_results.aggregates_only = ComputeStats(run_results.non_aggregates);
 
+  // When the perf counters were rotated, no single repetition counted all
+  // the events of a preset, but their mean and median can still be related.
+  if (perf_counters_measurement_ptr != nullptr) {
+    for (BenchmarkReporter::Run& run : run_results.aggregates_only) {
+      if (run.aggregate_name == "mean" || run.aggregate_name == "median") {
+        perf_counters_measurement_ptr->AddDerivedMetrics(&run.counters);
+      }
+    }
+  }
+
+  if (target_rel_ci > 0) {
+    // Report the confidence interval that was reached.
+    static const std::vector<Statistics>* const rel_ci_statistics =
+        new std::vector<Statistics>{
+            {"rel_ci", StatisticsRelCI, StatisticUnit::kPercentage}};
+    std::vector<BenchmarkReporter::Run> runs = run_results.non_aggregates;
+    for (BenchmarkReporter::Run& run : runs) {
+      run.statistics = rel_ci_statistics;
+    }
+    const std::vector<BenchmarkReporter::Run> rel_ci = ComputeStats(runs);
+    run_results.aggregates_only.insert(run_results.aggregates_only.end(),
+                                       rel_ci.begin(), rel_ci.end());
+  }
+
+  if (b.latency_histogram()) {
+    const std::vector<BenchmarkReporter::Run> latency_aggregates =
+        ComputeLatencyAggregates();
+    run_results.aggregates_only.insert(run_results.aggregates_only.end(),
+                                       latency_aggregates.begin(),
+                                       latency_aggregates.end());
+  }
+
+  if (!profile_samples.empty()) {
+    const std::string path =
+        FLAGS_benchmark_profile_dir + "/" + ProfileFileName(b.name().str());
+    if (!WriteFoldedStacks(profile_samples, path)) {
+      GetErrorLogInstance() << "Failed to write the profile of "
+                            << b.name().str() << " to " << path << "\n";
+    }
+  }
+
   return std::move(run_results);
 }
 
@@ -19,8 +19,11 @@
 #include <thread>
 #include <vector>
 
+#include "baseline.h"
 #include "benchmark_api_internal.h"
+#include "latency_histogram.h"
 #include "perf_counters.h"
+#include "sampling_profiler.h"
 #include "thread_manager.h"
 
 namespace benchmark {
@@ -63,8 +66,34 @@ class BenchmarkRunner {
 
   void DoOneRepetition();
 
+  // With --benchmark_target_rel_ci, once the planned repetitions are done,
+  // plans one more if the confidence interval of the mean is still wider than
+  // the target and the time cap has not been reached. Returns whether it did.
+  bool AddRepetitionIfUnconverged();
+
+  // The runs of the repetitions done so far, before any aggregates have been
+  // computed.
+  const RunResults& GetPartialResults() const { return run_results; }
+
+  // With --benchmark_baseline, compares the repetitions against `baseline`
+  // as they finish, and skips the remaining ones once the outcome against
+  // `max_regression` is clear either way.
+  void SetBaseline(const BaselineTimes* baseline, double max_regression);
+
+  // Whether the number of repetitions is known before they run, so that each
+  // one can be reported as it finishes with its final `repetitions`. It is not
+  // when they are added until the confidence interval converges, or cut
+  // short against the baseline.
+  bool HasFixedRepetitions() const {
+    return !(target_rel_ci > 0) && baseline == nullptr;
+  }
+
   RunResults&& GetResults();
 
+  // Returns a single errored run with `message`, for an instance whose
+  // repetitions could not be run at all.
+  RunResults GetFailedResults(const std::string& message) const;
+
   BenchmarkReporter::PerFamilyRunReports* GetReportsForFamily() const {
     return reports_for_family;
   }
@@ -73,6 +102,10 @@ class BenchmarkRunner {
 
   bool HasExplicitIters() const { return has_explicit_iteration_count; }
 
+  // Whether the instance can share the machine with other instances, i.e.
+  // it runs on a single thread that is not pinned to a CPU of its own.
+  bool CanRunInParallel() const;
+
   IterationCount GetIters() const { return iters; }
 
  private:
@@ -85,19 +118,38 @@ class BenchmarkRunner {
   const double min_time;
   const double min_warmup_time;
   bool warmup_done;
-  const int repeats;
+  int repeats;
   const bool has_explicit_iteration_count;
+  // Relative confidence interval to reach, or zero to run `repeats` times.
+  const double target_rel_ci;
+  // Wall time spent on the repetitions so far.
+  double repetitions_time = 0;
+  // Times of the previous report to compare against, or null.
+  const BaselineTimes* baseline = nullptr;
+  double max_regression = 0;
 
   int num_repetitions_done = 0;
 
   std::unique_ptr<ThreadRunnerBase> thread_runner;
 
+  // CPU each thread is pinned to, or empty if threads are not pinned.
+  const std::vector<int> thread_cpus;
+
   IterationCount iters;  // preserved between repetitions!
   // So only the first repetition has to find/calculate it,
   // the other repetitions will just use that precomputed iteration count.
 
   PerfCountersMeasurement* const perf_counters_measurement_ptr = nullptr;
 
+  // Iteration latencies of all repetitions in cycle clock ticks, along with
+  // the ticks and wall time the sampling passes took to convert them.
+  LatencyHistogram latency_histogram;
+  int64_t latency_ticks = 0;
+  double latency_seconds = 0;
+
+  // Call stacks the built-in sampling profiler saw in the profiling passes.
+  SampledStacks profile_samples;
+
   struct IterationResults {
     internal::ThreadManager::Result results;
     IterationCount iters;
@@ -109,8 +161,14 @@ class BenchmarkRunner {
 
   void RunProfilerManager(IterationCount profile_iterations);
 
+  void RunLatencySampler(IterationCount sample_iterations);
+
+  std::vector<BenchmarkReporter::Run> ComputeLatencyAggregates() const;
+
   IterationCount PredictNumItersNeeded(const IterationResults& i) const;
 
+  bool BaselineDecided() const;
+
   bool ShouldReportIterationResults(const IterationResults& i) const;
 
   double GetMinTimeToApply() const;
@@ -99,6 +99,12 @@ void ConsoleReporter::ReportRuns(const std::vector<Run>& reports) {
   }
 }
 
+BENCHMARK_EXPORT
+bool ConsoleReporter::ReportRepetition(const Run& run) {
+  ReportRuns({run});
+  return true;
+}
+
 PRINTF_FORMAT_STRING_FUNC(3, 4)
 static void IgnoreColorPrint(std::ostream& out, LogColor /*unused*/,
                              const char* fmt, ...) {
@@ -171,6 +177,9 @@ void ConsoleReporter::PrintRunData(const Run& result) {
     const char* timeLabel = GetTimeUnitString(result.time_unit);
     printer(Out, COLOR_YELLOW, "%s %-4s %s %-4s ", real_time_str.c_str(),
             timeLabel, cpu_time_str.c_str(), timeLabel);
+  } else if (result.aggregate_unit == StatisticUnit::kProbability) {
+    printer(Out, COLOR_YELLOW, "%10.4f %-4s %10.4f %-4s ",
+            result.real_accumulated_time, "", result.cpu_accumulated_time, "");
   } else {
     assert(result.aggregate_unit == StatisticUnit::kPercentage);
     printer(Out, COLOR_YELLOW, "%10.2f %-4s %10.2f %-4s ",
@@ -108,6 +108,12 @@ void CSVReporter::ReportRuns(const std::vector<Run>& reports) {
   }
 }
 
+BENCHMARK_EXPORT
+bool CSVReporter::ReportRepetition(const Run& run) {
+  ReportRuns({run});
+  return true;
+}
+
 BENCHMARK_EXPORT
 void CSVReporter::PrintRunData(const Run& run) {
   std::ostream& Out = GetOutputStream();
@@ -130,7 +136,8 @@ void CSVReporter::PrintRunData(const Run& run) {
     Out << run.GetAdjustedRealTime() << ",";
     Out << run.GetAdjustedCPUTime() << ",";
   } else {
-    assert(run.aggregate_unit == StatisticUnit::kPercentage);
+    assert(run.aggregate_unit == StatisticUnit::kPercentage ||
+           run.aggregate_unit == StatisticUnit::kProbability);
     Out << run.real_accumulated_time << ",";
     Out << run.cpu_accumulated_time << ",";
   }
@@ -138,8 +145,7 @@ void CSVReporter::PrintRunData(const Run& run) {
   // Do not print timeLabel on bigO and RMS report
   if (run.report_big_o) {
     Out << GetBigOString(run.complexity);
-  } else if (!run.report_rms &&
-             run.aggregate_unit != StatisticUnit::kPercentage) {
+  } else if (!run.report_rms && run.aggregate_unit == StatisticUnit::kTime) {
     Out << GetTimeUnitString(run.time_unit);
   }
   Out << ",";
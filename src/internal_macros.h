@@ -102,6 +102,13 @@
   #define BENCHMARK_HAS_NO_EXCEPTIONS
 #endif
 
+#if !defined(BENCHMARK_OS_WINDOWS) && !defined(BENCHMARK_OS_EMSCRIPTEN) && \
+    !defined(BENCHMARK_OS_WASI) && !defined(BENCHMARK_OS_NACL) && \
+    !defined(BENCHMARK_OS_FUCHSIA) && !defined(BENCHMARK_OS_QURT) && \
+    !defined(BENCHMARK_OS_RTEMS) && !defined(BENCHMARK_OS_IOS)
+  #define BENCHMARK_HAS_FORK 1
+#endif
+
 #if defined(COMPILER_CLANG) || defined(COMPILER_GCC)
   #define BENCHMARK_MAYBE_UNUSED __attribute__((unused))
 #else
@@ -0,0 +1,486 @@
+// Copyright 2025 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "isolation.h"
+
+#include "internal_macros.h"
+
+#ifdef BENCHMARK_HAS_FORK
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "check.h"
+#include "string_util.h"
+#include "thread_pool.h"
+#include "timers.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+// Visits every field of the types that make up RunResults, for Writer and
+// Reader alike. Keep in sync with BenchmarkReporter::Run.
+template <class Archive, class Name>
+void VisitName(Archive& a, Name& name) {
+  a.Field(name.function_name);
+  a.Field(name.args);
+  a.Field(name.min_time);
+  a.Field(name.min_warmup_time);
+  a.Field(name.iterations);
+  a.Field(name.repetitions);
+  a.Field(name.time_type);
+  a.Field(name.threads);
+}
+
+template <class Archive, class ThreadResult>
+void VisitThreadResult(Archive& a, ThreadResult& t) {
+  a.Field(t.iterations);
+  a.Field(t.real_accumulated_time);
+  a.Field(t.cpu_accumulated_time);
+  a.Field(t.barrier_wait_time);
+  a.Field(t.start_delay);
+  a.Field(t.counters);
+}
+
+template <class Archive, class Run>
+void VisitRun(Archive& a, Run& run) {
+  a.Field(run.run_name);
+  a.Field(run.family_index);
+  a.Field(run.per_family_instance_index);
+  a.Field(run.run_type);
+  a.Field(run.aggregate_name);
+  a.Field(run.aggregate_unit);
+  a.Field(run.report_label);
+  a.Field(run.skipped);
+  a.Field(run.skip_message);
+  a.Field(run.iterations);
+  a.Field(run.threads);
+  a.Field(run.thread_cpus);
+  a.Field(run.repetition_index);
+  a.Field(run.repetitions);
+  a.Field(run.time_unit);
+  a.Field(run.real_accumulated_time);
+  a.Field(run.cpu_accumulated_time);
+  a.Field(run.per_thread);
+  a.Field(run.max_heapbytes_used);
+  a.Field(run.use_real_time_for_initial_big_o);
+  a.Field(run.complexity);
+  a.Field(run.complexity_lambda);
+  a.Field(run.complexity_n);
+  a.Field(run.statistics);
+  a.Field(run.report_big_o);
+  a.Field(run.report_rms);
+  a.Field(run.counters);
+  a.Field(run.memory_result);
+  a.Field(run.allocs_per_iter);
+  a.Field(run.overhead_subtracted);
+  a.Field(run.working_set_bytes);
+  a.Field(run.cache_level);
+  a.Field(run.peak_memory_bandwidth);
+}
+
+template <class Archive, class Results>
+void VisitRunResults(Archive& a, Results& results) {
+  a.Field(results.non_aggregates);
+  a.Field(results.aggregates_only);
+  a.Field(results.display_report_aggregates_only);
+  a.Field(results.file_report_aggregates_only);
+}
+
+class Writer {
+ public:
+  template <class T>
+  typename std::enable_if<std::is_trivially_copyable<T>::value>::type Field(
+      const T& value) {
+    data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  void Field(const std::string& s) {
+    Field(static_cast<uint64_t>(s.size()));
+    data_.append(s);
+  }
+  template <class T>
+  void Field(const std::vector<T>& v) {
+    Field(static_cast<uint64_t>(v.size()));
+    for (const T& e : v) {
+      Field(e);
+    }
+  }
+  template <class K, class V>
+  void Field(const std::map<K, V>& m) {
+    Field(static_cast<uint64_t>(m.size()));
+    for (const auto& kv : m) {
+      Field(kv.first);
+      Field(kv.second);
+    }
+  }
+  void Field(const BenchmarkName& name) { VisitName(*this, name); }
+  void Field(const BenchmarkReporter::Run::ThreadResult& t) {
+    VisitThreadResult(*this, t);
+  }
+  void Field(const BenchmarkReporter::Run& run) { VisitRun(*this, run); }
+
+  std::string& data() { return data_; }
+
+ private:
+  std::string data_;
+};
+
+class Reader {
+ public:
+  explicit Reader(const std::string& data) : data_(data) {}
+
+  template <class T>
+  typename std::enable_if<std::is_trivially_copyable<T>::value>::type Field(
+      T& value) {
+    if (!Consume(sizeof(value))) {
+      return;
+    }
+    std::memcpy(&value, data_.data() + pos_ - sizeof(value), sizeof(value));
+  }
+  void Field(std::string& s) {
+    const size_t size = ReadSize();
+    if (Consume(size)) {
+      s.assign(data_, pos_ - size, size);
+    }
+  }
+  template <class T>
+  void Field(std::vector<T>& v) {
+    // Every element takes at least a byte, which bounds the allocation.
+    v.resize(ReadSize());
+    for (T& e : v) {
+      Field(e);
+    }
+  }
+  template <class K, class V>
+  void Field(std::map<K, V>& m) {
+    const size_t size = ReadSize();
+    for (size_t i = 0; i < size && ok_; ++i) {
+      K key;
+      Field(key);
+      Field(m[key]);
+    }
+  }
+  void Field(BenchmarkName& name) { VisitName(*this, name); }
+  void Field(BenchmarkReporter::Run::ThreadResult& t) {
+    VisitThreadResult(*this, t);
+  }
+  void Field(BenchmarkReporter::Run& run) { VisitRun(*this, run); }
+
+  // Whether all of the data, and nothing but the data, has been read.
+  bool Done() const { return ok_ && pos_ == data_.size(); }
+
+ private:
+  bool Consume(size_t size) {
+    if (!ok_ || size > data_.size() - pos_) {
+      ok_ = false;
+      return false;
+    }
+    pos_ += size;
+    return true;
+  }
+  size_t ReadSize() {
+    uint64_t size = 0;
+    Field(size);
+    if (size > data_.size() - pos_) {
+      ok_ = false;
+      return 0;
+    }
+    return static_cast<size_t>(size);
+  }
+
+  const std::string& data_;
+  size_t pos_ = 0;
+  bool ok_ = true;
+};
+
+#ifdef BENCHMARK_HAS_FORK
+bool WriteAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    const ssize_t n = write(fd, data.data() + written, data.size() - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    written += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+void FlushAll() {
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(nullptr);
+}
+
+// A job running in a child process.
+struct Child {
+  pid_t pid = -1;
+  int fd = -1;  // Read end of the pipe the child writes its results to.
+  size_t job = 0;
+  int slot = -1;
+  bool exclusive = false;
+  double deadline = 0;
+  std::string data;
+};
+
+// The outcome of a job, kept until it is its turn to be reported.
+struct Outcome {
+  bool ok = false;
+  RunResults results;
+  std::string error;
+};
+
+bool StartChild(const ChildJob& job, int slot, Child* child,
+                std::string* error) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    *error = StrCat("could not create a pipe: ", std::strerror(errno));
+    return false;
+  }
+  // Whatever is buffered would otherwise be written by both processes.
+  FlushAll();
+  const pid_t pid = fork();
+  if (pid < 0) {
+    *error = StrCat("could not fork: ", std::strerror(errno));
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    ThreadPool::ResetAfterFork();
+    const bool written = WriteAll(fds[1], SerializeRunResults(job.fn(slot)));
+    FlushAll();
+    // Skip the destructors of the parent's static objects.
+    _exit(written ? 0 : 1);
+  }
+  close(fds[1]);
+  child->pid = pid;
+  child->fd = fds[0];
+  child->slot = slot;
+  child->exclusive = job.exclusive;
+  return true;
+}
+
+// Reaps `child`, killing it first if it timed out, and returns its outcome.
+Outcome FinishChild(Child* child, bool timed_out, double timeout) {
+  close(child->fd);
+  if (timed_out) {
+    kill(child->pid, SIGKILL);
+  }
+  int status = 0;
+  while (waitpid(child->pid, &status, 0) < 0 && errno == EINTR) {
+  }
+
+  Outcome outcome;
+  if (timed_out) {
+    outcome.error = StrFormat("timed out after %g s", timeout);
+  } else if (WIFSIGNALED(status)) {
+    outcome.error = StrCat("crashed with signal ", WTERMSIG(status), " (",
+                           strsignal(WTERMSIG(status)), ")");
+  } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    outcome.error = StrCat("exited with status ", WEXITSTATUS(status));
+  } else if (!DeserializeRunResults(child->data, &outcome.results)) {
+    outcome.error = "exited without reporting results";
+  } else {
+    outcome.ok = true;
+  }
+  return outcome;
+}
+#endif
+
+}  // end namespace
+
+bool ParseIsolation(const std::string& value, IsolationMode* mode) {
+  if (value == "none") {
+    *mode = kIsolationNone;
+    return true;
+  }
+  if (value == "process") {
+    *mode = kIsolationProcess;
+    return true;
+  }
+  return false;
+}
+
+bool IsolationSupported() {
+#ifdef BENCHMARK_HAS_FORK
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::string SerializeRunResults(const RunResults& results) {
+  Writer writer;
+  VisitRunResults(writer, results);
+  return std::move(writer.data());
+}
+
+bool DeserializeRunResults(const std::string& data, RunResults* results) {
+  Reader reader(data);
+  RunResults read;
+  VisitRunResults(reader, read);
+  if (!reader.Done()) {
+    return false;
+  }
+  *results = std::move(read);
+  return true;
+}
+
+void RunInChildProcesses(const std::vector<ChildJob>& jobs, int max_parallel,
+                         double timeout, const ChildJobDone& done) {
+#ifdef BENCHMARK_HAS_FORK
+  BM_CHECK_GE(max_parallel, 1);
+  std::vector<std::unique_ptr<Outcome>> outcomes(jobs.size());
+  std::vector<Child> running;
+  std::vector<bool> slot_used(static_cast<size_t>(max_parallel), false);
+  size_t next_job = 0;
+  size_t next_report = 0;
+  while (next_report < jobs.size()) {
+    // Start as many jobs as the running ones allow.
+    while (next_job < jobs.size()) {
+      const ChildJob& job = jobs[next_job];
+      const bool blocked =
+          job.exclusive
+              ? !running.empty()
+              : (running.size() >= static_cast<size_t>(max_parallel) ||
+                 (!running.empty() && running.front().exclusive));
+      if (blocked) {
+        break;
+      }
+      int slot = -1;
+      if (!job.exclusive) {
+        slot = static_cast<int>(
+            std::find(slot_used.begin(), slot_used.end(), false) -
+            slot_used.begin());
+      }
+      Child child;
+      child.job = next_job;
+      child.deadline = ChronoClockNow() + timeout;
+      std::string error;
+      if (StartChild(job, slot, &child, &error)) {
+        if (slot >= 0) {
+          slot_used[static_cast<size_t>(slot)] = true;
+        }
+        running.push_back(std::move(child));
+      } else {
+        outcomes[next_job].reset(new Outcome);
+        outcomes[next_job]->error = error;
+      }
+      ++next_job;
+    }
+
+    // Report the jobs that are done, in order.
+    while (next_report < jobs.size() && outcomes[next_report] != nullptr) {
+      Outcome& outcome = *outcomes[next_report];
+      done(next_report, outcome.ok, outcome.results, outcome.error);
+      outcomes[next_report].reset();
+      ++next_report;
+    }
+    if (running.empty()) {
+      continue;
+    }
+
+    // Wait for output from any child, or for the earliest deadline.
+    std::vector<pollfd> pfds;
+    double wait = -1;
+    for (const Child& child : running) {
+      pfds.push_back({child.fd, POLLIN, 0});
+      if (timeout > 0) {
+        const double remaining = std::max(child.deadline - ChronoClockNow(), 0.0);
+        wait = wait < 0 ? remaining : std::min(wait, remaining);
+      }
+    }
+    // Interruptions and errors show up as children without events.
+    poll(pfds.data(), static_cast<nfds_t>(pfds.size()),
+         wait < 0 ? -1 : static_cast<int>(std::ceil(wait * 1e3)));
+
+    char buffer[1 << 16];
+    for (size_t i = running.size(); i-- > 0;) {
+      Child& child = running[i];
+      bool finished = false;
+      bool timed_out = false;
+      if (pfds[i].revents != 0) {
+        const ssize_t n = read(child.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+          child.data.append(buffer, static_cast<size_t>(n));
+        } else if (n == 0 || errno != EINTR) {
+          finished = true;
+        }
+      }
+      if (!finished && timeout > 0 && ChronoClockNow() >= child.deadline) {
+        finished = true;
+        timed_out = true;
+      }
+      if (finished) {
+        outcomes[child.job].reset(
+            new Outcome(FinishChild(&child, timed_out, timeout)));
+        if (child.slot >= 0) {
+          slot_used[static_cast<size_t>(child.slot)] = false;
+        }
+        running.erase(running.begin() + static_cast<std::ptrdiff_t>(i));
+      }
+    }
+  }
+#else
+  (void)max_parallel;
+  (void)timeout;
+  RunResults results;
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    done(i, false, results,
+         "process isolation is not supported on this platform");
+  }
+#endif
+}
+
+bool RunInChildProcess(const std::function<RunResults()>& fn, double timeout,
+                       RunResults* results, std::string* error) {
+  ChildJob job;
+  job.fn = [&fn](int /*slot*/) { return fn(); };
+  bool ok = false;
+  RunInChildProcesses({job}, 1, timeout,
+                      [&](size_t /*job*/, bool job_ok, RunResults& job_results,
+                          const std::string& job_error) {
+                        ok = job_ok;
+                        if (ok) {
+                          *results = std::move(job_results);
+                        } else {
+                          *error = job_error;
+                        }
+                      });
+  return ok;
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,70 @@
+#ifndef BENCHMARK_ISOLATION_H_
+#define BENCHMARK_ISOLATION_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "benchmark/export.h"
+#include "benchmark_runner.h"
+
+namespace benchmark {
+namespace internal {
+
+// Where benchmark instances run, see --benchmark_isolation.
+enum IsolationMode {
+  kIsolationNone,     // All in this process.
+  kIsolationProcess,  // Each instance in a child process of its own.
+};
+
+// Parses a `--benchmark_isolation` value: `none` or `process`.
+BENCHMARK_EXPORT bool ParseIsolation(const std::string& value,
+                                     IsolationMode* mode);
+
+// Whether child processes can be forked on this platform.
+BENCHMARK_EXPORT bool IsolationSupported();
+
+// Converts `results` to and from bytes. Pointers in the runs (statistics and
+// complexity functions) are passed as is, so the bytes can only be read by a
+// process forked from the writer, or the writer itself.
+BENCHMARK_EXPORT std::string SerializeRunResults(const RunResults& results);
+BENCHMARK_EXPORT bool DeserializeRunResults(const std::string& data,
+                                            RunResults* results);
+
+// A function to call in a child process. Jobs that are not `exclusive` may run
+// alongside each other, each with a `slot` of its own from 0 to the number of
+// parallel jobs minus one. Exclusive jobs run alone and get slot -1.
+struct ChildJob {
+  std::function<RunResults(int slot)> fn;
+  bool exclusive = false;
+};
+
+// Called in this process with the outcome of a ChildJob. If `ok` is false,
+// `error` describes what went wrong.
+using ChildJobDone =
+    std::function<void(size_t job, bool ok, RunResults& results,
+                       const std::string& error)>;
+
+// Runs every job in a child process forked from this one, at most
+// `max_parallel` at a time, and calls `done` for every job, in order, as soon
+// as it and all jobs before it have finished. A job fails if its child
+// crashes, exits without returning, or does not finish within `timeout`
+// seconds (when positive), in which case the child is killed.
+// REQUIRES: IsolationSupported()
+BENCHMARK_EXPORT void RunInChildProcesses(const std::vector<ChildJob>& jobs,
+                                          int max_parallel, double timeout,
+                                          const ChildJobDone& done);
+
+// Calls `fn` in a child process forked from this one and stores the results it
+// returned in `results`. If the child crashes, exits without returning, or
+// does not finish within `timeout` seconds (when positive), it is killed,
+// `error` describes what happened and false is returned.
+// REQUIRES: IsolationSupported()
+BENCHMARK_EXPORT bool RunInChildProcess(const std::function<RunResults()>& fn,
+                                        double timeout, RunResults* results,
+                                        std::string* error);
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_ISOLATION_H_
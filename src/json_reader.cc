@@ -0,0 +1,300 @@
+// Copyright 2025 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "json_reader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+
+#include "string_util.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+// Deeper nesting than any report has is rejected rather than risking the
+// stack on a malformed file.
+constexpr int kMaxDepth = 64;
+
+class Parser {
+ public:
+  explicit Parser(const std::string& text) : text_(text) {}
+
+  bool ParseDocument(JsonValue* value) {
+    if (!ParseValue(value, 0)) {
+      return false;
+    }
+    SkipWhitespace();
+    if (pos_ != text_.size()) {
+      return Fail("unexpected trailing characters");
+    }
+    return true;
+  }
+
+  const std::string& error() const { return error_; }
+
+ private:
+  bool Fail(const char* what) {
+    if (error_.empty()) {
+      error_ = StrCat(what, " at offset ", pos_);
+    }
+    return false;
+  }
+
+  void SkipWhitespace() {
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+            text_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  bool Consume(const char* literal) {
+    const size_t len = std::strlen(literal);
+    if (text_.compare(pos_, len, literal) != 0) {
+      return false;
+    }
+    pos_ += len;
+    return true;
+  }
+
+  bool ParseValue(JsonValue* value, int depth) {
+    if (depth > kMaxDepth) {
+      return Fail("nesting too deep");
+    }
+    SkipWhitespace();
+    if (pos_ == text_.size()) {
+      return Fail("unexpected end of input");
+    }
+    const char c = text_[pos_];
+    if (c == '{') {
+      return ParseObject(value, depth);
+    }
+    if (c == '[') {
+      return ParseArray(value, depth);
+    }
+    if (c == '"') {
+      value->type = JsonValue::kString;
+      return ParseString(&value->string);
+    }
+    if (Consume("true")) {
+      value->type = JsonValue::kBool;
+      value->boolean = true;
+      return true;
+    }
+    if (Consume("false")) {
+      value->type = JsonValue::kBool;
+      value->boolean = false;
+      return true;
+    }
+    if (Consume("null")) {
+      value->type = JsonValue::kNull;
+      return true;
+    }
+    return ParseNumber(value);
+  }
+
+  bool ParseObject(JsonValue* value, int depth) {
+    value->type = JsonValue::kObject;
+    ++pos_;  // '{'
+    SkipWhitespace();
+    if (Consume("}")) {
+      return true;
+    }
+    for (;;) {
+      SkipWhitespace();
+      if (pos_ == text_.size() || text_[pos_] != '"') {
+        return Fail("expected a member name");
+      }
+      std::string key;
+      if (!ParseString(&key)) {
+        return false;
+      }
+      SkipWhitespace();
+      if (!Consume(":")) {
+        return Fail("expected ':'");
+      }
+      value->keys.push_back(std::move(key));
+      value->values.emplace_back();
+      if (!ParseValue(&value->values.back(), depth + 1)) {
+        return false;
+      }
+      SkipWhitespace();
+      if (Consume("}")) {
+        return true;
+      }
+      if (!Consume(",")) {
+        return Fail("expected ',' or '}'");
+      }
+    }
+  }
+
+  bool ParseArray(JsonValue* value, int depth) {
+    value->type = JsonValue::kArray;
+    ++pos_;  // '['
+    SkipWhitespace();
+    if (Consume("]")) {
+      return true;
+    }
+    for (;;) {
+      value->values.emplace_back();
+      if (!ParseValue(&value->values.back(), depth + 1)) {
+        return false;
+      }
+      SkipWhitespace();
+      if (Consume("]")) {
+        return true;
+      }
+      if (!Consume(",")) {
+        return Fail("expected ',' or ']'");
+      }
+    }
+  }
+
+  bool ParseString(std::string* out) {
+    ++pos_;  // '"'
+    while (pos_ < text_.size()) {
+      const char c = text_[pos_++];
+      if (c == '"') {
+        return true;
+      }
+      if (c != '\\') {
+        *out += c;
+        continue;
+      }
+      if (pos_ == text_.size()) {
+        break;
+      }
+      const char e = text_[pos_++];
+      switch (e) {
+        case '"':
+        case '\\':
+        case '/':
+          *out += e;
+          break;
+        case 'b':
+          *out += '\b';
+          break;
+        case 'f':
+          *out += '\f';
+          break;
+        case 'n':
+          *out += '\n';
+          break;
+        case 'r':
+          *out += '\r';
+          break;
+        case 't':
+          *out += '\t';
+          break;
+        case 'u': {
+          if (pos_ + 4 > text_.size()) {
+            return Fail("truncated \\u escape");
+          }
+          char* end = nullptr;
+          const std::string hex = text_.substr(pos_, 4);
+          const unsigned long code = std::strtoul(hex.c_str(), &end, 16);
+          if (end != hex.c_str() + 4) {
+            return Fail("invalid \\u escape");
+          }
+          pos_ += 4;
+          // Encode as UTF-8. Surrogate pairs are not combined, which is fine
+          // for the names and labels of benchmarks.
+          if (code < 0x80) {
+            *out += static_cast<char>(code);
+          } else if (code < 0x800) {
+            *out += static_cast<char>(0xC0 | (code >> 6));
+            *out += static_cast<char>(0x80 | (code & 0x3F));
+          } else {
+            *out += static_cast<char>(0xE0 | (code >> 12));
+            *out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            *out += static_cast<char>(0x80 | (code & 0x3F));
+          }
+          break;
+        }
+        default:
+          return Fail("invalid escape");
+      }
+    }
+    return Fail("unterminated string");
+  }
+
+  bool ParseNumber(JsonValue* value) {
+    value->type = JsonValue::kNumber;
+    if (Consume("NaN")) {
+      value->number = std::numeric_limits<double>::quiet_NaN();
+      return true;
+    }
+    if (Consume("Infinity")) {
+      value->number = std::numeric_limits<double>::infinity();
+      return true;
+    }
+    if (Consume("-Infinity")) {
+      value->number = -std::numeric_limits<double>::infinity();
+      return true;
+    }
+    const size_t start = pos_;
+    while (pos_ < text_.size() &&
+           std::strchr("+-0123456789.eE", text_[pos_]) != nullptr) {
+      ++pos_;
+    }
+    if (pos_ == start) {
+      return Fail("unexpected character");
+    }
+    // Numbers are always written in the classic locale.
+    std::istringstream ss(text_.substr(start, pos_ - start));
+    ss.imbue(std::locale::classic());
+    ss >> value->number;
+    if (ss.fail() || !ss.eof()) {
+      pos_ = start;
+      return Fail("invalid number");
+    }
+    return true;
+  }
+
+  const std::string& text_;
+  size_t pos_ = 0;
+  std::string error_;
+};
+
+}  // namespace
+
+const JsonValue* JsonValue::Find(const std::string& key) const {
+  if (type != kObject) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i] == key) {
+      return &values[i];
+    }
+  }
+  return nullptr;
+}
+
+bool ParseJson(const std::string& text, JsonValue* value,
+               std::string* error) {
+  Parser parser(text);
+  *value = JsonValue();
+  if (!parser.ParseDocument(value)) {
+    *error = parser.error();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace internal
+}  // namespace benchmark
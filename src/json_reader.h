@@ -0,0 +1,40 @@
+#ifndef BENCHMARK_JSON_READER_H_
+#define BENCHMARK_JSON_READER_H_
+
+#include <string>
+#include <vector>
+
+#include "benchmark/export.h"
+
+namespace benchmark {
+namespace internal {
+
+// A parsed JSON value, with just enough structure to read benchmark reports
+// back. `NaN`, `Infinity` and `-Infinity` are accepted as numbers, as the
+// JSON reporter writes them.
+struct JsonValue {
+  enum Type { kNull, kBool, kNumber, kString, kArray, kObject };
+
+  Type type = kNull;
+  bool boolean = false;
+  double number = 0;
+  std::string string;
+  // The elements of an array, or the member values of an object.
+  std::vector<JsonValue> values;
+  // The member names of an object, parallel to `values`.
+  std::vector<std::string> keys;
+
+  // Returns the member named `key`, or nullptr if there is none or this is
+  // not an object.
+  const JsonValue* Find(const std::string& key) const;
+};
+
+// Parses `text` as a single JSON value. On failure, returns false and sets
+// `error` to what went wrong and where.
+BENCHMARK_EXPORT bool ParseJson(const std::string& text, JsonValue* value,
+                                std::string* error);
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_JSON_READER_H_
@@ -18,6 +18,7 @@
 #include <iomanip>  // for setprecision
 #include <iostream>
 #include <limits>
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -115,12 +116,9 @@ std::string FormatKV(std::string const& key, double value) {
 
 int64_t RoundDouble(double v) { return std::lround(v); }
 
-}  // end namespace
-
-bool JSONReporter::ReportContext(const Context& context) {
-  std::ostream& out = GetOutputStream();
-
-  out << "{\n";
+// Prints the "context" member of the top level object.
+void PrintContext(std::ostream& out,
+                  const BenchmarkReporter::Context& context) {
   std::string inner_indent(2, ' ');
 
   // Open context block and print context information.
@@ -132,8 +130,10 @@ bool JSONReporter::ReportContext(const Context& context) {
 
   out << indent << FormatKV("host_name", context.sys_info.name) << ",\n";
 
-  if (Context::executable_name != nullptr) {
-    out << indent << FormatKV("executable", Context::executable_name) << ",\n";
+  if (BenchmarkReporter::Context::executable_name != nullptr) {
+    out << indent
+        << FormatKV("executable", BenchmarkReporter::Context::executable_name)
+        << ",\n";
   }
 
   CPUInfo const& info = context.cpu_info;
@@ -189,6 +189,14 @@ bool JSONReporter::ReportContext(const Context& context) {
   }
   out << "],\n";
 
+  const TimerOverhead& overhead = context.timer_overhead;
+  if (overhead.subtracted) {
+    out << indent << "\"timer_overhead\": {"
+        << FormatKV("empty_loop_ns", overhead.empty_loop * 1e9) << ", "
+        << FormatKV("pause_resume_ns", overhead.pause_resume * 1e9) << ", "
+        << FormatKV("subtracted", overhead.subtracted) << "},\n";
+  }
+
   out << indent << FormatKV("library_version", GetBenchmarkVersion());
   out << ",\n";
 
@@ -213,10 +221,44 @@ bool JSONReporter::ReportContext(const Context& context) {
     }
   }
   out << "\n";
+  out << inner_indent << "}";
+}
+
+// Joins the lines of `json` into one, dropping their indentation. String
+// values never contain raw newlines, as they are escaped.
+std::string ToSingleLine(const std::string& json) {
+  std::string line;
+  line.reserve(json.size());
+  for (size_t i = 0; i < json.size(); ++i) {
+    if (json[i] != '\n') {
+      line += json[i];
+      continue;
+    }
+    while (i + 1 < json.size() && json[i + 1] == ' ') {
+      ++i;
+    }
+  }
+  return line;
+}
+
+}  // end namespace
+
+bool JSONReporter::ReportContext(const Context& context) {
+  std::ostream& out = GetOutputStream();
+  if (format_ == OF_Lines) {
+    std::stringstream ss;
+    ss << "{\n";
+    PrintContext(ss, context);
+    ss << "\n}";
+    out << ToSingleLine(ss.str()) << std::endl;
+    return true;
+  }
+
+  out << "{\n";
+  PrintContext(out, context);
 
   // Close context block and open the list of benchmarks.
-  out << inner_indent << "},\n";
-  out << inner_indent << "\"benchmarks\": [\n";
+  out << ",\n" << std::string(2, ' ') << "\"benchmarks\": [\n";
   return true;
 }
 
@@ -226,6 +268,16 @@ void JSONReporter::ReportRuns(std::vector<Run> const& reports) {
   }
   std::string indent(4, ' ');
   std::ostream& out = GetOutputStream();
+  if (format_ == OF_Lines) {
+    for (const Run& run : reports) {
+      std::stringstream ss;
+      ss << "{\n";
+      PrintRunData(run, ss);
+      ss << '}';
+      out << ToSingleLine(ss.str()) << std::endl;
+    }
+    return;
+  }
   if (!first_report_) {
     out << ",\n";
   }
@@ -233,7 +285,7 @@ void JSONReporter::ReportRuns(std::vector<Run> const& reports) {
 
   for (auto it = reports.begin(); it != reports.end(); ++it) {
     out << indent << "{\n";
-    PrintRunData(*it);
+    PrintRunData(*it, out);
     out << indent << '}';
     auto it_cp = it;
     if (++it_cp != reports.end()) {
@@ -242,14 +294,21 @@ void JSONReporter::ReportRuns(std::vector<Run> const& reports) {
   }
 }
 
+bool JSONReporter::ReportRepetition(const Run& run) {
+  ReportRuns({run});
+  return true;
+}
+
 void JSONReporter::Finalize() {
+  if (format_ == OF_Lines) {
+    return;
+  }
   // Close the list of benchmarks and the top level object.
   GetOutputStream() << "\n  ]\n}\n";
 }
 
-void JSONReporter::PrintRunData(Run const& run) {
+void JSONReporter::PrintRunData(Run const& run, std::ostream& out) {
   std::string indent(6, ' ');
-  std::ostream& out = GetOutputStream();
   out << indent << FormatKV("name", run.benchmark_name()) << ",\n";
   out << indent << FormatKV("family_index", run.family_index) << ",\n";
   out << indent
@@ -271,6 +330,13 @@ void JSONReporter::PrintRunData(Run const& run) {
         << ",\n";
   }
   out << indent << FormatKV("threads", run.threads) << ",\n";
+  if (!run.thread_cpus.empty()) {
+    out << indent << "\"thread_cpus\": [";
+    for (size_t i = 0; i < run.thread_cpus.size(); ++i) {
+      out << (i == 0 ? "" : ", ") << run.thread_cpus[i];
+    }
+    out << "],\n";
+  }
   if (run.run_type == BenchmarkReporter::Run::RT_Aggregate) {
     out << indent << FormatKV("aggregate_name", run.aggregate_name) << ",\n";
     out << indent << FormatKV("aggregate_unit", [&run]() -> const char* {
@@ -279,6 +345,8 @@ void JSONReporter::PrintRunData(Run const& run) {
           return "time";
         case StatisticUnit::kPercentage:
           return "percentage";
+        case StatisticUnit::kProbability:
+          return "probability";
       }
       BENCHMARK_UNREACHABLE();
     }()) << ",\n";
@@ -298,7 +366,8 @@ void JSONReporter::PrintRunData(Run const& run) {
           << ",\n";
       out << indent << FormatKV("cpu_time", run.GetAdjustedCPUTime());
     } else {
-      assert(run.aggregate_unit == StatisticUnit::kPercentage);
+      assert(run.aggregate_unit == StatisticUnit::kPercentage ||
+             run.aggregate_unit == StatisticUnit::kProbability);
       out << indent << FormatKV("real_time", run.real_accumulated_time)
           << ",\n";
       out << indent << FormatKV("cpu_time", run.cpu_accumulated_time);
@@ -316,6 +385,19 @@ void JSONReporter::PrintRunData(Run const& run) {
     out << indent << FormatKV("rms", run.GetAdjustedCPUTime());
   }
 
+  if (run.working_set_bytes > 0) {
+    out << ",\n"
+        << indent << FormatKV("working_set_bytes", run.working_set_bytes);
+    if (!run.cache_level.empty()) {
+      out << ",\n" << indent << FormatKV("cache_level", run.cache_level);
+    }
+    if (run.peak_memory_bandwidth > 0) {
+      out << ",\n"
+          << indent
+          << FormatKV("peak_memory_bandwidth", run.peak_memory_bandwidth);
+    }
+  }
+
   for (const auto& c : run.counters) {
     out << ",\n" << indent << FormatKV(c.first, c.second);
   }
@@ -335,7 +417,79 @@ void JSONReporter::PrintRunData(Run const& run) {
 
     report_if_present("total_allocated_bytes",
                       memory_result.total_allocated_bytes);
+    if (memory_result.total_allocated_bytes != MemoryManager::TombstoneValue) {
+      out << ",\n"
+          << indent
+          << FormatKV("bytes_per_iter",
+                      static_cast<double>(memory_result.total_allocated_bytes) /
+                          static_cast<double>(memory_result.memory_iterations));
+    }
     report_if_present("net_heap_growth", memory_result.net_heap_growth);
+    report_if_present("peak_rss_bytes", memory_result.peak_rss_bytes);
+    report_if_present("page_faults", memory_result.page_faults);
+
+    // Only the buckets that counted allocations, with their size range.
+    const int64_t* const sizes = memory_result.allocation_sizes;
+    const int num_buckets = MemoryManager::kNumAllocationSizeBuckets;
+    if (std::any_of(sizes, sizes + num_buckets,
+                    [](int64_t count) { return count != 0; })) {
+      out << ",\n" << indent << "\"allocation_sizes\": [";
+      const char* separator = "\n";
+      for (int i = 0; i < num_buckets; ++i) {
+        if (sizes[i] == 0) continue;
+        const int64_t min_bytes = i == 0 ? 0 : int64_t{1} << (i - 1);
+        out << separator << indent << "  {" << FormatKV("min_bytes", min_bytes);
+        if (i + 1 < num_buckets) {
+          out << ", " << FormatKV("max_bytes", (int64_t{1} << i) - 1);
+        }
+        out << ", " << FormatKV("count", sizes[i]) << "}";
+        separator = ",\n";
+      }
+      out << "\n" << indent << "]";
+    }
+  }
+
+  if (!run.per_thread.empty()) {
+    const double multiplier = GetTimeUnitMultiplier(run.time_unit);
+    out << ",\n" << indent << "\"per_thread\": [";
+    for (size_t i = 0; i < run.per_thread.size(); ++i) {
+      const Run::ThreadResult& t = run.per_thread[i];
+      const double iters =
+          t.iterations != 0 ? static_cast<double>(t.iterations) : 1.0;
+      out << (i == 0 ? "\n" : ",\n") << indent << "  {";
+      out << FormatKV("thread_index", static_cast<int64_t>(i));
+      out << ", " << FormatKV("iterations", t.iterations);
+      out << ", "
+          << FormatKV("real_time",
+                      t.real_accumulated_time * multiplier / iters);
+      out << ", "
+          << FormatKV("cpu_time", t.cpu_accumulated_time * multiplier / iters);
+      out << ", "
+          << FormatKV("barrier_wait_time", t.barrier_wait_time * multiplier);
+      out << ", " << FormatKV("start_delay", t.start_delay * multiplier);
+      for (const auto& c : t.counters) {
+        out << ", " << FormatKV(c.first, c.second);
+      }
+      out << "}";
+    }
+    out << "\n" << indent << "]";
+
+    const Run::ThreadImbalance imbalance = run.GetThreadImbalance();
+    out << ",\n"
+        << indent
+        << FormatKV("thread_max_min_ratio", imbalance.max_min_ratio);
+    out << ",\n"
+        << indent
+        << FormatKV("thread_straggler_time", imbalance.straggler_time);
+    out << ",\n"
+        << indent
+        << FormatKV("thread_barrier_wait_time", imbalance.barrier_wait_time);
+    out << ",\n"
+        << indent << FormatKV("thread_start_skew", imbalance.start_skew);
+  }
+
+  if (run.overhead_subtracted) {
+    out << ",\n" << indent << FormatKV("overhead_subtracted", true);
   }
 
   if (!run.report_label.empty()) {
@@ -347,6 +501,12 @@ void JSONReporter::PrintRunData(Run const& run) {
 void JSONReporter::List(
     const std::vector<internal::BenchmarkInstance>& benchmarks) {
   std::ostream& out = GetOutputStream();
+  if (format_ == OF_Lines) {
+    for (const internal::BenchmarkInstance& benchmark : benchmarks) {
+      out << '{' << FormatKV("name", benchmark.name().str()) << "}\n";
+    }
+    return;
+  }
   std::string inner_indent(2, ' ');
   std::string indent(4, ' ');
   std::string entry_indent(6, ' ');
@@ -0,0 +1,168 @@
+// Copyright 2025 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "check.h"
+#include "cycleclock.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+constexpr int kSubBucketCount = 1 << LatencyHistogram::kSubBucketBits;
+constexpr int kHalfSubBucketCount = kSubBucketCount / 2;
+// Values below kSubBucketCount get one bucket each; every further power of two
+// is split into kHalfSubBucketCount buckets.
+constexpr int kBucketCount =
+    kSubBucketCount +
+    (64 - LatencyHistogram::kSubBucketBits) * kHalfSubBucketCount;
+
+int MostSignificantBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - __builtin_clzll(value);
+#else
+  int msb = 0;
+  while (value >>= 1) {
+    ++msb;
+  }
+  return msb;
+#endif
+}
+
+size_t BucketIndex(uint64_t value) {
+  if (value < static_cast<uint64_t>(kSubBucketCount)) {
+    return static_cast<size_t>(value);
+  }
+  const int shift =
+      MostSignificantBit(value) - LatencyHistogram::kSubBucketBits + 1;
+  return static_cast<size_t>(shift * kHalfSubBucketCount) +
+         static_cast<size_t>(value >> shift);
+}
+
+// Returns the midpoint of the values that map to bucket `index`.
+int64_t BucketValue(size_t index) {
+  if (index < static_cast<size_t>(kSubBucketCount)) {
+    return static_cast<int64_t>(index);
+  }
+  const int shift = static_cast<int>(index / kHalfSubBucketCount) - 1;
+  const uint64_t mantissa = index - static_cast<size_t>(shift) *
+                                        static_cast<size_t>(kHalfSubBucketCount);
+  const uint64_t lowest = mantissa << shift;
+  return static_cast<int64_t>(lowest + (((uint64_t{1} << shift) - 1) >> 1));
+}
+
+}  // end namespace
+
+LatencyHistogram::LatencyHistogram()
+    : counts_(kBucketCount, 0), count_(0), max_(0) {}
+
+void LatencyHistogram::Record(int64_t value) {
+  // The cycle clock is not guaranteed to be monotonic across cores.
+  value = std::max<int64_t>(value, 0);
+  ++counts_[BucketIndex(static_cast<uint64_t>(value))];
+  ++count_;
+  max_ = std::max(max_, value);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::Clear() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  count_ = 0;
+  max_ = 0;
+}
+
+int64_t LatencyHistogram::ValueAtQuantile(double quantile) const {
+  BM_CHECK(quantile >= 0.0 && quantile <= 1.0);
+  if (count_ == 0) {
+    return 0;
+  }
+  const int64_t rank = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(quantile * static_cast<double>(count_))));
+  int64_t seen = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      // The midpoint of the last bucket can lie above the largest value.
+      return std::min(BucketValue(i), max_);
+    }
+  }
+  return max_;
+}
+
+void LatencySampler::Start(IterationCount iterations) {
+  remaining_ = iterations;
+  pending_ = 0;
+  paused_ticks_ = 0;
+  paused_ = false;
+}
+
+bool LatencySampler::Next(IterationCount n) {
+  if (pending_ != 0) {
+    const int64_t ticks =
+        cycleclock::Now() - last_ - paused_ticks_ - overhead_;
+    histogram_.Record(std::max<int64_t>(ticks, 0) / pending_);
+  }
+  if (remaining_ <= 0) {
+    pending_ = 0;
+    return false;
+  }
+  remaining_ -= n;
+  pending_ = n;
+  paused_ticks_ = 0;
+  // Read the clock last so that the bookkeeping above is not attributed to
+  // the next iteration.
+  last_ = cycleclock::Now();
+  return true;
+}
+
+void LatencySampler::Pause() {
+  pause_start_ = cycleclock::Now();
+  paused_ = true;
+}
+
+void LatencySampler::Resume() {
+  // State resumes the timing once before the first iteration, without
+  // pausing it first.
+  if (paused_) {
+    paused_ticks_ += cycleclock::Now() - pause_start_;
+    paused_ = false;
+  }
+}
+
+int64_t LatencySampler::CalibratedOverhead() {
+  static const int64_t overhead = [] {
+    constexpr IterationCount kIterations = 10000;
+    LatencySampler sampler(/*overhead_ticks=*/0);
+    sampler.Start(kIterations);
+    while (sampler.Next(1)) {
+    }
+    // Interrupts only make some of the samples slower, so take the median.
+    return sampler.histogram().ValueAtQuantile(0.5);
+  }();
+  return overhead;
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,89 @@
+#ifndef BENCHMARK_LATENCY_HISTOGRAM_H_
+#define BENCHMARK_LATENCY_HISTOGRAM_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/export.h"
+#include "benchmark/types.h"
+
+namespace benchmark {
+namespace internal {
+
+// A histogram of non-negative values with log-linear buckets, in the style of
+// HdrHistogram: values below 2^kSubBucketBits are recorded exactly, and larger
+// values with a relative error of at most 2^-(kSubBucketBits - 1). Memory use
+// is fixed and independent of the number of recorded values.
+class BENCHMARK_EXPORT LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 7;
+
+  LatencyHistogram();
+
+  void Record(int64_t value);
+  void Merge(const LatencyHistogram& other);
+  void Clear();
+
+  int64_t count() const { return count_; }
+  int64_t max() const { return max_; }
+
+  // Returns a value such that a fraction `quantile` of the recorded values is
+  // at or below it, within the precision of the buckets. `quantile` must be
+  // in [0, 1]. Returns 0 if nothing was recorded.
+  int64_t ValueAtQuantile(double quantile) const;
+
+ private:
+  std::vector<int64_t> counts_;
+  int64_t count_;
+  int64_t max_;
+};
+
+// Times individual iterations of one benchmark thread with the cycle clock
+// and records them into a histogram, in ticks. Driven by State while a
+// benchmark runs its latency sampling pass.
+class BENCHMARK_EXPORT LatencySampler {
+ public:
+  // Subtracts the calibrated CalibratedOverhead() from every sample.
+  LatencySampler() : LatencySampler(CalibratedOverhead()) {}
+  explicit LatencySampler(int64_t overhead_ticks)
+      : overhead_(overhead_ticks),
+        remaining_(0),
+        pending_(0),
+        last_(0),
+        paused_ticks_(0),
+        pause_start_(0),
+        paused_(false) {}
+
+  // Prepares the sampler for a run of `iterations` iterations.
+  void Start(IterationCount iterations);
+
+  // Records the iterations since the previous call, if any, and starts timing
+  // the next `n`. Returns false once all iterations have been run.
+  bool Next(IterationCount n);
+
+  // Stop and restart the clock of the current sample, for PauseTiming() and
+  // ResumeTiming().
+  void Pause();
+  void Resume();
+
+  const LatencyHistogram& histogram() const { return histogram_; }
+
+  // The ticks that the sampler's own bookkeeping adds to a sample, measured
+  // once per process on an empty loop.
+  static int64_t CalibratedOverhead();
+
+ private:
+  LatencyHistogram histogram_;
+  const int64_t overhead_;
+  IterationCount remaining_;
+  IterationCount pending_;
+  int64_t last_;
+  int64_t paused_ticks_;
+  int64_t pause_start_;
+  bool paused_;
+};
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_LATENCY_HISTOGRAM_H_
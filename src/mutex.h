@@ -1,10 +1,13 @@
 #ifndef BENCHMARK_MUTEX_H_
 #define BENCHMARK_MUTEX_H_
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 
 #include "check.h"
+#include "cycleclock.h"
 
 // Enable thread safety attributes only with clang.
 // The attributes can be safely erased when compiling with other compilers.
@@ -96,58 +99,108 @@ class SCOPED_CAPABILITY MutexLock {
   MutexLockImp ml_;
 };
 
+// Hints to the CPU that the thread is busy waiting.
+inline void SpinPause() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+// A barrier for the threads of a benchmark. With a non-zero `spin_cycles`,
+// waiting threads spin on the cycle clock for up to that long before they
+// block, and the last thread to arrive releases all of them on a deadline
+// shortly ahead, so that they leave the barrier together: a few cycles ahead
+// if they all spun, or `spin_cycles` ahead if some had to be woken up.
 class Barrier {
  public:
-  Barrier(int num_threads) : running_threads_(num_threads) {}
+  explicit Barrier(int num_threads, int64_t spin_cycles = 0)
+      : running_threads_(num_threads), spin_cycles_(spin_cycles) {}
 
   // Called by each thread
   bool wait() EXCLUDES(lock_) {
+    int phase = 0;
     bool last_thread = false;
     {
       MutexLock ml(lock_);
-      last_thread = createBarrier(ml);
+      BM_CHECK_LT(entered_, running_threads_);
+      phase = phase_.load(std::memory_order_relaxed);
+      last_thread = ++entered_ == running_threads_;
+      if (last_thread) Release();
+    }
+    if (last_thread) {
+      phase_condition_.notify_all();
+    } else if (!Spin(phase)) {
+      MutexLock ml(lock_);
+      if (phase_.load(std::memory_order_relaxed) == phase) {
+        ++sleepers_;
+        phase_condition_.wait(ml.native_handle(), [this, phase]() {
+          return phase_.load(std::memory_order_relaxed) != phase;
+        });
+      }
     }
-    if (last_thread) phase_condition_.notify_all();
+    WaitForDeadline();
     return last_thread;
   }
 
   void removeThread() EXCLUDES(lock_) {
-    MutexLock ml(lock_);
-    --running_threads_;
-    if (entered_ != 0) phase_condition_.notify_all();
+    bool released = false;
+    {
+      MutexLock ml(lock_);
+      --running_threads_;
+      // The threads that are waiting may now be all that is left.
+      if (entered_ != 0 && entered_ == running_threads_) {
+        Release();
+        released = true;
+      }
+    }
+    if (released) phase_condition_.notify_all();
   }
 
  private:
   Mutex lock_;
   Condition phase_condition_;
   int running_threads_;
+  const int64_t spin_cycles_;
 
   // State for barrier management
-  int phase_number_ = 0;
-  int entered_ = 0;  // Number of threads that have entered this barrier
-
-  // Enter the barrier and wait until all other threads have also
-  // entered the barrier.  Returns iff this is the last thread to
-  // enter the barrier.
-  bool createBarrier(MutexLock& ml) REQUIRES(lock_) {
-    BM_CHECK_LT(entered_, running_threads_);
-    entered_++;
-    if (entered_ < running_threads_) {
-      // Wait for all threads to enter
-      int phase_number_cp = phase_number_;
-      auto cb = [this, phase_number_cp]() {
-        return this->phase_number_ > phase_number_cp ||
-               entered_ == running_threads_;  // A thread has aborted in error
-      };
-      phase_condition_.wait(ml.native_handle(), cb);
-      if (phase_number_ > phase_number_cp) return false;
-      // else (running_threads_ == entered_) and we are the last thread.
+  std::atomic<int> phase_{0};
+  int entered_ = 0;   // Number of threads that have entered this barrier
+  int sleepers_ = 0;  // Number of those that stopped spinning and blocked
+  // Cycle clock value at which the threads of the last phase leave.
+  std::atomic<int64_t> deadline_{0};
+
+  // Ends the current phase. The deadline is published before the phase, so
+  // that a thread that sees the new phase also sees its deadline.
+  void Release() REQUIRES(lock_) {
+    if (spin_cycles_ != 0) {
+      const int64_t lead = sleepers_ != 0 ? spin_cycles_ : spin_cycles_ / 16;
+      deadline_.store(cycleclock::Now() + lead, std::memory_order_relaxed);
     }
-    // Last thread has reached the barrier
-    phase_number_++;
     entered_ = 0;
+    sleepers_ = 0;
+    phase_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Spins until `phase` ends, or returns false if it did not end in time.
+  bool Spin(int phase) {
+    if (spin_cycles_ == 0) return false;
+    const int64_t end = cycleclock::Now() + spin_cycles_;
+    while (phase_.load(std::memory_order_acquire) == phase) {
+      if (cycleclock::Now() >= end) return false;
+      SpinPause();
+    }
     return true;
   }
+
+  void WaitForDeadline() {
+    if (spin_cycles_ == 0) return;
+    const int64_t deadline = deadline_.load(std::memory_order_relaxed);
+    while (cycleclock::Now() < deadline) {
+      SpinPause();
+    }
+  }
 };
 
 }  // end namespace benchmark
@@ -0,0 +1,125 @@
+// Copyright 2025 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "parallel_jobs.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "benchmark/utils.h"
+#include "isolation.h"
+#include "timers.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+// Large enough to spill out of the private caches, so that the probe also
+// measures contention on the shared cache and memory bandwidth.
+constexpr size_t kProbeBytes = 16 << 20;
+constexpr int kProbePasses = 8;
+constexpr int kProbeRounds = 3;
+
+// Returns the best time of a few rounds of strided reads and writes over a
+// buffer, one per cache line.
+double RunProbe() {
+  std::vector<uint64_t> buffer(kProbeBytes / sizeof(uint64_t), 1);
+  constexpr size_t kStride = 64 / sizeof(uint64_t);
+  double best = std::numeric_limits<double>::max();
+  for (int round = 0; round < kProbeRounds; ++round) {
+    const double start = ChronoClockNow();
+    uint64_t sum = 0;
+    for (int pass = 0; pass < kProbePasses; ++pass) {
+      for (size_t i = 0; i < buffer.size(); i += kStride) {
+        sum = sum * 31 + buffer[i];
+        buffer[i] = sum;
+      }
+    }
+    DoNotOptimize(sum);
+    best = std::min(best, ChronoClockNow() - start);
+  }
+  return best;
+}
+
+ChildJob ProbeJob(const std::vector<int>& cpus) {
+  ChildJob job;
+  job.fn = [&cpus](int slot) {
+    ScopedThreadAffinity affinity(cpus[static_cast<size_t>(slot)]);
+    BenchmarkReporter::Run run;
+    run.real_accumulated_time = RunProbe();
+    RunResults results;
+    results.non_aggregates.push_back(run);
+    return results;
+  };
+  return job;
+}
+
+// Runs `num_jobs` probes at once and returns their average time, ignoring
+// the ones that failed.
+double RunProbes(const std::vector<int>& cpus, size_t num_jobs) {
+  const std::vector<ChildJob> jobs(num_jobs, ProbeJob(cpus));
+  double total = 0;
+  int count = 0;
+  RunInChildProcesses(
+      jobs, static_cast<int>(num_jobs), /*timeout=*/0,
+      [&](size_t /*job*/, bool ok, RunResults& results,
+          const std::string& /*error*/) {
+        if (ok && !results.non_aggregates.empty()) {
+          total += results.non_aggregates[0].real_accumulated_time;
+          ++count;
+        }
+      });
+  return count > 0 ? total / count : 0;
+}
+
+}  // end namespace
+
+std::vector<int> PlanParallelJobCpus(int jobs,
+                                     const std::vector<LogicalCpu>& topology) {
+  std::vector<int> cpus =
+      PlanThreadAffinity(kAffinityScatter, {}, topology, jobs);
+  // Scatter uses the SMT siblings once every core has a CPU; stop there.
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    const auto cpu =
+        std::find_if(topology.begin(), topology.end(),
+                     [&](const LogicalCpu& c) { return c.id == cpus[i]; });
+    if (cpu != topology.end() && cpu->smt_rank != 0) {
+      cpus.resize(i);
+      break;
+    }
+    if (std::find(cpus.begin(), cpus.begin() + static_cast<std::ptrdiff_t>(i),
+                  cpus[i]) != cpus.begin() + static_cast<std::ptrdiff_t>(i)) {
+      cpus.resize(i);
+      break;
+    }
+  }
+  return cpus;
+}
+
+double MeasureParallelSlowdown(const std::vector<int>& cpus) {
+  if (cpus.size() < 2) {
+    return 0;
+  }
+  const double solo = RunProbes(cpus, 1);
+  const double parallel = RunProbes(cpus, cpus.size());
+  if (!(solo > 0) || !(parallel > 0)) {
+    return 0;
+  }
+  return std::max(parallel / solo - 1, 0.0);
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,28 @@
+#ifndef BENCHMARK_PARALLEL_JOBS_H_
+#define BENCHMARK_PARALLEL_JOBS_H_
+
+#include <vector>
+
+#include "affinity.h"
+#include "benchmark/export.h"
+
+namespace benchmark {
+namespace internal {
+
+// Returns the CPUs the jobs of --benchmark_parallel_jobs are pinned to: the
+// first hardware thread of up to `jobs` physical cores, spread over the
+// packages. The SMT siblings of those CPUs are left idle.
+BENCHMARK_EXPORT std::vector<int> PlanParallelJobCpus(
+    int jobs, const std::vector<LogicalCpu>& topology);
+
+// Runs a fixed memory and compute bound workload in a child process pinned to
+// the first of `cpus`, and then in one child per CPU at the same time.
+// Returns how much slower the concurrent runs were on average, as a fraction
+// of the solo run.
+// REQUIRES: IsolationSupported()
+BENCHMARK_EXPORT double MeasureParallelSlowdown(const std::vector<int>& cpus);
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_PARALLEL_JOBS_H_
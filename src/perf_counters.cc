@@ -14,6 +14,8 @@
 
 #include "perf_counters.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <optional>
@@ -23,6 +25,7 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <linux/perf_event.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 #include "perfmon/pfmlib.h"
@@ -34,30 +37,146 @@ namespace internal {
 
 #if defined HAVE_LIBPFM
 
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCHMARK_HAVE_RDPMC 1
+
+namespace {
+
+inline uint64_t Rdpmc(uint32_t counter) {
+  uint32_t low, high;
+  asm volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(counter));
+  return (static_cast<uint64_t>(high) << 32) | low;
+}
+
+inline uint64_t Rdtsc() {
+  uint32_t low, high;
+  asm volatile("rdtsc" : "=a"(low), "=d"(high));
+  return (static_cast<uint64_t>(high) << 32) | low;
+}
+
+}  // namespace
+#endif
+
+bool PerfCounterValues::ReadUserSpace(const std::vector<void*>& pages,
+                                      const std::vector<size_t>& groups,
+                                      size_t enabled_group) {
+#if defined BENCHMARK_HAVE_RDPMC
+  // This follows the self-monitoring example in linux/perf_event.h.
+  const size_t n = std::min(pages.size(), kMaxCounters);
+  for (size_t i = 0; i < n; ++i) {
+    if (enabled_group != PerfCounters::kAllGroups &&
+        groups[i] != enabled_group) {
+      continue;
+    }
+    const volatile perf_event_mmap_page* pc =
+        static_cast<const volatile perf_event_mmap_page*>(pages[i]);
+    uint32_t seq;
+    uint64_t count, enabled, running;
+    uint64_t cycles = 0, time_offset = 0, time_cycles = 0, time_mask = ~0ull;
+    uint32_t time_mult = 0;
+    uint16_t time_shift = 0;
+    bool user_time = false;
+    do {
+      seq = pc->lock;
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      enabled = pc->time_enabled;
+      running = pc->time_running;
+      user_time = pc->cap_user_time;
+      if (user_time && enabled != running) {
+        cycles = Rdtsc();
+        time_offset = pc->time_offset;
+        time_mult = pc->time_mult;
+        time_shift = pc->time_shift;
+        if (pc->cap_user_time_short) {
+          time_cycles = pc->time_cycles;
+          time_mask = pc->time_mask;
+        }
+      }
+      // Not on the PMU right now, e.g. multiplexed out.
+      const uint32_t index = pc->index;
+      const uint16_t width = pc->pmc_width;
+      if (!pc->cap_user_rdpmc || index == 0 || width == 0 || width > 64) {
+        return false;
+      }
+      const uint64_t pmc = Rdpmc(index - 1) << (64 - width);
+      count = static_cast<uint64_t>(pc->offset) +
+              static_cast<uint64_t>(static_cast<int64_t>(pmc) >> (64 - width));
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+    } while (pc->lock != seq);
+
+    if (enabled != running) {
+      // The times are as of the last context switch; add the time since.
+      if (!user_time) return false;
+      if (time_cycles != 0) {
+        cycles = time_cycles + ((cycles - time_cycles) & time_mask);
+      }
+      const uint64_t quot = cycles >> time_shift;
+      const uint64_t rem = cycles & ((uint64_t{1} << time_shift) - 1);
+      const uint64_t delta =
+          time_offset + quot * time_mult + ((rem * time_mult) >> time_shift);
+      enabled += delta;
+      running += delta;
+    }
+    values_[i] = count;
+    time_enabled_[i] = enabled;
+    time_running_[i] = running;
+  }
+  return true;
+#else
+  (void)pages;
+  (void)groups;
+  (void)enabled_group;
+  return false;
+#endif
+}
+
+// Maps the perf_event page of each counter, through which it can be read
+// with rdpmc. The pages are only useful if all counters have one.
+static std::vector<void*> MapUserPages(const std::vector<int>& counter_ids) {
+  std::vector<void*> pages;
+#if defined BENCHMARK_HAVE_RDPMC
+  const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  for (int fd : counter_ids) {
+    void* page = mmap(nullptr, page_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (page == MAP_FAILED) {
+      for (void* p : pages) {
+        munmap(p, page_size);
+      }
+      return {};
+    }
+    pages.push_back(page);
+  }
+#else
+  (void)counter_ids;
+#endif
+  return pages;
+}
+
 size_t PerfCounterValues::Read(const std::vector<int>& leaders) {
-  // Create a pointer for multiple reads
-  const size_t bufsize = values_.size() * sizeof(values_[0]);
-  char* ptr = reinterpret_cast<char*>(values_.data());
-  size_t size = bufsize;
+  // A group read returns the number of counters in the group, the times the
+  // group was enabled and running, and then the value of each counter.
+  static constexpr size_t kHeader = 3;
+  std::array<uint64_t, kHeader + kMaxCounters> buffer;
+  size_t pos = 0;
   for (int lead : leaders) {
-    auto read_bytes = ::read(lead, ptr, size);
-    if (read_bytes >= ssize_t(sizeof(uint64_t))) {
-      // Actual data bytes are all bytes minus initial padding
-      std::size_t data_bytes =
-          static_cast<std::size_t>(read_bytes) - sizeof(uint64_t);
-      // This should be very cheap since it's in hot cache
-      std::memmove(ptr, ptr + sizeof(uint64_t), data_bytes);
-      // Increment our counters
-      ptr += data_bytes;
-      size -= data_bytes;
-    } else {
+    auto read_bytes = ::read(lead, buffer.data(), sizeof(buffer));
+    if (read_bytes < ssize_t(kHeader * sizeof(uint64_t))) {
       int err = errno;
       GetErrorLogInstance() << "Error reading lead " << lead << " errno:" << err
                             << " " << ::strerror(err) << "\n";
       return 0;
     }
+    const size_t nr = std::min<size_t>(
+        {static_cast<size_t>(buffer[0]),
+         static_cast<size_t>(read_bytes) / sizeof(uint64_t) - kHeader,
+         kMaxCounters - pos});
+    for (size_t i = 0; i < nr; ++i, ++pos) {
+      values_[pos] = buffer[kHeader + i];
+      time_enabled_[pos] = buffer[1];
+      time_running_[pos] = buffer[2];
+    }
   }
-  return (bufsize - size) / sizeof(uint64_t);
+  return pos;
 }
 
 const bool PerfCounters::kSupported = true;
@@ -144,6 +263,7 @@ PerfCounters PerfCounters::Create(
   std::vector<std::string> valid_names;
   std::vector<int> counter_ids;
   std::vector<int> leader_ids;
+  std::vector<size_t> counter_groups;
 
   // Resize to the maximum possible
   valid_names.reserve(counter_names.size());
@@ -202,16 +322,20 @@ PerfCounters PerfCounters::Create(
     // Note: the man page for perf_event_create suggests inherit = true and
     // read_format = PERF_FORMAT_GROUP don't work together, but that's not the
     // case.
+    // Groups are not pinned: a pinned group that does not fit on the PMU
+    // stops counting altogether, while unpinned groups are multiplexed and
+    // their counts scaled on read.
     attr.disabled = is_first;
     attr.inherit = true;
-    attr.pinned = is_first;
+    attr.pinned = false;
     attr.exclude_kernel = true;
     attr.exclude_user = false;
     attr.exclude_hv = true;
 
-    // Read all counters in a group in one read.
-    attr.read_format = PERF_FORMAT_GROUP;  //| PERF_FORMAT_TOTAL_TIME_ENABLED |
-                                           // PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // Read all counters in a group in one read, along with the times needed
+    // to scale the counts if the group gets multiplexed.
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
 
     uint64_t base_config = attr.config;
     for (uint64_t pmu : GetPMUTypesForEvent(attr)) {
@@ -259,6 +383,7 @@ PerfCounters PerfCounters::Create(
       }
       // This is a valid counter, add it to our descriptor's list
       counter_ids.push_back(id);
+      counter_groups.push_back(leader_ids.size() - 1);
       valid_names.push_back(name);
     }
   }
@@ -286,14 +411,39 @@ PerfCounters PerfCounters::Create(
     }
   }
 
+  std::vector<void*> user_pages = MapUserPages(counter_ids);
   return PerfCounters(std::move(valid_names), std::move(counter_ids),
-                      std::move(leader_ids));
+                      std::move(leader_ids), std::move(counter_groups),
+                      std::move(user_pages));
+}
+
+bool PerfCounters::EnableGroups(size_t group) {
+  bool ok = true;
+  for (size_t i = 0; i < leader_ids_.size(); ++i) {
+    const bool enable = group == kAllGroups || group == i;
+    ok &= ioctl(leader_ids_[i], enable ? PERF_EVENT_IOC_ENABLE
+                                       : PERF_EVENT_IOC_DISABLE) == 0;
+  }
+  enabled_group_ = group;
+  return ok;
+}
+
+void PerfCounters::DisableUserSpaceReads() {
+  const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  for (void* page : user_pages_) {
+    munmap(page, page_size);
+  }
+  user_pages_.clear();
 }
 
 void PerfCounters::CloseCounters() const {
   if (counter_ids_.empty()) {
     return;
   }
+  const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  for (void* page : user_pages_) {
+    munmap(page, page_size);
+  }
   for (int lead : leader_ids_) {
     ioctl(lead, PERF_EVENT_IOC_DISABLE);
   }
@@ -304,6 +454,11 @@ void PerfCounters::CloseCounters() const {
 #else   // defined HAVE_LIBPFM
 size_t PerfCounterValues::Read(const std::vector<int>&) { return 0; }
 
+bool PerfCounterValues::ReadUserSpace(const std::vector<void*>&,
+                                      const std::vector<size_t>&, size_t) {
+  return false;
+}
+
 const bool PerfCounters::kSupported = false;
 
 bool PerfCounters::Initialize() { return false; }
@@ -318,13 +473,57 @@ PerfCounters PerfCounters::Create(
   return NoCounters();
 }
 
+bool PerfCounters::EnableGroups(size_t) { return false; }
+
+void PerfCounters::DisableUserSpaceReads() {}
+
 void PerfCounters::CloseCounters() const {}
 #endif  // defined HAVE_LIBPFM
 
 PerfCountersMeasurement::PerfCountersMeasurement(
     const std::vector<std::string>& counter_names)
     : start_values_(counter_names.size()), end_values_(counter_names.size()) {
+  counters_ =
+      PerfCounters::Create(ExpandPerfCounterPresets(counter_names, &presets_));
+}
+
+void PerfCountersMeasurement::Reopen() {
+  const std::vector<std::string> counter_names = counters_.names();
   counters_ = PerfCounters::Create(counter_names);
+  active_group_ = PerfCounters::kAllGroups;
+}
+
+void PerfCountersMeasurement::RotateGroups(size_t repetition) {
+  if (num_groups() < 2) return;
+  const size_t group = repetition % num_groups();
+  if (group == active_group_) return;
+  if (!counters_.EnableGroups(group)) {
+    GetErrorLogInstance() << "***WARNING*** Failed to rotate performance "
+                             "counter groups. Counting all of them.\n";
+    counters_.EnableGroups(PerfCounters::kAllGroups);
+    active_group_ = PerfCounters::kAllGroups;
+    return;
+  }
+  active_group_ = group;
+}
+
+void PerfCountersMeasurement::WarnUserSpaceReadFailed() {
+  static std::atomic<bool> warned{false};
+  if (!warned.exchange(true)) {
+    GetErrorLogInstance() << "***WARNING*** Failed to read performance "
+                             "counters with rdpmc. The counts of such "
+                             "measurements are dropped.\n";
+  }
+}
+
+void PerfCountersMeasurement::SuspendCounting() {
+  if (num_groups() == 0) return;
+  counters_.EnableGroups(PerfCounters::kNoGroups);
+}
+
+void PerfCountersMeasurement::ResumeCounting() {
+  if (num_groups() == 0) return;
+  counters_.EnableGroups(active_group_);
 }
 
 PerfCounters& PerfCounters::operator=(PerfCounters&& other) noexcept {
@@ -333,6 +532,10 @@ PerfCounters& PerfCounters::operator=(PerfCounters&& other) noexcept {
 
     counter_ids_ = std::move(other.counter_ids_);
     leader_ids_ = std::move(other.leader_ids_);
+    counter_groups_ = std::move(other.counter_groups_);
+    user_pages_ = std::move(other.user_pages_);
+    owner_ = other.owner_;
+    enabled_group_ = other.enabled_group_;
     counter_names_ = std::move(other.counter_names_);
   }
   return *this;
@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include "benchmark/export.h"
@@ -28,6 +29,7 @@
 #include "check.h"
 #include "log.h"
 #include "mutex.h"
+#include "perf_presets.h"
 
 #ifndef BENCHMARK_OS_WINDOWS
 #include <unistd.h>
@@ -42,46 +44,50 @@
 namespace benchmark {
 namespace internal {
 
-// Typically, we can only read a small number of counters. There is also a
-// padding preceding counter values, when reading multiple counters with one
-// syscall (which is desirable). PerfCounterValues abstracts these details.
-// The implementation ensures the storage is inlined, and allows 0-based
-// indexing into the counter values.
+// Typically, we can only read a small number of counters. Counters are opened
+// in groups, each read with one syscall (which is desirable), and when there
+// are more groups than the PMU can hold at once the kernel multiplexes them.
+// PerfCounterValues abstracts these details: the Read() method unpacks the
+// group reads such that all user accesses through the [] operator are
+// correct, and keeps the time each counter's group was enabled and actually
+// running on the PMU, which is what multiplexed counts are scaled by.
 // The object is used in conjunction with a PerfCounters object, by passing it
-// to Snapshot(). The Read() method relocates individual reads, discarding
-// the initial padding from each group leader in the values buffer such that
-// all user accesses through the [] operator are correct.
+// to Snapshot().
 class BENCHMARK_EXPORT PerfCounterValues {
  public:
   explicit PerfCounterValues(size_t nr_counters) : nr_counters_(nr_counters) {
     BM_CHECK_LE(nr_counters_, kMaxCounters);
   }
 
-  // We are reading correctly now so the values don't need to skip padding
+  // The raw value of counter `pos`, not scaled for multiplexing.
   uint64_t operator[](size_t pos) const { return values_[pos]; }
 
+  // Nanoseconds the group of counter `pos` was enabled, respectively
+  // scheduled on the PMU. The two differ iff the counter was multiplexed.
+  uint64_t time_enabled(size_t pos) const { return time_enabled_[pos]; }
+  uint64_t time_running(size_t pos) const { return time_running_[pos]; }
+
   // Increased the maximum to 32 only since the buffer
   // is std::array<> backed
   static constexpr size_t kMaxCounters = 32;
 
  private:
   friend class PerfCounters;
-  // Get the byte buffer in which perf counters can be captured.
-  // This is used by PerfCounters::Read
-  std::pair<char*, size_t> get_data_buffer() {
-    return {reinterpret_cast<char*>(values_.data()),
-            sizeof(uint64_t) * (kPadding + nr_counters_)};
-  }
 
   // This reading is complex and as the goal of this class is to
   // abstract away the intrincacies of the reading process, this is
   // a better place for it
   size_t Read(const std::vector<int>& leaders);
 
-  // Move the padding to 2 due to the reading algorithm (1st padding plus a
-  // current read padding)
-  static constexpr size_t kPadding = 2;
-  std::array<uint64_t, kPadding + kMaxCounters> values_;
+  // Reads each counter of the enabled group(s) from its mmap'd perf_event
+  // page with rdpmc, without a syscall. Returns false, leaving the values
+  // unspecified, if any of them cannot be read that way right now.
+  bool ReadUserSpace(const std::vector<void*>& pages,
+                     const std::vector<size_t>& groups, size_t enabled_group);
+
+  std::array<uint64_t, kMaxCounters> values_;
+  std::array<uint64_t, kMaxCounters> time_enabled_;
+  std::array<uint64_t, kMaxCounters> time_running_;
   const size_t nr_counters_;
 };
 
@@ -122,6 +128,36 @@ class BENCHMARK_EXPORT PerfCounters final {
   // valid PerfCounterValues storage. The values are populated such that:
   // names()[i]'s value is (*values)[i]
   BENCHMARK_ALWAYS_INLINE bool Snapshot(PerfCounterValues* values) const {
+    return (CanReadUserSpace() && SnapshotUserSpace(values)) ||
+           SnapshotSyscall(values);
+  }
+
+  // Whether the calling thread can take snapshots with SnapshotUserSpace().
+  // rdpmc reads the PMU of the CPU we run on, which only holds our counters
+  // if we are the thread they were opened for. Several groups counting at
+  // once are multiplexed, and often not on the PMU, so they use read().
+  bool CanReadUserSpace() const {
+    return !user_pages_.empty() && std::this_thread::get_id() == owner_ &&
+           (enabled_group_ != kAllGroups || leader_ids_.size() == 1);
+  }
+
+  // Snapshot() with rdpmc only, which fails while a counter is multiplexed
+  // out, and with read() only. read() also counts the threads started by the
+  // thread the counters were opened for and rdpmc does not, so the two
+  // snapshots of a measurement must be taken the same way.
+  BENCHMARK_ALWAYS_INLINE bool SnapshotUserSpace(
+      PerfCounterValues* values) const {
+#ifndef BENCHMARK_OS_WINDOWS
+    assert(values != nullptr);
+    return values->ReadUserSpace(user_pages_, counter_groups_,
+                                 enabled_group_);
+#else
+    (void)values;
+    return false;
+#endif
+  }
+  BENCHMARK_ALWAYS_INLINE bool SnapshotSyscall(
+      PerfCounterValues* values) const {
 #ifndef BENCHMARK_OS_WINDOWS
     assert(values != nullptr);
     return values->Read(leader_ids_) == counter_ids_.size();
@@ -134,18 +170,47 @@ class BENCHMARK_EXPORT PerfCounters final {
   const std::vector<std::string>& names() const { return counter_names_; }
   size_t num_counters() const { return counter_names_.size(); }
 
+  // Whether Snapshot() can read the counters from user space with rdpmc
+  // rather than with a read() syscall. Counters opened for another thread,
+  // and threads started by that thread, are still read with read().
+  bool user_space_reads() const { return !user_pages_.empty(); }
+  // Makes Snapshot() always use read(), e.g. to compare the two.
+  void DisableUserSpaceReads();
+
+  // Counters are opened in as many groups as needed to fit them on the PMU.
+  // group(i) is the group names()[i] belongs to.
+  size_t num_groups() const { return leader_ids_.size(); }
+  size_t group(size_t pos) const { return counter_groups_[pos]; }
+
+  // Enables only the given group, or all of them if `group` is kAllGroups,
+  // or none if it is kNoGroups, and disables the others. Returns false if the
+  // kernel refused.
+  static constexpr size_t kAllGroups = static_cast<size_t>(-1);
+  static constexpr size_t kNoGroups = static_cast<size_t>(-2);
+  bool EnableGroups(size_t group);
+
  private:
   PerfCounters(const std::vector<std::string>& counter_names,
-               std::vector<int>&& counter_ids, std::vector<int>&& leader_ids)
+               std::vector<int>&& counter_ids, std::vector<int>&& leader_ids,
+               std::vector<size_t>&& counter_groups,
+               std::vector<void*>&& user_pages)
       : counter_ids_(std::move(counter_ids)),
         leader_ids_(std::move(leader_ids)),
-        counter_names_(counter_names) {}
+        counter_groups_(std::move(counter_groups)),
+        counter_names_(counter_names),
+        user_pages_(std::move(user_pages)),
+        owner_(std::this_thread::get_id()) {}
 
   void CloseCounters() const;
 
   std::vector<int> counter_ids_;
   std::vector<int> leader_ids_;
+  std::vector<size_t> counter_groups_;
   std::vector<std::string> counter_names_;
+  // The perf_event mmap page of each counter, if all of them allow rdpmc.
+  std::vector<void*> user_pages_;
+  std::thread::id owner_;
+  size_t enabled_group_ = kAllGroups;
 };
 
 // Typical usage of the above primitives.
@@ -157,12 +222,66 @@ class BENCHMARK_EXPORT PerfCountersMeasurement final {
 
   const std::vector<std::string>& names() const { return counters_.names(); }
 
+  size_t num_groups() const { return counters_.num_groups(); }
+
+  // Adds the metrics of the `@<preset>` entries of the counter names that can
+  // be derived from `counters`.
+  void AddDerivedMetrics(UserCounters* counters) const {
+    AddPerfCounterMetrics(presets_, counters);
+  }
+
+  // Opens the counters again for the calling thread, e.g. in a forked child
+  // whose inherited counters still measure its parent.
+  void Reopen();
+
+  // Counts only the group of counters whose turn it is in the given
+  // repetition, so that each group has the PMU to itself instead of being
+  // multiplexed with the others. Counters of the other groups are not
+  // measured until RotateGroups() is called for one of their repetitions.
+  void RotateGroups(size_t repetition);
+
+  // Stops counting until ResumeCounting(), e.g. while every thread of a
+  // benchmark counts with counters of its own. This also stops the copies of
+  // the counters that threads started by this one inherited.
+  void SuspendCounting();
+  void ResumeCounting();
+
+  // Logs, once per process, that a measurement started with rdpmc could not
+  // be finished with it and was dropped.
+  static void WarnUserSpaceReadFailed();
+
+  // Whether names()[pos] is currently being counted.
+  bool IsMeasured(size_t pos) const {
+    return active_group_ == PerfCounters::kAllGroups ||
+           counters_.group(pos) == active_group_;
+  }
+
+  // The fraction of the time names()[pos] was enabled since the last call to
+  // ResetRunningFraction() that it was actually running on the PMU. Values
+  // below 1 mean the counter was multiplexed and its measurements are
+  // extrapolated from the time it ran.
+  double running_fraction(size_t pos) const {
+    if (enabled_[pos] == 0) return 1.0;
+    return static_cast<double>(running_[pos]) /
+           static_cast<double>(enabled_[pos]);
+  }
+  void ResetRunningFraction() {
+    enabled_.fill(0);
+    running_.fill(0);
+  }
+
   BENCHMARK_ALWAYS_INLINE bool Start() {
     if (num_counters() == 0) return true;
     // Tell the compiler to not move instructions above/below where we take
     // the snapshot.
     ClobberMemory();
-    valid_read_ &= counters_.Snapshot(&start_values_);
+    // The end snapshot is taken the same way as the start one; rdpmc is only
+    // given up on for the whole measurement.
+    user_space_read_ = counters_.CanReadUserSpace() &&
+                       counters_.SnapshotUserSpace(&start_values_);
+    if (!user_space_read_) {
+      valid_read_ &= counters_.SnapshotSyscall(&start_values_);
+    }
     ClobberMemory();
 
     return valid_read_;
@@ -174,12 +293,38 @@ class BENCHMARK_EXPORT PerfCountersMeasurement final {
     // Tell the compiler to not move instructions above/below where we take
     // the snapshot.
     ClobberMemory();
-    valid_read_ &= counters_.Snapshot(&end_values_);
+    const bool end_read = user_space_read_
+                              ? counters_.SnapshotUserSpace(&end_values_)
+                              : counters_.SnapshotSyscall(&end_values_);
     ClobberMemory();
+    if (!end_read) {
+      // rdpmc can stop working mid-measurement, e.g. once a counter is
+      // multiplexed out. The start values cannot be compared with read(), so
+      // only this measurement is lost.
+      if (user_space_read_) {
+        WarnUserSpaceReadFailed();
+        return valid_read_;
+      }
+      valid_read_ = false;
+      return false;
+    }
 
     for (size_t i = 0; i < counters_.names().size(); ++i) {
+      if (!IsMeasured(i)) continue;
       double measurement = static_cast<double>(end_values_[i]) -
                            static_cast<double>(start_values_[i]);
+      const uint64_t enabled =
+          end_values_.time_enabled(i) - start_values_.time_enabled(i);
+      const uint64_t running =
+          end_values_.time_running(i) - start_values_.time_running(i);
+      // Extrapolate multiplexed counts to the whole time the group was
+      // enabled, as perf-stat does.
+      if (running > 0 && running < enabled) {
+        measurement *=
+            static_cast<double>(enabled) / static_cast<double>(running);
+      }
+      enabled_[i] += enabled;
+      running_[i] += running;
       measurements.push_back({counters_.names()[i], measurement});
     }
 
@@ -187,10 +332,15 @@ class BENCHMARK_EXPORT PerfCountersMeasurement final {
   }
 
  private:
+  std::vector<const PerfCounterPresetVariant*> presets_;
   PerfCounters counters_;
   bool valid_read_ = true;
+  bool user_space_read_ = false;
+  size_t active_group_ = PerfCounters::kAllGroups;
   PerfCounterValues start_values_;
   PerfCounterValues end_values_;
+  std::array<uint64_t, PerfCounterValues::kMaxCounters> enabled_{};
+  std::array<uint64_t, PerfCounterValues::kMaxCounters> running_{};
 };
 
 }  // namespace internal
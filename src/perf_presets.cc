@@ -0,0 +1,186 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "perf_presets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "log.h"
+#include "perf_counters.h"
+
+namespace benchmark {
+namespace internal {
+
+namespace {
+
+// Intel cores from Sandy Bridge to Skylake issue up to four uops a cycle.
+// Level 1 of Yasin's top-down analysis splits these issue slots into the
+// four categories below.
+constexpr double kIntelSlotsPerCycle = 4;
+
+// Every preset that counts cycles lists them first, then instructions.
+double Ipc(const std::vector<double>& v) { return v[1] / v[0]; }
+
+double IntelSlots(const std::vector<double>& v) {
+  return kIntelSlotsPerCycle * v[0];
+}
+double IntelFrontendBound(const std::vector<double>& v) {
+  return v[2] / IntelSlots(v);
+}
+double IntelBadSpeculation(const std::vector<double>& v) {
+  return (v[3] - v[4] + kIntelSlotsPerCycle * v[5]) / IntelSlots(v);
+}
+double IntelRetiring(const std::vector<double>& v) {
+  return v[4] / IntelSlots(v);
+}
+
+}  // namespace
+
+const std::vector<PerfCounterPreset>& GetPerfCounterPresets() {
+  static const std::vector<PerfCounterPreset>* const presets =
+      new std::vector<PerfCounterPreset>{
+          {"topdown",
+           {
+               {{"CYCLES", "INSTRUCTIONS", "IDQ_UOPS_NOT_DELIVERED:CORE",
+                 "UOPS_ISSUED:ANY", "UOPS_RETIRED:RETIRE_SLOTS",
+                 "INT_MISC:RECOVERY_CYCLES"},
+                {{"ipc", &Ipc},
+                 {"frontend_bound", &IntelFrontendBound},
+                 {"bad_speculation", &IntelBadSpeculation},
+                 {"retiring", &IntelRetiring},
+                 {"backend_bound",
+                  [](const std::vector<double>& v) {
+                    return 1 - IntelFrontendBound(v) - IntelBadSpeculation(v) -
+                           IntelRetiring(v);
+                  }}}},
+               // Elsewhere, only the kernel's generic stall events give an
+               // approximation of the frontend and backend bound fractions.
+               {{"CYCLES", "INSTRUCTIONS",
+                 "PERF_COUNT_HW_STALLED_CYCLES_FRONTEND",
+                 "PERF_COUNT_HW_STALLED_CYCLES_BACKEND"},
+                {{"ipc", &Ipc},
+                 {"frontend_bound",
+                  [](const std::vector<double>& v) { return v[2] / v[0]; }},
+                 {"backend_bound",
+                  [](const std::vector<double>& v) { return v[3] / v[0]; }}}},
+           }},
+          {"memory",
+           {
+               {{"INSTRUCTIONS", "PERF_COUNT_HW_CACHE_L1D:READ:ACCESS",
+                 "PERF_COUNT_HW_CACHE_L1D:READ:MISS",
+                 "PERF_COUNT_HW_CACHE_LL:READ:ACCESS",
+                 "PERF_COUNT_HW_CACHE_LL:READ:MISS"},
+                {{"l1d_miss_rate",
+                  [](const std::vector<double>& v) { return v[2] / v[1]; }},
+                 {"l1d_mpki",
+                  [](const std::vector<double>& v) {
+                    return 1000 * v[2] / v[0];
+                  }},
+                 {"llc_miss_rate",
+                  [](const std::vector<double>& v) { return v[4] / v[3]; }},
+                 {"llc_mpki",
+                  [](const std::vector<double>& v) {
+                    return 1000 * v[4] / v[0];
+                  }}}},
+           }},
+          {"branch",
+           {
+               {{"INSTRUCTIONS", "PERF_COUNT_HW_BRANCH_INSTRUCTIONS",
+                 "PERF_COUNT_HW_BRANCH_MISSES"},
+                {{"branch_miss_rate",
+                  [](const std::vector<double>& v) { return v[2] / v[1]; }},
+                 {"branch_mpki",
+                  [](const std::vector<double>& v) {
+                    return 1000 * v[2] / v[0];
+                  }}}},
+           }},
+      };
+  return *presets;
+}
+
+std::vector<std::string> ExpandPerfCounterPresets(
+    const std::vector<std::string>& names,
+    std::vector<const PerfCounterPresetVariant*>* presets,
+    bool (*is_supported)(const std::string& event)) {
+  std::vector<std::string> events;
+  const auto add = [&events](const std::string& event) {
+    if (std::find(events.begin(), events.end(), event) == events.end()) {
+      events.push_back(event);
+    }
+  };
+  for (const std::string& name : names) {
+    if (name.empty() || name[0] != '@') {
+      add(name);
+      continue;
+    }
+    const std::vector<PerfCounterPreset>& all = GetPerfCounterPresets();
+    const auto preset =
+        std::find_if(all.begin(), all.end(), [&](const PerfCounterPreset& p) {
+          return name.compare(1, std::string::npos, p.name) == 0;
+        });
+    if (preset == all.end()) {
+      GetErrorLogInstance()
+          << "Unknown performance counter preset: " << name << "\n";
+      continue;
+    }
+    const auto variant = std::find_if(
+        preset->variants.begin(), preset->variants.end(),
+        [is_supported](const PerfCounterPresetVariant& v) {
+          return std::all_of(v.events.begin(), v.events.end(), is_supported);
+        });
+    if (variant == preset->variants.end()) {
+      GetErrorLogInstance() << "Performance counter preset " << name
+                            << " is not supported on this CPU\n";
+      continue;
+    }
+    for (const std::string& event : variant->events) {
+      add(event);
+    }
+    presets->push_back(&*variant);
+  }
+  return events;
+}
+
+std::vector<std::string> ExpandPerfCounterPresets(
+    const std::vector<std::string>& names,
+    std::vector<const PerfCounterPresetVariant*>* presets) {
+  return ExpandPerfCounterPresets(names, presets,
+                                  &PerfCounters::IsCounterSupported);
+}
+
+void AddPerfCounterMetrics(
+    const std::vector<const PerfCounterPresetVariant*>& presets,
+    UserCounters* counters) {
+  std::vector<double> values;
+  for (const PerfCounterPresetVariant* preset : presets) {
+    values.clear();
+    for (const std::string& event : preset->events) {
+      auto it = counters->find(event);
+      values.push_back(it != counters->end()
+                           ? it->second.value
+                           : std::numeric_limits<double>::quiet_NaN());
+    }
+    for (const PerfCounterMetric& metric : preset->metrics) {
+      const double value = metric.compute(values);
+      if (std::isfinite(value) && counters->count(metric.name) == 0) {
+        (*counters)[metric.name] = Counter(value);
+      }
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,59 @@
+#ifndef BENCHMARK_PERF_PRESETS_H_
+#define BENCHMARK_PERF_PRESETS_H_
+
+#include <string>
+#include <vector>
+
+#include "benchmark/counter.h"
+#include "benchmark/export.h"
+
+namespace benchmark {
+namespace internal {
+
+// A metric derived from the values of the events of a preset, given in the
+// order the events are listed. Events that were not counted are NaN, and a
+// metric that is not finite, e.g. because of a zero denominator, is dropped.
+struct PerfCounterMetric {
+  const char* name;
+  double (*compute)(const std::vector<double>& values);
+};
+
+// The events a preset counts on one kind of CPU, and what is derived from
+// them.
+struct PerfCounterPresetVariant {
+  std::vector<std::string> events;
+  std::vector<PerfCounterMetric> metrics;
+};
+
+// A named set of perf counters, e.g. `@topdown`, with a variant per kind of
+// CPU, in order of preference. The first variant whose events are all known
+// on the running CPU is used.
+struct PerfCounterPreset {
+  const char* name;
+  std::vector<PerfCounterPresetVariant> variants;
+};
+
+BENCHMARK_EXPORT const std::vector<PerfCounterPreset>& GetPerfCounterPresets();
+
+// Replaces the `@<preset>` entries of a --benchmark_perf_counters list by the
+// events of the variant of the preset supported by this CPU, dropping
+// duplicate events. The chosen variants are appended to `presets`. Unknown
+// or unsupported presets are dropped with an error message.
+BENCHMARK_EXPORT std::vector<std::string> ExpandPerfCounterPresets(
+    const std::vector<std::string>& names,
+    std::vector<const PerfCounterPresetVariant*>* presets,
+    bool (*is_supported)(const std::string& event));
+BENCHMARK_EXPORT std::vector<std::string> ExpandPerfCounterPresets(
+    const std::vector<std::string>& names,
+    std::vector<const PerfCounterPresetVariant*>* presets);
+
+// Adds the metrics of `presets` that can be derived from `counters`, which
+// are left as they are if they already have a counter of that name.
+BENCHMARK_EXPORT void AddPerfCounterMetrics(
+    const std::vector<const PerfCounterPresetVariant*>& presets,
+    UserCounters* counters);
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_PERF_PRESETS_H_
@@ -14,8 +14,10 @@
 
 #include "benchmark/reporter.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <string>
 #include <tuple>
@@ -86,6 +88,15 @@ void BenchmarkReporter::PrintBasicContext(std::ostream* out,
     }
   }
 
+  const TimerOverhead& overhead = context.timer_overhead;
+  if (overhead.subtracted) {
+    Out << "***NOTE*** Timer overhead is subtracted from the results ("
+        << StrFormat("%.2f", overhead.empty_loop * 1e9)
+        << " ns per iteration, "
+        << StrFormat("%.2f", overhead.pause_resume * 1e9)
+        << " ns per PauseTiming/ResumeTiming).\n";
+  }
+
   if (CPUInfo::Scaling::ENABLED == info.scaling) {
     Out << "***WARNING*** CPU scaling is enabled, the benchmark "
            "real time measurements may be noisy and will incur extra "
@@ -134,6 +145,44 @@ double BenchmarkReporter::Run::GetAdjustedCPUTime() const {
   return new_time;
 }
 
+BenchmarkReporter::Run::ThreadImbalance
+BenchmarkReporter::Run::GetThreadImbalance() const {
+  ThreadImbalance imbalance;
+  const double multiplier = GetTimeUnitMultiplier(time_unit);
+  double min_time = std::numeric_limits<double>::max();
+  double max_time = 0;
+  double total_time = 0;
+  double total_wait = 0;
+  int num_threads = 0;
+  for (const ThreadResult& t : per_thread) {
+    imbalance.start_skew =
+        std::max(imbalance.start_skew, t.start_delay * multiplier);
+    // The wait happens once, at the end of the run, so it is a total.
+    total_wait += t.barrier_wait_time * multiplier;
+    if (t.iterations == 0) {
+      continue;
+    }
+    const double iters = static_cast<double>(t.iterations);
+    const double time = t.real_accumulated_time * multiplier / iters;
+    min_time = std::min(min_time, time);
+    max_time = std::max(max_time, time);
+    total_time += time;
+    ++num_threads;
+  }
+  if (!per_thread.empty()) {
+    imbalance.barrier_wait_time =
+        total_wait / static_cast<double>(per_thread.size());
+  }
+  if (num_threads == 0) {
+    return imbalance;
+  }
+  if (min_time > 0) {
+    imbalance.max_min_ratio = max_time / min_time;
+  }
+  imbalance.straggler_time = max_time - total_time / num_threads;
+  return imbalance;
+}
+
 void BenchmarkReporter::List(
     const std::vector<internal::BenchmarkInstance>& benchmarks) {
   std::ostream& out = GetOutputStream();
@@ -0,0 +1,328 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sampling_profiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "internal_macros.h"
+#include "log.h"
+
+#ifdef BENCHMARK_OS_LINUX
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <linux/perf_event.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#endif
+
+namespace benchmark {
+namespace internal {
+
+SamplingProfiler* sampling_profiler = nullptr;
+
+bool ParseProfileCallchain(const std::string& value,
+                           ProfileCallchain* callchain) {
+  if (value == "none") {
+    *callchain = PC_None;
+  } else if (value == "fp") {
+    *callchain = PC_FramePointer;
+  } else if (value == "lbr") {
+    *callchain = PC_LBR;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string ProfileFileName(const std::string& run_name) {
+  std::string name = run_name;
+  for (char& c : name) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' &&
+        c != '_' && c != '.' && c != '=') {
+      c = '_';
+    }
+  }
+  return name + ".folded";
+}
+
+#ifdef BENCHMARK_OS_LINUX
+
+namespace {
+
+constexpr uint64_t kSampleFrequency = 4000;
+// Data pages of the ring buffer, a power of two. It is drained while the
+// benchmark runs, once it is half full or every kDrainIntervalMs.
+constexpr size_t kRingPages = 256;
+constexpr int kDrainIntervalMs = 10;
+constexpr uint16_t kMaxStackDepth = 127;
+
+size_t PageSize() { return static_cast<size_t>(sysconf(_SC_PAGESIZE)); }
+
+int OpenSampler(ProfileCallchain callchain) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_CPU_CYCLES;
+  attr.freq = 1;
+  attr.sample_freq = kSampleFrequency;
+  attr.sample_type = PERF_SAMPLE_IP;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.watermark = 1;
+  attr.wakeup_watermark = static_cast<uint32_t>(kRingPages * PageSize() / 2);
+  if (callchain == PC_FramePointer) {
+    attr.sample_type |= PERF_SAMPLE_CALLCHAIN;
+    attr.exclude_callchain_kernel = 1;
+    attr.sample_max_stack = kMaxStackDepth;
+  } else if (callchain == PC_LBR) {
+    attr.sample_type |= PERF_SAMPLE_BRANCH_STACK;
+    attr.branch_sample_type =
+        PERF_SAMPLE_BRANCH_USER | PERF_SAMPLE_BRANCH_CALL_STACK;
+  }
+  int fd = static_cast<int>(
+      syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+  if (fd < 0 && callchain != PC_LBR) {
+    // There may be no PMU, e.g. in a virtual machine.
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_CPU_CLOCK;
+    fd = static_cast<int>(
+        syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+  }
+  return fd;
+}
+
+// Copies `size` bytes at `offset` out of the ring buffer `data`, which holds
+// `data_size` bytes and wraps around.
+void CopyFromRing(const char* data, uint64_t data_size, uint64_t offset,
+                  void* out, size_t size) {
+  const size_t start = static_cast<size_t>(offset % data_size);
+  const size_t first = std::min(size, static_cast<size_t>(data_size) - start);
+  std::memcpy(out, data + start, first);
+  std::memcpy(static_cast<char*>(out) + first, data, size - first);
+}
+
+std::string Hex(uint64_t value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "0x%llx",
+                static_cast<unsigned long long>(value));
+  return buffer;
+}
+
+std::string Symbolize(uint64_t address) {
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void*>(address), &info) == 0 ||
+      info.dli_fname == nullptr) {
+    return Hex(address);
+  }
+  std::string name;
+  if (info.dli_sname != nullptr) {
+    int status = 0;
+    char* demangled =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    name = status == 0 ? demangled : info.dli_sname;
+    std::free(demangled);
+  } else {
+    const char* module = std::strrchr(info.dli_fname, '/');
+    name = std::string(module != nullptr ? module + 1 : info.dli_fname) + "+" +
+           Hex(address - reinterpret_cast<uint64_t>(info.dli_fbase));
+  }
+  // ';' separates the frames of a collapsed stack.
+  std::replace(name.begin(), name.end(), ';', ':');
+  return name;
+}
+
+}  // namespace
+
+SamplingProfiler::SamplingProfiler(ProfileCallchain callchain)
+    : callchain_(callchain) {}
+
+SamplingProfiler::~SamplingProfiler() { BeforeTeardownStop(); }
+
+bool SamplingProfiler::IsSupported() {
+  const int fd = OpenSampler(PC_None);
+  if (fd < 0) return false;
+  close(fd);
+  return true;
+}
+
+void SamplingProfiler::AfterSetupStart() {
+  if (fd_ >= 0) return;
+  fd_ = OpenSampler(callchain_);
+  if (fd_ < 0) {
+    const int err = errno;
+    if (!warned_) {
+      warned_ = true;
+      GetErrorLogInstance()
+          << "***WARNING*** Failed to start the sampling profiler: "
+          << std::strerror(err)
+          << ". See /proc/sys/kernel/perf_event_paranoid.\n";
+    }
+    return;
+  }
+  ring_size_ = (1 + kRingPages) * PageSize();
+  ring_ = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (ring_ == MAP_FAILED) {
+    ring_ = nullptr;
+    close(fd_);
+    fd_ = -1;
+    return;
+  }
+  // The reader is started after the event was opened, so it is not sampled.
+  stop_ = false;
+  reader_ = std::thread([this] {
+    pollfd pfd{fd_, POLLIN, 0};
+    while (!stop_.load(std::memory_order_relaxed)) {
+      poll(&pfd, 1, kDrainIntervalMs);
+      MutexLock l(mutex_);
+      Drain();
+    }
+  });
+  ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+  ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+void SamplingProfiler::BeforeTeardownStop() {
+  if (fd_ < 0) return;
+  ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+  stop_ = true;
+  reader_.join();
+  {
+    MutexLock l(mutex_);
+    Drain();
+  }
+  munmap(ring_, ring_size_);
+  ring_ = nullptr;
+  close(fd_);
+  fd_ = -1;
+}
+
+void SamplingProfiler::Drain() {
+  perf_event_mmap_page* header = static_cast<perf_event_mmap_page*>(ring_);
+  const char* data = static_cast<const char*>(ring_) + PageSize();
+  const uint64_t data_size = kRingPages * PageSize();
+  const uint64_t head = __atomic_load_n(&header->data_head, __ATOMIC_ACQUIRE);
+  uint64_t tail = header->data_tail;
+  std::vector<uint64_t> record;
+  std::vector<uint64_t> stack;
+  while (tail < head) {
+    perf_event_header event;
+    CopyFromRing(data, data_size, tail, &event, sizeof(event));
+    if (event.size < sizeof(event)) break;
+    // The fields after the header are all 64-bit words.
+    record.resize((event.size - sizeof(event)) / sizeof(uint64_t));
+    CopyFromRing(data, data_size, tail + sizeof(event), record.data(),
+                 record.size() * sizeof(uint64_t));
+    tail += event.size;
+
+    if (event.type == PERF_RECORD_LOST && record.size() >= 2) {
+      lost_ += static_cast<int64_t>(record[1]);
+      continue;
+    }
+    if (event.type != PERF_RECORD_SAMPLE || record.empty()) continue;
+    stack.clear();
+    const uint64_t ip = record[0];
+    if (callchain_ == PC_FramePointer && record.size() >= 2) {
+      const size_t nr = std::min<size_t>(record[1], record.size() - 2);
+      for (size_t i = 0; i < nr; ++i) {
+        const uint64_t address = record[2 + i];
+        // Skip the markers of the user/kernel parts of the chain.
+        if (address >= static_cast<uint64_t>(PERF_CONTEXT_MAX)) continue;
+        // Callers are return addresses; look up the call instead.
+        stack.push_back(stack.empty() ? address : address - 1);
+      }
+    } else if (callchain_ == PC_LBR && record.size() >= 2) {
+      stack.push_back(ip);
+      // Each perf_branch_entry is three words, starting with the address of
+      // the call.
+      const size_t nr = std::min<size_t>(record[1], (record.size() - 2) / 3);
+      for (size_t i = 0; i < nr; ++i) {
+        stack.push_back(record[2 + 3 * i]);
+      }
+    }
+    if (stack.empty()) stack.push_back(ip);
+    ++stacks_[stack];
+  }
+  __atomic_store_n(&header->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+bool WriteFoldedStacks(const SampledStacks& stacks, const std::string& path) {
+  std::ofstream out(path);
+  if (!out) return false;
+  std::map<uint64_t, std::string> symbols;
+  for (const auto& stack_and_count : stacks) {
+    const std::vector<uint64_t>& stack = stack_and_count.first;
+    for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+      auto symbol = symbols.find(*it);
+      if (symbol == symbols.end()) {
+        symbol = symbols.emplace(*it, Symbolize(*it)).first;
+      }
+      out << (it == stack.rbegin() ? "" : ";") << symbol->second;
+    }
+    out << " " << stack_and_count.second << "\n";
+  }
+  return static_cast<bool>(out);
+}
+
+#else  // BENCHMARK_OS_LINUX
+
+SamplingProfiler::SamplingProfiler(ProfileCallchain) {}
+
+SamplingProfiler::~SamplingProfiler() {}
+
+bool SamplingProfiler::IsSupported() { return false; }
+
+void SamplingProfiler::AfterSetupStart() {
+  if (!warned_) {
+    warned_ = true;
+    GetErrorLogInstance() << "***WARNING*** The sampling profiler is only "
+                             "supported on Linux.\n";
+  }
+}
+
+void SamplingProfiler::BeforeTeardownStop() {}
+
+bool WriteFoldedStacks(const SampledStacks&, const std::string&) {
+  return false;
+}
+
+#endif  // BENCHMARK_OS_LINUX
+
+void SamplingProfiler::TakeSamples(SampledStacks* stacks) {
+  MutexLock l(mutex_);
+  for (const auto& stack_and_count : stacks_) {
+    (*stacks)[stack_and_count.first] += stack_and_count.second;
+  }
+  stacks_.clear();
+}
+
+int64_t SamplingProfiler::lost_samples() {
+  MutexLock l(mutex_);
+  return lost_;
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,94 @@
+#ifndef BENCHMARK_SAMPLING_PROFILER_H_
+#define BENCHMARK_SAMPLING_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/export.h"
+#include "benchmark/managers.h"
+#include "internal_macros.h"
+#include "mutex.h"
+
+namespace benchmark {
+namespace internal {
+
+// Sample counts by call stack, with the innermost frame first.
+typedef std::map<std::vector<uint64_t>, int64_t> SampledStacks;
+
+// How the profiler records the call stack of a sample.
+enum ProfileCallchain {
+  // Only the sampled instruction.
+  PC_None,
+  // The kernel walks the user stack through the frame pointers.
+  PC_FramePointer,
+  // The CPU's last branch records in call stack mode, which also works for
+  // code built without frame pointers but is only as deep as the LBR.
+  PC_LBR,
+};
+
+// Parses a --benchmark_profile_callchain value.
+BENCHMARK_EXPORT bool ParseProfileCallchain(const std::string& value,
+                                            ProfileCallchain* callchain);
+
+// A sampling profiler based on perf_event_open, used as the ProfilerManager
+// when --benchmark_profile_dir is given. It samples the thread that runs the
+// profiling pass of a benchmark, on CPU cycles or, if the PMU is not
+// available, on the CPU clock.
+class BENCHMARK_EXPORT SamplingProfiler : public ProfilerManager {
+ public:
+  explicit SamplingProfiler(ProfileCallchain callchain);
+  ~SamplingProfiler() override;
+
+  // Whether samples can be taken on this system at all.
+  static bool IsSupported();
+
+  void AfterSetupStart() override;
+  void BeforeTeardownStop() override;
+
+  // Moves the samples of the profiling passes so far into `stacks`.
+  void TakeSamples(SampledStacks* stacks);
+
+  // Samples that were lost because the ring buffer was full.
+  int64_t lost_samples() EXCLUDES(mutex_);
+
+ private:
+#ifdef BENCHMARK_OS_LINUX
+  // Reads the samples out of the ring buffer.
+  void Drain() REQUIRES(mutex_);
+
+  const ProfileCallchain callchain_;
+  int fd_ = -1;
+  void* ring_ = nullptr;
+  size_t ring_size_ = 0;
+  // Drains the ring buffer while the benchmark runs.
+  std::thread reader_;
+  std::atomic<bool> stop_{false};
+#endif
+  Mutex mutex_;
+  SampledStacks stacks_ GUARDED_BY(mutex_);
+  int64_t lost_ GUARDED_BY(mutex_) = 0;
+  bool warned_ = false;
+};
+
+// Writes `stacks` in the collapsed format of flame graph tools: one line per
+// distinct stack, with its frames from the outermost to the innermost
+// separated by ';', followed by a space and the number of samples. Frames are
+// symbolized with the dynamic symbol table of the loaded modules, and written
+// as `module+0x<offset>` where there is no symbol.
+BENCHMARK_EXPORT bool WriteFoldedStacks(const SampledStacks& stacks,
+                                        const std::string& path);
+
+// The name of the collapsed-stack file of a benchmark instance.
+BENCHMARK_EXPORT std::string ProfileFileName(const std::string& run_name);
+
+// The built-in profiler, if it is the registered ProfilerManager.
+extern SamplingProfiler* sampling_profiler;
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_SAMPLING_PROFILER_H_
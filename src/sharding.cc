@@ -0,0 +1,138 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sharding.h"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <string>
+#include <tuple>
+
+namespace benchmark {
+namespace internal {
+
+namespace {
+
+// The representative of the group of benchmark `i`, with path halving.
+size_t FindGroup(std::vector<size_t>* parents, size_t i) {
+  while ((*parents)[i] != i) {
+    (*parents)[i] = (*parents)[(*parents)[i]];
+    i = (*parents)[i];
+  }
+  return i;
+}
+
+void JoinGroups(std::vector<size_t>* parents, size_t a, size_t b) {
+  a = FindGroup(parents, a);
+  b = FindGroup(parents, b);
+  // The earlier benchmark represents the group.
+  (*parents)[std::max(a, b)] = std::min(a, b);
+}
+
+}  // namespace
+
+std::vector<int> BalanceShards(const std::vector<double>& weights,
+                               int shard_count) {
+  std::vector<size_t> order(weights.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return weights[a] > weights[b];
+  });
+  std::vector<double> loads(static_cast<size_t>(shard_count), 0);
+  std::vector<int> shards(weights.size(), 0);
+  for (size_t group : order) {
+    const auto lightest = std::min_element(loads.begin(), loads.end());
+    *lightest += weights[group];
+    shards[group] = static_cast<int>(lightest - loads.begin());
+  }
+  return shards;
+}
+
+std::vector<size_t> SelectShard(
+    const std::vector<BenchmarkInstance>& benchmarks,
+    const RunDurations& durations, int shard_index, int shard_count) {
+  std::vector<size_t> parents(benchmarks.size());
+  std::iota(parents.begin(), parents.end(), size_t{0});
+  std::map<int, size_t> complexity_families;
+  std::map<std::tuple<std::string, std::string, std::string>, size_t> names;
+  for (size_t i = 0; i < benchmarks.size(); ++i) {
+    const BenchmarkInstance& benchmark = benchmarks[i];
+    if (benchmark.complexity() != oNone) {
+      auto family = complexity_families.emplace(benchmark.family_index(), i);
+      JoinGroups(&parents, family.first->second, i);
+    }
+    const BenchmarkName& name = benchmark.name();
+    names.emplace(std::make_tuple(name.function_name, name.args, name.threads),
+                  i);
+  }
+  // A baseline has the same arguments and thread count as its candidate.
+  for (size_t i = 0; i < benchmarks.size(); ++i) {
+    const BenchmarkName& name = benchmarks[i].name();
+    if (benchmarks[i].compare_to().empty()) {
+      continue;
+    }
+    auto baseline = names.find(
+        std::make_tuple(benchmarks[i].compare_to(), name.args, name.threads));
+    if (baseline != names.end()) {
+      JoinGroups(&parents, baseline->second, i);
+    }
+  }
+
+  double known_total = 0;
+  size_t known = 0;
+  std::vector<double> weights(benchmarks.size(), 1);
+  std::vector<bool> has_weight(benchmarks.size(), false);
+  for (size_t i = 0; i < benchmarks.size(); ++i) {
+    auto it = durations.find(benchmarks[i].name().str());
+    if (it != durations.end()) {
+      weights[i] = it->second;
+      has_weight[i] = true;
+      known_total += it->second;
+      ++known;
+    }
+  }
+  if (known > 0) {
+    for (size_t i = 0; i < benchmarks.size(); ++i) {
+      if (!has_weight[i]) {
+        weights[i] = known_total / static_cast<double>(known);
+      }
+    }
+  }
+
+  // The groups in the order of their first benchmark.
+  std::vector<size_t> group_of(benchmarks.size());
+  std::vector<double> group_weights;
+  std::map<size_t, size_t> groups;
+  for (size_t i = 0; i < benchmarks.size(); ++i) {
+    auto group = groups.emplace(FindGroup(&parents, i), groups.size());
+    if (group.second) {
+      group_weights.push_back(0);
+    }
+    group_of[i] = group.first->second;
+    group_weights[group_of[i]] += weights[i];
+  }
+
+  const std::vector<int> shards = BalanceShards(group_weights, shard_count);
+  std::vector<size_t> selected;
+  for (size_t i = 0; i < benchmarks.size(); ++i) {
+    if (shards[group_of[i]] == shard_index) {
+      selected.push_back(i);
+    }
+  }
+  return selected;
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,34 @@
+#ifndef BENCHMARK_SHARDING_H_
+#define BENCHMARK_SHARDING_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "baseline.h"
+#include "benchmark/export.h"
+#include "benchmark_api_internal.h"
+
+namespace benchmark {
+namespace internal {
+
+// Assigns groups of benchmarks with the given `weights` to `shard_count`
+// shards, heaviest first, each to the least loaded shard, and returns the
+// shard of every group. Ties go to the earlier group and the lower shard, so
+// that every shard computes the same assignment.
+BENCHMARK_EXPORT std::vector<int> BalanceShards(
+    const std::vector<double>& weights, int shard_count);
+
+// Splits `benchmarks` into `shard_count` shards and returns the indices of
+// those in shard `shard_index`, in increasing order. The instances of a family
+// that computes its complexity stay in one shard, and so do a benchmark and the
+// baseline it is compared to with CompareTo(). The shards get about the same
+// total of `durations`, where benchmarks missing from it count as the average
+// duration, or, without any durations, the same number of benchmarks.
+BENCHMARK_EXPORT std::vector<size_t> SelectShard(
+    const std::vector<BenchmarkInstance>& benchmarks,
+    const RunDurations& durations, int shard_index, int shard_count);
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_SHARDING_H_
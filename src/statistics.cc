@@ -18,7 +18,9 @@
 #include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "benchmark/reporter.h"
@@ -107,6 +109,31 @@ double StatisticsCV(const std::vector<double>& v) {
   return stddev / mean;
 }
 
+double StatisticsRelCI(const std::vector<double>& v) {
+  if (v.size() < 2) {
+    return 0.0;
+  }
+
+  // Two-sided 97.5% quantiles of Student's t-distribution, by degrees of
+  // freedom. Beyond the table, the normal quantile is close enough.
+  static const double kStudentT975[] = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  const size_t df = v.size() - 1;
+  const double t = df <= sizeof(kStudentT975) / sizeof(kStudentT975[0])
+                       ? kStudentT975[df - 1]
+                       : 1.960;
+
+  const auto mean = StatisticsMean(v);
+  if (std::fpclassify(mean) == FP_ZERO) {
+    return 0.0;
+  }
+
+  return t * StatisticsStdDev(v) /
+         std::sqrt(static_cast<double>(v.size())) / mean;
+}
+
 std::vector<BenchmarkReporter::Run> ComputeStats(
     const std::vector<BenchmarkReporter::Run>& reports) {
   typedef BenchmarkReporter::Run Run;
@@ -205,6 +232,10 @@ std::vector<BenchmarkReporter::Run> ComputeStats(
     data.aggregate_name = Stat.name_;
     data.aggregate_unit = Stat.unit_;
     data.report_label = report_label;
+    data.overhead_subtracted = successful_run->overhead_subtracted;
+    data.working_set_bytes = successful_run->working_set_bytes;
+    data.cache_level = successful_run->cache_level;
+    data.peak_memory_bandwidth = successful_run->peak_memory_bandwidth;
 
     // It is incorrect to say that an aggregate is computed over
     // run's iterations, because those iterations already got averaged.
@@ -243,4 +274,144 @@ std::vector<BenchmarkReporter::Run> ComputeStats(
   return results;
 }
 
+namespace {
+
+double RelativeMedianDiff(const std::vector<double>& baseline,
+                          const std::vector<double>& candidate) {
+  const double base = StatisticsMedian(baseline);
+  if (std::fpclassify(base) == FP_ZERO) {
+    return 0.0;
+  }
+  return (StatisticsMedian(candidate) - base) / base;
+}
+
+// Probability of at most `k` successes out of `n` fair coin flips.
+double BinomialHalfCdf(size_t k, size_t n) {
+  double cdf = 0;
+  for (size_t i = 0; i <= k; ++i) {
+    cdf += std::exp(std::lgamma(static_cast<double>(n) + 1) -
+                    std::lgamma(static_cast<double>(i) + 1) -
+                    std::lgamma(static_cast<double>(n - i) + 1) -
+                    static_cast<double>(n) * std::log(2.0));
+  }
+  return cdf;
+}
+
+}  // end namespace
+
+PairedStats ComputePairedStats(const std::vector<double>& baseline,
+                               const std::vector<double>& candidate) {
+  BM_CHECK_EQ(baseline.size(), candidate.size());
+  PairedStats stats;
+  const size_t n = baseline.size();
+  if (n == 0) {
+    return stats;
+  }
+  stats.median_diff = RelativeMedianDiff(baseline, candidate);
+
+  // Resample the pairs, keeping both times of a pair together. The seed is
+  // fixed so that the interval only depends on the measurements.
+  constexpr int kBootstrapSamples = 2000;
+  std::mt19937 rng(0x5eed);
+  std::uniform_int_distribution<size_t> pick(0, n - 1);
+  std::vector<double> diffs;
+  diffs.reserve(kBootstrapSamples);
+  std::vector<double> base_sample(n);
+  std::vector<double> cand_sample(n);
+  for (int s = 0; s < kBootstrapSamples; ++s) {
+    for (size_t i = 0; i < n; ++i) {
+      const size_t j = pick(rng);
+      base_sample[i] = baseline[j];
+      cand_sample[i] = candidate[j];
+    }
+    diffs.push_back(RelativeMedianDiff(base_sample, cand_sample));
+  }
+  std::sort(diffs.begin(), diffs.end());
+  stats.ci_low = diffs[static_cast<size_t>(0.025 * (kBootstrapSamples - 1))];
+  stats.ci_high = diffs[static_cast<size_t>(0.975 * (kBootstrapSamples - 1))];
+
+  // Ties carry no information about the direction and are dropped.
+  size_t faster = 0;
+  size_t slower = 0;
+  for (size_t i = 0; i < n; ++i) {
+    faster += static_cast<size_t>(candidate[i] < baseline[i]);
+    slower += static_cast<size_t>(candidate[i] > baseline[i]);
+  }
+  stats.sign_p = std::min(
+      1.0, 2 * BinomialHalfCdf(std::min(faster, slower), faster + slower));
+  return stats;
+}
+
+std::vector<BenchmarkReporter::Run> ComputePairedStats(
+    const std::vector<BenchmarkReporter::Run>& baseline,
+    const std::vector<BenchmarkReporter::Run>& candidate) {
+  typedef BenchmarkReporter::Run Run;
+  std::vector<Run> results;
+
+  const auto per_iteration = [](double time, const Run& run) {
+    return time / static_cast<double>(run.iterations);
+  };
+  std::vector<double> base_real;
+  std::vector<double> base_cpu;
+  std::vector<double> cand_real;
+  std::vector<double> cand_cpu;
+  const Run* first = nullptr;
+  for (const Run& c : candidate) {
+    if (c.skipped != internal::NotSkipped || c.iterations == 0) {
+      continue;
+    }
+    for (const Run& b : baseline) {
+      if (b.repetition_index != c.repetition_index ||
+          b.skipped != internal::NotSkipped || b.iterations == 0) {
+        continue;
+      }
+      base_real.push_back(per_iteration(b.real_accumulated_time, b));
+      base_cpu.push_back(per_iteration(b.cpu_accumulated_time, b));
+      cand_real.push_back(per_iteration(c.real_accumulated_time, c));
+      cand_cpu.push_back(per_iteration(c.cpu_accumulated_time, c));
+      if (first == nullptr) {
+        first = &c;
+      }
+      break;
+    }
+  }
+  if (base_real.size() < 2) {
+    return results;
+  }
+
+  const PairedStats real = ComputePairedStats(base_real, cand_real);
+  const PairedStats cpu = ComputePairedStats(base_cpu, cand_cpu);
+  struct Aggregate {
+    const char* name;
+    double PairedStats::*value;
+    StatisticUnit unit;
+  };
+  const Aggregate kAggregates[] = {
+      {"paired_diff", &PairedStats::median_diff, StatisticUnit::kPercentage},
+      {"paired_ci_low", &PairedStats::ci_low, StatisticUnit::kPercentage},
+      {"paired_ci_high", &PairedStats::ci_high, StatisticUnit::kPercentage},
+      {"paired_sign_p", &PairedStats::sign_p, StatisticUnit::kProbability},
+  };
+  for (const auto& aggregate : kAggregates) {
+    Run data;
+    data.run_name = first->run_name;
+    data.family_index = first->family_index;
+    data.per_family_instance_index = first->per_family_instance_index;
+    data.run_type = BenchmarkReporter::Run::RT_Aggregate;
+    data.threads = first->threads;
+    data.repetitions = first->repetitions;
+    data.repetition_index = Run::no_repetition_index;
+    data.aggregate_name = aggregate.name;
+    data.aggregate_unit = aggregate.unit;
+    data.report_label = "vs " + baseline.front().run_name.str();
+    data.overhead_subtracted = first->overhead_subtracted;
+    data.iterations = static_cast<IterationCount>(base_real.size());
+    data.real_accumulated_time = real.*aggregate.value;
+    data.cpu_accumulated_time = cpu.*aggregate.value;
+    data.time_unit = first->time_unit;
+    results.push_back(data);
+  }
+  return results;
+}
+
 }  // end namespace benchmark
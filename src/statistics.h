@@ -31,6 +31,33 @@ BENCHMARK_EXPORT
 std::vector<BenchmarkReporter::Run> ComputeStats(
     const std::vector<BenchmarkReporter::Run>& reports);
 
+// Paired comparison of a candidate against a baseline, from per-iteration
+// times where pair `i` was measured back to back.
+struct PairedStats {
+  // Relative difference of the medians, (candidate - baseline) / baseline.
+  double median_diff = 0;
+  // 95% bootstrap confidence interval of `median_diff`.
+  double ci_low = 0;
+  double ci_high = 0;
+  // Two-sided sign test p-value of candidate and baseline being equally
+  // likely to be the faster one of a pair.
+  double sign_p = 1;
+};
+
+BENCHMARK_EXPORT
+PairedStats ComputePairedStats(const std::vector<double>& baseline,
+                               const std::vector<double>& candidate);
+
+// Returns the "paired_diff", "paired_ci_low", "paired_ci_high" and
+// "paired_sign_p" aggregates of the `candidate` repetitions against the
+// `baseline` ones with the same repetition index, for both the real and the
+// CPU time. If fewer than two pairs did not error, an empty vector is
+// returned.
+BENCHMARK_EXPORT
+std::vector<BenchmarkReporter::Run> ComputePairedStats(
+    const std::vector<BenchmarkReporter::Run>& baseline,
+    const std::vector<BenchmarkReporter::Run>& candidate);
+
 BENCHMARK_EXPORT
 double StatisticsMean(const std::vector<double>& v);
 BENCHMARK_EXPORT
@@ -39,6 +66,10 @@ BENCHMARK_EXPORT
 double StatisticsStdDev(const std::vector<double>& v);
 BENCHMARK_EXPORT
 double StatisticsCV(const std::vector<double>& v);
+// Returns the half-width of the 95% confidence interval of the mean, relative
+// to the mean.
+BENCHMARK_EXPORT
+double StatisticsRelCI(const std::vector<double>& v);
 
 }  // end namespace benchmark
 
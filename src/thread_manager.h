@@ -2,10 +2,17 @@
 #define BENCHMARK_THREAD_MANAGER_H
 
 #include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "benchmark/counter.h"
+#include "benchmark/macros.h"
 #include "benchmark/statistics.h"
+#include "benchmark/sysinfo.h"
 #include "benchmark/types.h"
+#include "counter.h"
+#include "latency_histogram.h"
 #include "mutex.h"
 
 namespace benchmark {
@@ -13,7 +20,9 @@ namespace internal {
 
 class ThreadManager {
  public:
-  explicit ThreadManager(int num_threads) : start_stop_barrier_(num_threads) {}
+  explicit ThreadManager(int num_threads)
+      : start_stop_barrier_(num_threads, BarrierSpinCycles(num_threads)),
+        thread_results_(static_cast<size_t>(num_threads)) {}
 
   Mutex& GetBenchmarkMutex() const RETURN_CAPABILITY(benchmark_mutex_) {
     return benchmark_mutex_;
@@ -23,22 +32,101 @@ class ThreadManager {
 
   void NotifyThreadComplete() { start_stop_barrier_.removeThread(); }
 
+  // The measurements of a single thread. Every thread owns one slot and is
+  // the only one writing to it, so no lock is needed; slots are padded to a
+  // cache line so that threads finishing together do not false-share.
+  struct alignas(BENCHMARK_INTERNAL_CACHELINE_SIZE) ThreadResult {
+    IterationCount iterations = 0;
+    double real_time_used = 0;
+    double cpu_time_used = 0;
+    double manual_time_used = 0;
+    int64_t complexity_n = 0;
+    int64_t working_set_bytes = 0;
+    // Wall time spent waiting for the other threads to finish.
+    double barrier_wait_time = 0;
+    // ChronoClockNow() when the thread left the start barrier.
+    double start_time = 0;
+    // Number of timed slices, i.e. one more than the PauseTiming() calls.
+    int64_t timer_slices = 0;
+    UserCounters counters;
+  };
+
+  ThreadResult& GetThreadResult(int thread_id) {
+    return thread_results_[static_cast<size_t>(thread_id)];
+  }
+
+  // Gives every thread a LatencySampler, so that its State times individual
+  // iterations.
+  void EnableLatencySampling() {
+    latency_samplers_.clear();
+    for (size_t i = 0; i < thread_results_.size(); ++i) {
+      latency_samplers_.emplace_back(new LatencySampler);
+    }
+  }
+
+  // Returns nullptr unless EnableLatencySampling() was called.
+  LatencySampler* GetLatencySampler(int thread_id) {
+    return latency_samplers_.empty()
+               ? nullptr
+               : latency_samplers_[static_cast<size_t>(thread_id)].get();
+  }
+
   struct Result {
     IterationCount iterations = 0;
     double real_time_used = 0;
     double cpu_time_used = 0;
     double manual_time_used = 0;
     int64_t complexity_n = 0;
+    // Summed over the threads, which are assumed to work on separate data.
+    int64_t working_set_bytes = 0;
     std::string report_label_;
     std::string skip_message_;
     internal::Skipped skipped_ = internal::NotSkipped;
     UserCounters counters;
+    // The unreduced measurements, indexed by thread.
+    std::vector<ThreadResult> per_thread;
   };
+  // Only the skip state and the label are written here while the threads are
+  // running; the measurements are merged in by TakeResults().
   GUARDED_BY(GetBenchmarkMutex()) Result results;
 
+  // Sums the per-thread slots, in thread order, into a copy of `results`.
+  // Must only be called once every thread has called NotifyThreadComplete()
+  // and been joined.
+  Result TakeResults() EXCLUDES(benchmark_mutex_) {
+    Result reduced;
+    {
+      MutexLock l(benchmark_mutex_);
+      reduced = results;
+    }
+    for (const ThreadResult& t : thread_results_) {
+      reduced.iterations += t.iterations;
+      reduced.real_time_used += t.real_time_used;
+      reduced.cpu_time_used += t.cpu_time_used;
+      reduced.manual_time_used += t.manual_time_used;
+      reduced.complexity_n += t.complexity_n;
+      reduced.working_set_bytes += t.working_set_bytes;
+      internal::Increment(&reduced.counters, t.counters);
+    }
+    reduced.per_thread = std::move(thread_results_);
+    thread_results_.clear();
+    return reduced;
+  }
+
  private:
+  // How long the threads spin at the barrier before they block. They only
+  // spin if each of them can have a CPU of its own.
+  static int64_t BarrierSpinCycles(int num_threads) {
+    constexpr double kSpinSeconds = 50e-6;
+    const CPUInfo& info = CPUInfo::Get();
+    if (num_threads < 2 || num_threads > info.num_cpus) return 0;
+    return static_cast<int64_t>(info.cycles_per_second * kSpinSeconds);
+  }
+
   mutable Mutex benchmark_mutex_;
   Barrier start_stop_barrier_;
+  std::vector<ThreadResult> thread_results_;
+  std::vector<std::unique_ptr<LatencySampler>> latency_samplers_;
 };
 
 }  // namespace internal
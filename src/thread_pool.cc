@@ -0,0 +1,114 @@
+// Copyright 2025 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+#include "check.h"
+
+namespace benchmark {
+namespace internal {
+
+ThreadPool*& ThreadPool::Instance() {
+  // Intentionally leaked: the workers block forever waiting for work and must
+  // not be joined during static destruction.
+  static ThreadPool* pool = new ThreadPool();
+  return pool;
+}
+
+ThreadPool& ThreadPool::Get() { return *Instance(); }
+
+void ThreadPool::ResetAfterFork() { Instance() = new ThreadPool(); }
+
+void ThreadPool::Run(int num_threads, const std::function<void(int)>& fn) {
+  const int num_workers = num_threads - 1;
+  if (num_workers <= 0) {
+    fn(0);
+    return;
+  }
+
+  {
+    MutexLock l(mutex_);
+    BM_CHECK(!running_) << "ThreadPool::Run() is not reentrant";
+    running_ = true;
+    job_ = &fn;
+    pending_ = num_workers;
+
+    const int num_alive = static_cast<int>(workers_.size());
+    const int num_reused = std::min(num_workers, num_alive);
+    for (int i = 0; i < num_reused; ++i) {
+      Worker* worker = workers_[static_cast<size_t>(i)].get();
+      ++worker->dispatched;
+      worker->wakeup.notify_one();
+    }
+    for (int i = num_reused; i < num_workers; ++i) {
+      workers_.emplace_back(new Worker);
+      Worker* worker = workers_.back().get();
+      worker->dispatched = 1;
+      worker->thread = std::thread(&ThreadPool::WorkerLoop, this, worker, i + 1);
+    }
+    stats_.threads_reused += num_reused;
+    stats_.threads_created += num_workers - num_reused;
+  }
+
+  // Run one thread here directly, *after* the workers have been released.
+  fn(0);
+
+  MutexLock l(mutex_);
+  while (pending_ != 0) {
+    done_.wait(l.native_handle());
+  }
+  job_ = nullptr;
+  running_ = false;
+}
+
+ThreadPool::Stats ThreadPool::GetStats() {
+  MutexLock l(mutex_);
+  return stats_;
+}
+
+int ThreadPool::NumWorkers() {
+  MutexLock l(mutex_);
+  return static_cast<int>(workers_.size());
+}
+
+void ThreadPool::WorkerLoop(Worker* worker, int thread_index) {
+  uint64_t seen = 0;
+  for (;;) {
+    const std::function<void(int)>* job = nullptr;
+    {
+      MutexLock l(mutex_);
+      while (worker->dispatched == seen) {
+        worker->wakeup.wait(l.native_handle());
+      }
+      seen = worker->dispatched;
+      job = job_;
+    }
+
+    (*job)(thread_index);
+
+    bool last = false;
+    {
+      MutexLock l(mutex_);
+      last = --pending_ == 0;
+    }
+    if (last) {
+      done_.notify_one();
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,74 @@
+#ifndef BENCHMARK_THREAD_POOL_H
+#define BENCHMARK_THREAD_POOL_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark/export.h"
+#include "mutex.h"
+
+namespace benchmark {
+namespace internal {
+
+// A process-wide set of worker threads that outlive a single call to
+// RunThreads(). Worker `i` always executes thread index `i + 1` of a run, so
+// probe rounds, repetitions and instances with the same thread count are
+// served by the same OS threads with warm stacks. The pool only grows: a run
+// that needs more workers than are currently alive spawns the missing ones.
+class BENCHMARK_EXPORT ThreadPool {
+ public:
+  struct Stats {
+    // Number of OS threads spawned by the pool.
+    int64_t threads_created = 0;
+    // Number of times an already running worker was handed a thread index.
+    int64_t threads_reused = 0;
+  };
+
+  static ThreadPool& Get();
+
+  // Replaces the pool with an empty one, in a child process forked from one
+  // whose pool had workers. Those only exist in the parent process, so the
+  // old pool is leaked.
+  static void ResetAfterFork();
+
+  // Runs `fn(0)` on the calling thread and `fn(1)` ... `fn(num_threads - 1)`
+  // on pool workers, returning once all of them have finished.
+  void Run(int num_threads, const std::function<void(int)>& fn)
+      EXCLUDES(mutex_);
+
+  Stats GetStats() EXCLUDES(mutex_);
+
+  // Number of workers currently alive.
+  int NumWorkers() EXCLUDES(mutex_);
+
+ private:
+  ThreadPool() = default;
+  ~ThreadPool() = delete;
+
+  static ThreadPool*& Instance();
+
+  struct Worker {
+    std::thread thread;
+    Condition wakeup;
+    // Incremented by the dispatcher each time a job is handed to the worker.
+    uint64_t dispatched = 0;
+  };
+
+  void WorkerLoop(Worker* worker, int thread_index) EXCLUDES(mutex_);
+
+  Mutex mutex_;
+  Condition done_;
+  std::vector<std::unique_ptr<Worker>> workers_ GUARDED_BY(mutex_);
+  const std::function<void(int)>* job_ GUARDED_BY(mutex_) = nullptr;
+  int pending_ GUARDED_BY(mutex_) = 0;
+  bool running_ GUARDED_BY(mutex_) = false;
+  Stats stats_ GUARDED_BY(mutex_);
+};
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_THREAD_POOL_H
@@ -0,0 +1,80 @@
+// Copyright 2025 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "thread_timer.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+constexpr int kCalibrationBatches = 10;
+constexpr int kCalibrationPairs = 1000;
+
+// Returns the smallest average time per empty StartTimer()/StopTimer() pair
+// over a few batches.
+double MeasurePairTime(const CycleClockTimerCalibration& calibration) {
+  double best = std::numeric_limits<double>::max();
+  for (int batch = 0; batch < kCalibrationBatches; ++batch) {
+    ThreadTimer timer = ThreadTimer::CreateCycleClock(
+        /*measure_process_cpu_time_=*/false, &calibration);
+    for (int i = 0; i < kCalibrationPairs; ++i) {
+      timer.StartTimer();
+      timer.StopTimer();
+    }
+    timer.Finish();
+    best = std::min(best, timer.real_time_used() / kCalibrationPairs);
+  }
+  return best;
+}
+
+CycleClockTimerCalibration Calibrate() {
+  CycleClockTimerCalibration calibration;
+
+  // Estimate the rate of the cycle clock by spinning for a millisecond.
+  const double start_time = ChronoClockNow();
+  const int64_t start_ticks = cycleclock::Now();
+  double elapsed = 0;
+  while (elapsed < 1e-3) {
+    elapsed = ChronoClockNow() - start_time;
+  }
+  const double ticks_per_second =
+      static_cast<double>(cycleclock::Now() - start_ticks) / elapsed;
+  calibration.window_ticks =
+      std::max<int64_t>(static_cast<int64_t>(ticks_per_second * 1e-3), 1);
+
+  // Never close a window while measuring the cost of a pair.
+  CycleClockTimerCalibration uncorrected = calibration;
+  uncorrected.window_ticks = std::numeric_limits<int64_t>::max();
+  calibration.overhead = MeasurePairTime(uncorrected);
+  calibration.overhead_ticks =
+      static_cast<int64_t>(calibration.overhead * ticks_per_second);
+
+  CycleClockTimerCalibration corrected = uncorrected;
+  corrected.overhead_ticks = calibration.overhead_ticks;
+  calibration.residual_overhead = MeasurePairTime(corrected);
+  return calibration;
+}
+
+}  // end namespace
+
+const CycleClockTimerCalibration& GetCycleClockTimerCalibration() {
+  static const CycleClockTimerCalibration calibration = Calibrate();
+  return calibration;
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -1,15 +1,38 @@
 #ifndef BENCHMARK_THREAD_TIMER_H
 #define BENCHMARK_THREAD_TIMER_H
 
+#include <algorithm>
+#include <cstdint>
+
+#include "benchmark/export.h"
 #include "check.h"
+#include "cycleclock.h"
 #include "timers.h"
 
 namespace benchmark {
 namespace internal {
 
+// The cost of the cycle clock timer, measured once per process.
+struct CycleClockTimerCalibration {
+  // Cycle clock ticks counted as timed by an empty StartTimer()/StopTimer()
+  // pair. This is subtracted from every timed slice.
+  int64_t overhead_ticks = 0;
+  // Ticks between two reads of the real and CPU time clocks.
+  int64_t window_ticks = 0;
+  // `overhead_ticks` in seconds.
+  double overhead = 0;
+  // The time per empty pair that is left after the subtraction.
+  double residual_overhead = 0;
+};
+
+BENCHMARK_EXPORT const CycleClockTimerCalibration&
+GetCycleClockTimerCalibration();
+
 class ThreadTimer {
-  explicit ThreadTimer(bool measure_process_cpu_time_)
-      : measure_process_cpu_time(measure_process_cpu_time_) {}
+  explicit ThreadTimer(bool measure_process_cpu_time_,
+                       const CycleClockTimerCalibration* calibration = nullptr)
+      : measure_process_cpu_time(measure_process_cpu_time_),
+        calibration_(calibration) {}
 
  public:
   static ThreadTimer Create() {
@@ -18,10 +41,31 @@ class ThreadTimer {
   static ThreadTimer CreateProcessCpuTime() {
     return ThreadTimer(/*measure_process_cpu_time_=*/true);
   }
+  // Reads only the cycle clock when started and stopped. The real and CPU
+  // time clocks are read about once a millisecond, which calibrates the cycle
+  // clock and splits the CPU time of that window between its timed and
+  // paused parts.
+  static ThreadTimer CreateCycleClock(bool measure_process_cpu_time_) {
+    return ThreadTimer(measure_process_cpu_time_,
+                       &GetCycleClockTimerCalibration());
+  }
+  // As above, with an explicit calibration.
+  static ThreadTimer CreateCycleClock(
+      bool measure_process_cpu_time_,
+      const CycleClockTimerCalibration* calibration) {
+    return ThreadTimer(measure_process_cpu_time_, calibration);
+  }
 
   // Called by each thread
   void StartTimer() {
     running_ = true;
+    if (calibration_ != nullptr) {
+      if (!window_open_) {
+        OpenWindow();
+      }
+      start_ticks_ = cycleclock::Now();
+      return;
+    }
     start_real_time_ = ChronoClockNow();
     start_cpu_time_ = ReadCpuTimerOfChoice();
   }
@@ -29,6 +73,17 @@ class ThreadTimer {
   // Called by each thread
   void StopTimer() {
     BM_CHECK(running_);
+    ++slices_;
+    if (calibration_ != nullptr) {
+      const int64_t now = cycleclock::Now();
+      running_ = false;
+      window_timed_ticks_ += now - start_ticks_;
+      ++window_slices_;
+      if (now - window_start_ticks_ >= calibration_->window_ticks) {
+        CloseWindow();
+      }
+      return;
+    }
     running_ = false;
     real_time_used_ += ChronoClockNow() - start_real_time_;
     // Floating point error can result in the subtraction producing a negative
@@ -37,11 +92,23 @@ class ThreadTimer {
         std::max<double>(ReadCpuTimerOfChoice() - start_cpu_time_, 0);
   }
 
+  // Called by each thread once it is done timing. Accounts for the time that
+  // the cycle clock timer has not converted yet.
+  void Finish() {
+    BM_CHECK(!running_);
+    if (window_open_) {
+      CloseWindow();
+    }
+  }
+
   // Called by each thread
   void SetIterationTime(double seconds) { manual_time_used_ += seconds; }
 
   bool running() const { return running_; }
 
+  // The number of times the timer has been stopped.
+  int64_t slices() const { return slices_; }
+
   // REQUIRES: timer is not running
   double real_time_used() const {
     BM_CHECK(!running_);
@@ -66,12 +133,53 @@ class ThreadTimer {
     return ThreadCPUUsage();
   }
 
+  void OpenWindow() {
+    window_open_ = true;
+    window_start_real_time_ = ChronoClockNow();
+    window_start_cpu_time_ = ReadCpuTimerOfChoice();
+    window_start_ticks_ = cycleclock::Now();
+    window_timed_ticks_ = 0;
+    window_slices_ = 0;
+  }
+
+  void CloseWindow() {
+    const int64_t ticks = cycleclock::Now() - window_start_ticks_;
+    const double real_time = ChronoClockNow() - window_start_real_time_;
+    const double cpu_time =
+        std::max<double>(ReadCpuTimerOfChoice() - window_start_cpu_time_, 0);
+    window_open_ = false;
+    const int64_t timed_ticks = std::max<int64_t>(
+        window_timed_ticks_ - window_slices_ * calibration_->overhead_ticks,
+        0);
+    if (ticks <= 0 || timed_ticks == 0) {
+      return;
+    }
+    const double timed_fraction =
+        std::min(static_cast<double>(timed_ticks) / static_cast<double>(ticks),
+                 1.0);
+    real_time_used_ += real_time * timed_fraction;
+    cpu_time_used_ += cpu_time * timed_fraction;
+  }
+
   // should the thread, or the process, time be measured?
   const bool measure_process_cpu_time;
+  // Non-null if the cycle clock is used.
+  const CycleClockTimerCalibration* const calibration_;
 
   bool running_ = false;        // Is the timer running
   double start_real_time_ = 0;  // If running_
   double start_cpu_time_ = 0;   // If running_
+  int64_t start_ticks_ = 0;     // If running_ with the cycle clock
+  int64_t slices_ = 0;
+
+  // The cycle clock timer converts ticks in windows between reads of the
+  // other clocks.
+  bool window_open_ = false;
+  double window_start_real_time_ = 0;
+  double window_start_cpu_time_ = 0;
+  int64_t window_start_ticks_ = 0;
+  int64_t window_timed_ticks_ = 0;
+  int64_t window_slices_ = 0;
 
   // Accumulated time so far (does not contain current slice if running_)
   double real_time_used_ = 0;
@@ -0,0 +1,117 @@
+// Copyright 2025 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "timer_overhead.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "benchmark/benchmark_api.h"
+#include "benchmark/state.h"
+#include "benchmark/utils.h"
+#include "benchmark_api_internal.h"
+#include "thread_timer.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+constexpr int kCalibrationBatches = 5;
+constexpr IterationCount kEmptyLoopIterations = 10000000;
+constexpr IterationCount kPauseResumeIterations = 10000;
+
+// Without a barrier in its body, the compiler folds the loop away, which it
+// cannot do for a loop that does any work.
+void EmptyLoop(State& state) {
+  for (auto _ : state) {
+    ClobberMemory();
+  }
+}
+
+void PauseResumeLoop(State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    state.ResumeTiming();
+  }
+}
+
+// Returns the smallest measured real time per iteration of `fn` over a few
+// batches, as the benchmark runner would measure it.
+double MeasurePerIteration(Function* fn, IterationCount iterations,
+                           bool fast_timing) {
+  FunctionBenchmark benchmark("timer_overhead", fn);
+  const std::vector<int64_t> args;
+  const BenchmarkInstance instance(&benchmark, /*family_idx=*/-1,
+                                   /*per_family_instance_idx=*/0, args,
+                                   /*thread_count=*/1);
+  double best = std::numeric_limits<double>::max();
+  for (int batch = 0; batch < kCalibrationBatches; ++batch) {
+    ThreadManager manager(1);
+    ThreadTimer timer =
+        fast_timing
+            ? ThreadTimer::CreateCycleClock(/*measure_process_cpu_time_=*/false)
+            : ThreadTimer::Create();
+    instance.Run(iterations, /*thread_id=*/0, &timer, &manager,
+                 /*perf_counters_measurement=*/nullptr,
+                 /*profiler_manager=*/nullptr);
+    best = std::min(best,
+                    timer.real_time_used() / static_cast<double>(iterations));
+  }
+  return best;
+}
+
+TimerOverhead Calibrate(bool fast_timing) {
+  TimerOverhead overhead;
+  overhead.empty_loop =
+      MeasurePerIteration(&EmptyLoop, kEmptyLoopIterations, fast_timing);
+  overhead.pause_resume = std::max(
+      MeasurePerIteration(&PauseResumeLoop, kPauseResumeIterations,
+                          fast_timing) -
+          overhead.empty_loop,
+      0.0);
+  return overhead;
+}
+
+}  // end namespace
+
+const TimerOverhead& GetTimerOverhead(bool fast_timing) {
+  if (fast_timing) {
+    static const TimerOverhead overhead = Calibrate(/*fast_timing=*/true);
+    return overhead;
+  }
+  static const TimerOverhead overhead = Calibrate(/*fast_timing=*/false);
+  return overhead;
+}
+
+void SubtractTimerOverhead(const TimerOverhead& overhead,
+                           ThreadManager::Result* results) {
+  results->real_time_used = 0;
+  results->cpu_time_used = 0;
+  for (ThreadManager::ThreadResult& t : results->per_thread) {
+    // The first slice is the loop itself, every further one follows a pause.
+    const double cost =
+        overhead.empty_loop * static_cast<double>(t.iterations) +
+        overhead.pause_resume *
+            static_cast<double>(std::max<int64_t>(t.timer_slices - 1, 0));
+    t.real_time_used = std::max(t.real_time_used - cost, 0.0);
+    t.cpu_time_used = std::max(t.cpu_time_used - cost, 0.0);
+    results->real_time_used += t.real_time_used;
+    results->cpu_time_used += t.cpu_time_used;
+  }
+}
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,24 @@
+#ifndef BENCHMARK_TIMER_OVERHEAD_H_
+#define BENCHMARK_TIMER_OVERHEAD_H_
+
+#include "benchmark/export.h"
+#include "benchmark/sysinfo.h"
+#include "thread_manager.h"
+
+namespace benchmark {
+namespace internal {
+
+// Returns the overhead of the benchmark loop when timed with the cycle clock
+// timer (`fast_timing`) or the default one. Each is calibrated on first use
+// by running an empty loop, and a loop that only pauses and resumes timing.
+BENCHMARK_EXPORT const TimerOverhead& GetTimerOverhead(bool fast_timing);
+
+// Subtracts `overhead` from the real and CPU times of every thread in
+// `results`, based on its iterations and timed slices, and updates the totals.
+BENCHMARK_EXPORT void SubtractTimerOverhead(const TimerOverhead& overhead,
+                                            ThreadManager::Result* results);
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_TIMER_OVERHEAD_H_
@@ -0,0 +1,141 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "working_set.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+
+#include "benchmark/utils.h"
+#include "timers.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+// Assumed when the cache sizes could not be read: L1, L2 and L3.
+constexpr int64_t kTypicalCacheSizes[] = {32 << 10, 1 << 20, 32 << 20};
+
+// STREAM sizes each array to at least four times the last level cache, which
+// is bounded here so that the probe stays quick on large server parts.
+constexpr int64_t kMinProbeArrayBytes = 32 << 20;
+constexpr int64_t kMaxProbeArrayBytes = 128 << 20;
+constexpr int kProbeRounds = 5;
+
+// The peak memory bandwidth once measured, or a negative value.
+double peak_memory_bandwidth = -1;
+bool memory_bandwidth_probe_allowed = true;
+
+struct DataCache {
+  int64_t size = 0;
+  // Hardware threads that share one instance of the cache.
+  int num_sharing = 1;
+};
+
+// The data or unified cache of every level, by level.
+std::map<int, DataCache> DataCaches(
+    const std::vector<CPUInfo::CacheInfo>& caches) {
+  std::map<int, DataCache> levels;
+  for (const CPUInfo::CacheInfo& cache : caches) {
+    if (cache.type == "Instruction" || cache.size <= 0) continue;
+    DataCache& level = levels[cache.level];
+    level.size = std::max<int64_t>(level.size, cache.size);
+    level.num_sharing = std::max(level.num_sharing, cache.num_sharing);
+  }
+  return levels;
+}
+
+double MeasurePeakMemoryBandwidth() {
+  const std::map<int, DataCache> levels = DataCaches(CPUInfo::Get().caches);
+  const int64_t last_level = levels.empty() ? 0 : levels.rbegin()->second.size;
+  const int64_t array_bytes = std::min(
+      std::max(4 * last_level, kMinProbeArrayBytes), kMaxProbeArrayBytes);
+  const size_t n = static_cast<size_t>(array_bytes) / sizeof(double);
+  // Filling the arrays also faults their pages in.
+  std::vector<double> a(n, 0.0);
+  std::vector<double> b(n, 1.0);
+  std::vector<double> c(n, 2.0);
+  const double scalar = 3.0;
+  double best = 0;
+  for (int round = 0; round < kProbeRounds; ++round) {
+    const double start = ChronoClockNow();
+    for (size_t i = 0; i < n; ++i) {
+      a[i] = b[i] + scalar * c[i];
+    }
+    ClobberMemory();
+    const double seconds = ChronoClockNow() - start;
+    // Two arrays are read and one is written, as STREAM counts it.
+    if (seconds > 0) {
+      best = std::max(best, 3.0 * static_cast<double>(array_bytes) / seconds);
+    }
+  }
+  DoNotOptimize(a.data());
+  return best;
+}
+
+}  // namespace
+
+std::vector<int64_t> WorkingSetSizes(
+    const std::vector<CPUInfo::CacheInfo>& caches) {
+  std::vector<int64_t> levels;
+  for (const auto& level : DataCaches(caches)) {
+    levels.push_back(level.second.size);
+  }
+  if (levels.empty()) {
+    levels.assign(std::begin(kTypicalCacheSizes), std::end(kTypicalCacheSizes));
+  }
+  std::vector<int64_t> working_sets;
+  for (int64_t size : levels) {
+    working_sets.push_back(size / 2);
+    working_sets.push_back(size * 2);
+  }
+  std::sort(working_sets.begin(), working_sets.end());
+  working_sets.erase(std::unique(working_sets.begin(), working_sets.end()),
+                     working_sets.end());
+  return working_sets;
+}
+
+std::string CacheLevelOf(int64_t bytes_per_thread, int threads,
+                         const std::vector<CPUInfo::CacheInfo>& caches) {
+  const std::map<int, DataCache> levels = DataCaches(caches);
+  if (levels.empty()) return "";
+  // The hardware threads of a core share the caches private to it, so the
+  // first level tells how many there are.
+  const int threads_per_core = std::max(1, levels.begin()->second.num_sharing);
+  for (const auto& level : levels) {
+    const int64_t cores_sharing =
+        std::max(1, level.second.num_sharing / threads_per_core);
+    const int64_t bytes =
+        bytes_per_thread * std::min<int64_t>(threads, cores_sharing);
+    if (bytes <= level.second.size) {
+      return "L" + std::to_string(level.first);
+    }
+  }
+  return "DRAM";
+}
+
+double GetPeakMemoryBandwidth() {
+  if (peak_memory_bandwidth < 0) {
+    peak_memory_bandwidth =
+        memory_bandwidth_probe_allowed ? MeasurePeakMemoryBandwidth() : 0;
+  }
+  return peak_memory_bandwidth;
+}
+
+void DisallowMemoryBandwidthProbe() { memory_bandwidth_probe_allowed = false; }
+
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,43 @@
+#ifndef BENCHMARK_WORKING_SET_H_
+#define BENCHMARK_WORKING_SET_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/export.h"
+#include "benchmark/sysinfo.h"
+
+namespace benchmark {
+namespace internal {
+
+// Working set sizes in bytes that straddle every data cache level: half and
+// twice the size of each level, in increasing order. Typical sizes are
+// assumed if `caches` is empty.
+BENCHMARK_EXPORT std::vector<int64_t> WorkingSetSizes(
+    const std::vector<CPUInfo::CacheInfo>& caches);
+
+// The smallest data cache level that holds the working sets of `threads`
+// threads of `bytes_per_thread` each, e.g. "L2", or "DRAM" if none does.
+// Levels private to a core hold the working set of one thread; levels shared
+// by cores hold those of the threads on the cores that share them. Empty if
+// `caches` is empty.
+BENCHMARK_EXPORT std::string CacheLevelOf(
+    int64_t bytes_per_thread, int threads,
+    const std::vector<CPUInfo::CacheInfo>& caches);
+
+// Peak memory bandwidth of a single thread in bytes per second, as measured
+// by a STREAM triad over arrays several times larger than the last level
+// cache. It is measured on first use, or is zero if that comes after
+// DisallowMemoryBandwidthProbe().
+BENCHMARK_EXPORT double GetPeakMemoryBandwidth();
+
+// Keeps GetPeakMemoryBandwidth() from measuring from now on, e.g. before
+// forking processes that run benchmarks, which would each measure it again,
+// possibly while others are being timed.
+BENCHMARK_EXPORT void DisallowMemoryBandwidthProbe();
+
+}  // namespace internal
+}  // namespace benchmark
+
+#endif  // BENCHMARK_WORKING_SET_H_
@@ -0,0 +1,132 @@
+#include <memory>
+#include <vector>
+
+#include "../src/affinity.h"
+#include "../src/commandlineflags.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_string(benchmark_filter);
+
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+LogicalCpu MakeCpu(int id, int package, int core, int node, int smt_rank) {
+  LogicalCpu cpu;
+  cpu.id = id;
+  cpu.package = package;
+  cpu.core = core;
+  cpu.node = node;
+  cpu.smt_rank = smt_rank;
+  return cpu;
+}
+
+// Two packages (one NUMA node each) with two cores of two hardware threads.
+// CPU ids are numbered the way Linux usually does: first hardware thread of
+// every core, then the SMT siblings.
+std::vector<LogicalCpu> TwoSocketTopology() {
+  return {
+      MakeCpu(0, 0, 0, 0, 0), MakeCpu(1, 0, 1, 0, 0), MakeCpu(2, 1, 0, 1, 0),
+      MakeCpu(3, 1, 1, 1, 0), MakeCpu(4, 0, 0, 0, 1), MakeCpu(5, 0, 1, 0, 1),
+      MakeCpu(6, 1, 0, 1, 1), MakeCpu(7, 1, 1, 1, 1),
+  };
+}
+
+TEST(AffinityTest, ParsePolicies) {
+  AffinityPolicy policy = kAffinityNone;
+  std::vector<int> cpus;
+  EXPECT_TRUE(ParseAffinity("", &policy, &cpus));
+  EXPECT_EQ(policy, kAffinityUnspecified);
+  EXPECT_TRUE(ParseAffinity("scatter", &policy, &cpus));
+  EXPECT_EQ(policy, kAffinityScatter);
+  EXPECT_TRUE(ParseAffinity("numa_nodes", &policy, &cpus));
+  EXPECT_EQ(policy, kAffinityNumaNodes);
+  EXPECT_TRUE(ParseAffinity("0,2,4-6", &policy, &cpus));
+  EXPECT_EQ(policy, kAffinityCpuList);
+  EXPECT_THAT(cpus, ElementsAre(0, 2, 4, 5, 6));
+
+  EXPECT_FALSE(ParseAffinity("sideways", &policy, &cpus));
+  EXPECT_FALSE(ParseAffinity("3-1", &policy, &cpus));
+  EXPECT_FALSE(ParseAffinity("1,x", &policy, &cpus));
+  EXPECT_FALSE(ParseAffinity("-1", &policy, &cpus));
+}
+
+TEST(AffinityTest, NoneDoesNotPin) {
+  EXPECT_TRUE(
+      PlanThreadAffinity(kAffinityNone, {}, TwoSocketTopology(), 4).empty());
+  EXPECT_TRUE(PlanThreadAffinity(kAffinityUnspecified, {}, TwoSocketTopology(),
+                                 4)
+                  .empty());
+}
+
+TEST(AffinityTest, Compact) {
+  EXPECT_THAT(PlanThreadAffinity(kAffinityCompact, {}, TwoSocketTopology(), 6),
+              ElementsAre(0, 4, 1, 5, 2, 6));
+}
+
+TEST(AffinityTest, Scatter) {
+  EXPECT_THAT(PlanThreadAffinity(kAffinityScatter, {}, TwoSocketTopology(), 8),
+              ElementsAre(0, 2, 1, 3, 4, 6, 5, 7));
+}
+
+TEST(AffinityTest, PhysicalCores) {
+  EXPECT_THAT(
+      PlanThreadAffinity(kAffinityPhysicalCores, {}, TwoSocketTopology(), 5),
+      ElementsAre(0, 1, 2, 3, 0));
+}
+
+TEST(AffinityTest, NumaNodes) {
+  EXPECT_THAT(
+      PlanThreadAffinity(kAffinityNumaNodes, {}, TwoSocketTopology(), 2),
+      ElementsAre(0, 2));
+}
+
+TEST(AffinityTest, CpuListWrapsAround) {
+  EXPECT_THAT(
+      PlanThreadAffinity(kAffinityCpuList, {3, 5}, TwoSocketTopology(), 3),
+      ElementsAre(3, 5, 3));
+}
+
+TEST(AffinityTest, TopologyCoversAllowedCpus) {
+  const std::vector<LogicalCpu>& topology = GetCpuTopology();
+  ASSERT_FALSE(topology.empty());
+  for (const LogicalCpu& cpu : topology) {
+    EXPECT_GE(cpu.id, 0);
+    EXPECT_GE(cpu.smt_rank, 0);
+  }
+}
+
+class CapturingReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    runs.insert(runs.end(), report.begin(), report.end());
+  }
+  std::vector<Run> runs;
+};
+
+void BM_Pinned(State& state) {
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_Pinned)->Threads(2)->Iterations(10)->Affinity(std::vector<int>{0});
+
+TEST(AffinityTest, ThreadCpusAreReported) {
+  FLAGS_benchmark_filter = "BM_Pinned";
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+  ASSERT_EQ(reporter.runs.size(), 1u);
+  EXPECT_THAT(reporter.runs[0].thread_cpus, ElementsAre(0, 0));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,186 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../src/baseline.h"
+#include "../src/commandlineflags.h"
+#include "../src/json_reader.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_string(benchmark_filter);
+BM_DECLARE_string(benchmark_baseline);
+
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(JsonReaderTest, ParsesValues) {
+  JsonValue value;
+  std::string error;
+  ASSERT_TRUE(ParseJson(
+      " {\"a\": [1, -2.5e3, true, null], \"b\": \"x\\\"\\u00e9\", "
+      "\"c\": {}, \"d\": NaN, \"e\": -Infinity}",
+      &value, &error))
+      << error;
+  ASSERT_EQ(value.type, JsonValue::kObject);
+  const JsonValue* a = value.Find("a");
+  ASSERT_NE(a, nullptr);
+  ASSERT_EQ(a->values.size(), 4u);
+  EXPECT_EQ(a->values[0].number, 1);
+  EXPECT_EQ(a->values[1].number, -2500);
+  EXPECT_TRUE(a->values[2].boolean);
+  EXPECT_EQ(a->values[3].type, JsonValue::kNull);
+  EXPECT_EQ(value.Find("b")->string, "x\"\xc3\xa9");
+  EXPECT_EQ(value.Find("c")->type, JsonValue::kObject);
+  EXPECT_TRUE(std::isnan(value.Find("d")->number));
+  EXPECT_TRUE(std::isinf(value.Find("e")->number));
+  EXPECT_EQ(value.Find("missing"), nullptr);
+}
+
+TEST(JsonReaderTest, RejectsMalformedInput) {
+  JsonValue value;
+  std::string error;
+  EXPECT_FALSE(ParseJson("{\"a\": 1", &value, &error));
+  EXPECT_FALSE(ParseJson("[1,]", &value, &error));
+  EXPECT_FALSE(ParseJson("{} x", &value, &error));
+  EXPECT_FALSE(ParseJson("\"abc", &value, &error));
+  EXPECT_FALSE(error.empty());
+}
+
+TEST(BaselineTest, ParsesDocumentAndLines) {
+  const std::string run =
+      "{\"name\": \"BM_A\", \"run_name\": \"BM_A\", \"run_type\": "
+      "\"iteration\", \"real_time\": 2.0, \"cpu_time\": 1.0, "
+      "\"time_unit\": \"us\"}";
+  const std::string error_run =
+      "{\"name\": \"BM_A\", \"run_name\": \"BM_A\", \"run_type\": "
+      "\"iteration\", \"error_occurred\": true, \"real_time\": 0, "
+      "\"cpu_time\": 0, \"time_unit\": \"us\"}";
+  const std::string median =
+      "{\"name\": \"BM_B_median\", \"run_name\": \"BM_B\", \"run_type\": "
+      "\"aggregate\", \"aggregate_name\": \"median\", \"real_time\": 3.0, "
+      "\"cpu_time\": 3.0, \"time_unit\": \"ms\"}";
+
+  Baseline baseline;
+  std::string error;
+  ASSERT_TRUE(ParseBaseline("{\"context\": {}, \"benchmarks\": [" + run +
+                                ", " + error_run + ", " + run + ", " +
+                                median + "]}",
+                            &baseline, &error))
+      << error;
+  ASSERT_EQ(baseline.size(), 2u);
+  EXPECT_THAT(baseline["BM_A"].real_time, ElementsAre(2e-6, 2e-6));
+  EXPECT_THAT(baseline["BM_A"].cpu_time, ElementsAre(1e-6, 1e-6));
+  EXPECT_THAT(baseline["BM_B"].real_time, ElementsAre(3e-3));
+
+  ASSERT_TRUE(ParseBaseline("{\"context\": {}}\n" + run + "\n" + run +
+                                "\n{\"name\": \"BM_",
+                            &baseline, &error))
+      << error;
+  EXPECT_THAT(baseline["BM_A"].real_time, ElementsAre(2e-6, 2e-6));
+
+  EXPECT_FALSE(ParseBaseline("{\"context\": {}}\n{\"na\n" + run, &baseline,
+                             &error));
+  EXPECT_FALSE(ParseBaseline("not json", &baseline, &error));
+}
+
+TEST(BaselineTest, ParsesMaxRegression) {
+  double fraction = 0;
+  EXPECT_TRUE(ParseMaxRegression("3%", &fraction));
+  EXPECT_DOUBLE_EQ(fraction, 0.03);
+  EXPECT_TRUE(ParseMaxRegression("0.1", &fraction));
+  EXPECT_DOUBLE_EQ(fraction, 0.1);
+  EXPECT_FALSE(ParseMaxRegression("", &fraction));
+  EXPECT_FALSE(ParseMaxRegression("%", &fraction));
+  EXPECT_FALSE(ParseMaxRegression("-1%", &fraction));
+  EXPECT_FALSE(ParseMaxRegression("3%%", &fraction));
+}
+
+TEST(BaselineTest, Verdicts) {
+  const std::vector<double> base = {1.0, 1.0, 1.0};
+  EXPECT_EQ(CompareToBaseline({1.0, 1.01}, base, 0.03).verdict,
+            kBaselineUndecided);
+  BaselineComparison c = CompareToBaseline({1.0, 1.01, 0.99}, base, 0.03);
+  EXPECT_EQ(c.verdict, kBaselineWithinTolerance);
+  EXPECT_DOUBLE_EQ(c.diff, 0);
+  c = CompareToBaseline({1.2, 1.21, 1.19}, base, 0.03);
+  EXPECT_EQ(c.verdict, kBaselineRegressed);
+  EXPECT_TRUE(c.Regressed(0.03));
+  // Too noisy to tell: the median decides.
+  c = CompareToBaseline({0.5, 1.5, 1.06}, base, 0.03);
+  EXPECT_EQ(c.verdict, kBaselineUndecided);
+  EXPECT_TRUE(c.Regressed(0.03));
+}
+
+void BM_Stable(State& state) {
+  for (auto _ : state) {
+    state.SetIterationTime(1e-3);
+  }
+}
+BENCHMARK(BM_Stable)->UseManualTime()->Iterations(2)->Repetitions(10);
+BENCHMARK(BM_Stable)
+    ->Name("BM_Slower")
+    ->UseManualTime()
+    ->Iterations(2)
+    ->Repetitions(10);
+
+class CapturingReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    runs.insert(runs.end(), report.begin(), report.end());
+  }
+  std::vector<Run> runs;
+};
+
+TEST(BaselineTest, StopsEarlyAndCountsRegressions) {
+  const std::string path = "baseline_gtest_report.json";
+  {
+    std::ofstream f(path);
+    f << "{\"context\": {}, \"benchmarks\": [";
+    const char* const kRuns[][2] = {
+        {"BM_Stable/iterations:2/repeats:10/manual_time", "1.0"},
+        {"BM_Slower/iterations:2/repeats:10/manual_time", "0.5"}};
+    for (const auto& r : kRuns) {
+      f << (&r == &kRuns[0] ? "" : ", ") << "{\"run_name\": \"" << r[0]
+        << "\", \"run_type\": \"iteration\", \"real_time\": " << r[1]
+        << ", \"cpu_time\": 0, \"time_unit\": \"ms\"}";
+    }
+    f << "]}";
+  }
+  FLAGS_benchmark_filter = "BM_Stable|BM_Slower";
+  FLAGS_benchmark_baseline = path;
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+  FLAGS_benchmark_baseline = "";
+  std::remove(path.c_str());
+
+  std::vector<std::string> iterations;
+  std::vector<std::string> labels;
+  for (const BenchmarkReporter::Run& run : reporter.runs) {
+    if (run.run_type == BenchmarkReporter::Run::RT_Iteration) {
+      iterations.push_back(run.run_name.function_name);
+    } else if (run.aggregate_name == "baseline_diff") {
+      labels.push_back(run.report_label);
+    }
+  }
+  // Both are clear after the minimum of three repetitions.
+  EXPECT_THAT(iterations, ElementsAre("BM_Stable", "BM_Stable", "BM_Stable",
+                                      "BM_Slower", "BM_Slower", "BM_Slower"));
+  EXPECT_THAT(labels, ElementsAre("", "REGRESSION"));
+  EXPECT_EQ(GetBaselineRegressionCount(), 1u);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
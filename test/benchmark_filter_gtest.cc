@@ -0,0 +1,110 @@
+#include <string>
+#include <vector>
+
+#include "../src/benchmark_filter.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(GlobMatchTest, MatchesWholeNames) {
+  EXPECT_TRUE(GlobMatch("BM_Foo", "BM_Foo"));
+  EXPECT_FALSE(GlobMatch("BM_Foo", "BM_Foo/8"));
+  EXPECT_FALSE(GlobMatch("BM_Foo", "BM_Fo"));
+  EXPECT_TRUE(GlobMatch("BM_Foo/*", "BM_Foo/8/threads:2"));
+  EXPECT_TRUE(GlobMatch("*/threads:2", "BM_Foo/8/threads:2"));
+  EXPECT_TRUE(GlobMatch("BM_*/8*", "BM_Foo/8/threads:2"));
+  EXPECT_FALSE(GlobMatch("BM_*/9*", "BM_Foo/8/threads:2"));
+  EXPECT_TRUE(GlobMatch("BM_Fo?", "BM_Foo"));
+  EXPECT_FALSE(GlobMatch("BM_Fo?", "BM_Fo"));
+  EXPECT_TRUE(GlobMatch("**", ""));
+  EXPECT_TRUE(GlobMatch("*a*a*a", "aaaa"));
+  EXPECT_FALSE(GlobMatch("*a*a*b", "aaaa"));
+}
+
+TEST(RegexLiteralPrefixTest, AnchoredLiterals) {
+  EXPECT_EQ(RegexLiteralPrefix("^BM_Foo"), "BM_Foo");
+  EXPECT_EQ(RegexLiteralPrefix("^BM_Foo/8$"), "BM_Foo/8");
+  EXPECT_EQ(RegexLiteralPrefix("^BM_Foo.*"), "BM_Foo");
+  EXPECT_EQ(RegexLiteralPrefix("^BM_\\.Foo"), "BM_.Foo");
+  EXPECT_EQ(RegexLiteralPrefix("^BM_\\d"), "BM_");
+  EXPECT_EQ(RegexLiteralPrefix("^BM_Foo+"), "BM_Foo");
+}
+
+TEST(RegexLiteralPrefixTest, OptionalCharactersEndThePrefix) {
+  EXPECT_EQ(RegexLiteralPrefix("^BM_Foo?"), "BM_Fo");
+  EXPECT_EQ(RegexLiteralPrefix("^BM_Foo*"), "BM_Fo");
+  EXPECT_EQ(RegexLiteralPrefix("^BM_Foo{0,1}"), "BM_Fo");
+  EXPECT_EQ(RegexLiteralPrefix("^BM_(Foo)"), "BM_");
+}
+
+TEST(RegexLiteralPrefixTest, NoPrefix) {
+  EXPECT_EQ(RegexLiteralPrefix("BM_Foo"), "");
+  EXPECT_EQ(RegexLiteralPrefix("^BM_Foo|^BM_Bar"), "");
+  EXPECT_EQ(RegexLiteralPrefix("^.*Foo"), "");
+  EXPECT_EQ(RegexLiteralPrefix(""), "");
+}
+
+TEST(BenchmarkFilterTest, Regex) {
+  BenchmarkFilter filter;
+  std::string error;
+  ASSERT_TRUE(filter.Init("Foo/[0-9]+", &error));
+  EXPECT_TRUE(filter.Match("BM_Foo/8"));
+  EXPECT_FALSE(filter.Match("BM_Foo"));
+  std::vector<std::string> prefixes;
+  EXPECT_FALSE(filter.LiteralPrefixes(&prefixes));
+}
+
+TEST(BenchmarkFilterTest, NegativeRegex) {
+  BenchmarkFilter filter;
+  std::string error;
+  ASSERT_TRUE(filter.Init("-^BM_Foo", &error));
+  EXPECT_FALSE(filter.Match("BM_Foo/8"));
+  EXPECT_TRUE(filter.Match("BM_Bar"));
+  std::vector<std::string> prefixes;
+  EXPECT_FALSE(filter.LiteralPrefixes(&prefixes));
+}
+
+TEST(BenchmarkFilterTest, AnchoredRegexHasPrefix) {
+  BenchmarkFilter filter;
+  std::string error;
+  ASSERT_TRUE(filter.Init("^BM_Foo/8", &error));
+  std::vector<std::string> prefixes;
+  EXPECT_TRUE(filter.LiteralPrefixes(&prefixes));
+  EXPECT_THAT(prefixes, ElementsAre("BM_Foo/8"));
+}
+
+TEST(BenchmarkFilterTest, Globs) {
+  BenchmarkFilter filter;
+  std::string error;
+  ASSERT_TRUE(filter.Init("glob:BM_Foo/*,BM_Bar", &error));
+  EXPECT_TRUE(filter.Match("BM_Foo/8"));
+  EXPECT_TRUE(filter.Match("BM_Bar"));
+  EXPECT_FALSE(filter.Match("BM_Bar/8"));
+  std::vector<std::string> prefixes;
+  EXPECT_TRUE(filter.LiteralPrefixes(&prefixes));
+  EXPECT_THAT(prefixes, ElementsAre("BM_Foo/", "BM_Bar"));
+}
+
+TEST(BenchmarkFilterTest, GlobWithoutPrefix) {
+  BenchmarkFilter filter;
+  std::string error;
+  ASSERT_TRUE(filter.Init("glob:BM_Foo,*/8", &error));
+  std::vector<std::string> prefixes;
+  EXPECT_FALSE(filter.LiteralPrefixes(&prefixes));
+}
+
+TEST(BenchmarkFilterTest, EmptyGlobIsAnError) {
+  std::string error;
+  EXPECT_FALSE(BenchmarkFilter().Init("glob:", &error));
+  EXPECT_FALSE(BenchmarkFilter().Init("glob:BM_Foo,", &error));
+  EXPECT_FALSE(error.empty());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
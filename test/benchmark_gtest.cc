@@ -1,9 +1,12 @@
 #include <map>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include "../src/benchmark_api_internal.h"
 #include "../src/benchmark_register.h"
 #include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -135,6 +138,68 @@ TEST(AddRangeTest, Simple8) {
               testing::ElementsAre(int8_t{1}, int8_t{2}, int8_t{4}, int8_t{8}));
 }
 
+std::vector<std::vector<int64_t>> ProductArgs(
+    const std::vector<std::vector<int64_t>>& arglists) {
+  std::vector<std::vector<int64_t>> args;
+  for (ArgsProductIterator it(arglists); !it.done(); it.Next()) {
+    args.push_back(it.args());
+  }
+  return args;
+}
+
+TEST(ArgsProductIteratorTest, FirstArgumentChangesFastest) {
+  EXPECT_THAT(ProductArgs({{1, 2}, {15}, {3, 7}}),
+              testing::ElementsAre(std::vector<int64_t>{1, 15, 3},
+                                   std::vector<int64_t>{2, 15, 3},
+                                   std::vector<int64_t>{1, 15, 7},
+                                   std::vector<int64_t>{2, 15, 7}));
+  EXPECT_EQ(ArgsProductSize({{1, 2}, {15}, {3, 7}}), 4u);
+}
+
+TEST(ArgsProductIteratorTest, EmptyProducts) {
+  EXPECT_THAT(ProductArgs({}),
+              testing::ElementsAre(std::vector<int64_t>{}));
+  EXPECT_EQ(ArgsProductSize({}), 1u);
+  EXPECT_THAT(ProductArgs({{1, 2}, {}}), testing::IsEmpty());
+  EXPECT_EQ(ArgsProductSize({{1, 2}, {}}), 0u);
+}
+
+void BM_LazyArgsDummy(State& state) {
+  for (auto _ : state) {
+  }
+}
+
+std::vector<std::string> FoundNames(const std::string& filter) {
+  std::vector<BenchmarkInstance> benchmarks;
+  std::ostringstream err;
+  EXPECT_TRUE(FindBenchmarksInternal(filter, &benchmarks, &err));
+  std::vector<std::string> names;
+  for (const BenchmarkInstance& benchmark : benchmarks) {
+    names.push_back(benchmark.name().str());
+  }
+  return names;
+}
+
+TEST(FindBenchmarksTest, MatchesProductsBeforeCreatingInstances) {
+  static Benchmark* const family =
+      RegisterBenchmark("BM_LazyArgs", BM_LazyArgsDummy)
+          ->Arg(1)
+          ->DenseRange(2, 3)
+          ->ArgsProduct({{10, 20, 30}})
+          ->Threads(1)
+          ->Threads(2);
+  EXPECT_EQ(family->ArgsCnt(), 1);
+  EXPECT_THAT(FoundNames("BM_LazyArgs/(1|3|30)/"),
+              testing::ElementsAre("BM_LazyArgs/1/threads:1",
+                                   "BM_LazyArgs/1/threads:2",
+                                   "BM_LazyArgs/3/threads:1",
+                                   "BM_LazyArgs/3/threads:2",
+                                   "BM_LazyArgs/30/threads:1",
+                                   "BM_LazyArgs/30/threads:2"));
+  EXPECT_THAT(FoundNames("BM_LazyArgs/20/threads:2"),
+              testing::ElementsAre("BM_LazyArgs/20/threads:2"));
+}
+
 TEST(AddCustomContext, Simple) {
   std::map<std::string, std::string>*& global_context = GetGlobalContext();
   EXPECT_THAT(global_context, nullptr);
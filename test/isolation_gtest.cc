@@ -0,0 +1,171 @@
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/benchmark_runner.h"
+#include "../src/commandlineflags.h"
+#include "../src/isolation.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_string(benchmark_filter);
+BM_DECLARE_string(benchmark_isolation);
+
+namespace internal {
+namespace {
+
+using ::testing::HasSubstr;
+
+RunResults MakeResults() {
+  RunResults results;
+  BenchmarkReporter::Run run;
+  run.run_name.function_name = "BM_Foo";
+  run.run_name.args = "8";
+  run.family_index = 3;
+  run.iterations = 42;
+  run.threads = 2;
+  run.thread_cpus = {0, 1};
+  run.real_accumulated_time = 1.5;
+  run.report_label = "label";
+  run.counters["bytes"] = Counter(7, Counter::kIsRate, Counter::kIs1024);
+  BenchmarkReporter::Run::ThreadResult thread;
+  thread.iterations = 21;
+  thread.counters["items"] = Counter(3);
+  run.per_thread = {thread, thread};
+  results.non_aggregates = {run, run};
+  run.run_type = BenchmarkReporter::Run::RT_Aggregate;
+  run.aggregate_name = "mean";
+  results.aggregates_only = {run};
+  results.file_report_aggregates_only = true;
+  return results;
+}
+
+TEST(IsolationTest, ParseIsolation) {
+  IsolationMode mode = kIsolationProcess;
+  EXPECT_TRUE(ParseIsolation("none", &mode));
+  EXPECT_EQ(mode, kIsolationNone);
+  EXPECT_TRUE(ParseIsolation("process", &mode));
+  EXPECT_EQ(mode, kIsolationProcess);
+  EXPECT_FALSE(ParseIsolation("thread", &mode));
+}
+
+TEST(IsolationTest, SerializationRoundTrip) {
+  const RunResults results = MakeResults();
+  RunResults read;
+  ASSERT_TRUE(DeserializeRunResults(SerializeRunResults(results), &read));
+  ASSERT_EQ(read.non_aggregates.size(), 2u);
+  ASSERT_EQ(read.aggregates_only.size(), 1u);
+  EXPECT_TRUE(read.file_report_aggregates_only);
+  EXPECT_FALSE(read.display_report_aggregates_only);
+
+  const BenchmarkReporter::Run& run = read.non_aggregates[1];
+  EXPECT_EQ(run.benchmark_name(), "BM_Foo/8");
+  EXPECT_EQ(run.family_index, 3);
+  EXPECT_EQ(run.iterations, 42);
+  EXPECT_EQ(run.thread_cpus, std::vector<int>({0, 1}));
+  EXPECT_EQ(run.real_accumulated_time, 1.5);
+  EXPECT_EQ(run.report_label, "label");
+  EXPECT_EQ(run.counters.at("bytes").value, 7);
+  EXPECT_EQ(run.counters.at("bytes").flags, Counter::kIsRate);
+  EXPECT_EQ(run.counters.at("bytes").oneK, Counter::kIs1024);
+  ASSERT_EQ(run.per_thread.size(), 2u);
+  EXPECT_EQ(run.per_thread[1].iterations, 21);
+  EXPECT_EQ(run.per_thread[1].counters.at("items").value, 3);
+  EXPECT_EQ(read.aggregates_only[0].benchmark_name(), "BM_Foo/8_mean");
+}
+
+TEST(IsolationTest, RejectsMalformedData) {
+  const std::string data = SerializeRunResults(MakeResults());
+  RunResults read;
+  EXPECT_FALSE(DeserializeRunResults(data.substr(0, data.size() - 1), &read));
+  EXPECT_FALSE(DeserializeRunResults(data + "x", &read));
+  EXPECT_FALSE(DeserializeRunResults(std::string(8, '\xff'), &read));
+}
+
+TEST(IsolationTest, ChildProcessResults) {
+  if (!IsolationSupported()) {
+    GTEST_SKIP();
+  }
+  RunResults results;
+  std::string error;
+  ASSERT_TRUE(RunInChildProcess(MakeResults, 0, &results, &error)) << error;
+  EXPECT_EQ(results.non_aggregates.size(), 2u);
+}
+
+TEST(IsolationTest, ChildProcessFailures) {
+  if (!IsolationSupported()) {
+    GTEST_SKIP();
+  }
+  RunResults results;
+  std::string error;
+  EXPECT_FALSE(RunInChildProcess(
+      []() -> RunResults { std::abort(); }, 0, &results, &error));
+  EXPECT_THAT(error, HasSubstr("crashed with signal"));
+
+  EXPECT_FALSE(RunInChildProcess(
+      []() -> RunResults { std::_Exit(3); }, 0, &results, &error));
+  EXPECT_EQ(error, "exited with status 3");
+
+  EXPECT_FALSE(RunInChildProcess(
+      []() -> RunResults {
+        std::this_thread::sleep_for(std::chrono::seconds(60));
+        return RunResults();
+      },
+      0.1, &results, &error));
+  EXPECT_EQ(error, "timed out after 0.1 s");
+}
+
+class CapturingReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    runs.insert(runs.end(), report.begin(), report.end());
+  }
+  std::vector<Run> runs;
+};
+
+int parent_state = 0;
+
+void BM_Isolated(State& state) {
+  if (state.range(0) == 1) {
+    std::raise(SIGSEGV);
+  }
+  ++parent_state;
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_Isolated)->Arg(0)->Arg(1)->Arg(2)->Iterations(10);
+
+TEST(IsolationTest, CrashOnlyFailsItsInstance) {
+  if (!IsolationSupported()) {
+    GTEST_SKIP();
+  }
+  FLAGS_benchmark_filter = "BM_Isolated";
+  FLAGS_benchmark_isolation = "process";
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+  FLAGS_benchmark_isolation = "none";
+
+  ASSERT_EQ(reporter.runs.size(), 3u);
+  EXPECT_EQ(reporter.runs[0].skipped, NotSkipped);
+  EXPECT_EQ(reporter.runs[0].iterations, 10);
+  EXPECT_EQ(reporter.runs[1].benchmark_name(), "BM_Isolated/1/iterations:10");
+  EXPECT_EQ(reporter.runs[1].skipped, SkippedWithError);
+  EXPECT_THAT(reporter.runs[1].skip_message,
+              HasSubstr("benchmark process crashed with signal"));
+  EXPECT_EQ(reporter.runs[2].skipped, NotSkipped);
+  // The benchmarks ran in the children only.
+  EXPECT_EQ(parent_state, 0);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,145 @@
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/commandlineflags.h"
+#include "../src/cycleclock.h"
+#include "../src/latency_histogram.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_string(benchmark_filter);
+
+namespace internal {
+namespace {
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram histogram;
+  for (int64_t v = 1; v <= 100; ++v) {
+    histogram.Record(v);
+  }
+  EXPECT_EQ(histogram.count(), 100);
+  EXPECT_EQ(histogram.max(), 100);
+  EXPECT_EQ(histogram.ValueAtQuantile(0.0), 1);
+  EXPECT_EQ(histogram.ValueAtQuantile(0.5), 50);
+  EXPECT_EQ(histogram.ValueAtQuantile(0.99), 99);
+  EXPECT_EQ(histogram.ValueAtQuantile(1.0), 100);
+}
+
+TEST(LatencyHistogramTest, LargeValuesHaveBoundedRelativeError) {
+  LatencyHistogram histogram;
+  for (int64_t v = 1; v <= 100000; ++v) {
+    histogram.Record(v * 1000);
+  }
+  const double max_error = 1.0 / (1 << (LatencyHistogram::kSubBucketBits - 1));
+  for (double q : {0.5, 0.9, 0.99, 0.999}) {
+    const double expected = q * 1e8;
+    EXPECT_NEAR(static_cast<double>(histogram.ValueAtQuantile(q)), expected,
+                expected * max_error)
+        << "quantile " << q;
+  }
+  EXPECT_EQ(histogram.max(), 100000000);
+}
+
+TEST(LatencyHistogramTest, MergeAddsCounts) {
+  LatencyHistogram a;
+  LatencyHistogram b;
+  a.Record(10);
+  b.Record(20);
+  b.Record(-5);  // Clamped to zero.
+  a.Merge(b);
+  EXPECT_EQ(a.count(), 3);
+  EXPECT_EQ(a.max(), 20);
+  EXPECT_EQ(a.ValueAtQuantile(0.0), 0);
+  a.Clear();
+  EXPECT_EQ(a.count(), 0);
+  EXPECT_EQ(a.ValueAtQuantile(0.5), 0);
+}
+
+TEST(LatencySamplerTest, ExcludesPauses) {
+  LatencySampler sampler(/*overhead_ticks=*/0);
+  sampler.Start(1);
+  ASSERT_TRUE(sampler.Next(1));
+  sampler.Pause();
+  const int64_t pause_start = cycleclock::Now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  const int64_t paused = cycleclock::Now() - pause_start;
+  sampler.Resume();
+  EXPECT_FALSE(sampler.Next(1));
+  ASSERT_EQ(sampler.histogram().count(), 1);
+  EXPECT_LT(sampler.histogram().max(), paused);
+}
+
+TEST(LatencySamplerTest, SubtractsItsOverhead) {
+  const int64_t overhead = LatencySampler::CalibratedOverhead();
+  EXPECT_GE(overhead, 0);
+  EXPECT_EQ(LatencySampler::CalibratedOverhead(), overhead);
+
+  // Samples shorter than the overhead are recorded as zero.
+  LatencySampler sampler(/*overhead_ticks=*/int64_t{1} << 40);
+  sampler.Start(2);
+  while (sampler.Next(1)) {
+  }
+  EXPECT_EQ(sampler.histogram().count(), 2);
+  EXPECT_EQ(sampler.histogram().max(), 0);
+}
+
+class CapturingReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    runs.insert(runs.end(), report.begin(), report.end());
+  }
+  std::vector<Run> runs;
+};
+
+void BM_LatencyRangeFor(State& state) {
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_LatencyRangeFor)->Iterations(100)->Threads(2)->LatencyHistogram();
+
+void BM_LatencyKeepRunning(State& state) {
+  while (state.KeepRunningBatch(4)) {
+  }
+}
+BENCHMARK(BM_LatencyKeepRunning)->Iterations(100)->LatencyHistogram();
+
+void CheckLatencyAggregates(const std::string& filter,
+                            IterationCount expected_samples) {
+  FLAGS_benchmark_filter = filter;
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+
+  ASSERT_EQ(reporter.runs.size(), 6u);
+  EXPECT_EQ(reporter.runs[0].run_type, BenchmarkReporter::Run::RT_Iteration);
+  const char* const names[] = {"p50", "p90", "p99", "p99.9", "max"};
+  double previous = 0;
+  for (size_t i = 0; i < 5; ++i) {
+    const BenchmarkReporter::Run& run = reporter.runs[i + 1];
+    EXPECT_EQ(run.run_type, BenchmarkReporter::Run::RT_Aggregate);
+    EXPECT_EQ(run.aggregate_name, names[i]);
+    EXPECT_EQ(run.iterations, expected_samples);
+    EXPECT_GE(run.GetAdjustedRealTime(), previous);
+    previous = run.GetAdjustedRealTime();
+  }
+}
+
+TEST(LatencyHistogramTest, SamplesEveryIterationOfEveryThread) {
+  CheckLatencyAggregates("BM_LatencyRangeFor", 200);
+}
+
+TEST(LatencyHistogramTest, SamplesBatches) {
+  CheckLatencyAggregates("BM_LatencyKeepRunning", 25);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,85 @@
+#include <stdlib.h>
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark_api.h"
+#include "benchmark/managers.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "benchmark/utils.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+using benchmark::MemoryManager;
+
+class TestReporter : public benchmark::ConsoleReporter {
+ public:
+  bool ReportContext(const Context& /*unused*/) override { return true; }
+  void PrintHeader(const Run&) override {}
+  void PrintRunData(const Run& run) override {
+    results.push_back(run.memory_result);
+  }
+
+  std::vector<MemoryManager::Result> results;
+};
+
+class MemoryTrackerTest : public testing::Test {
+ public:
+  void SetUp() override {
+#ifndef __GLIBC__
+    GTEST_SKIP() << "The allocation tracker needs glibc";
+#endif
+  }
+  void TearDown() override { benchmark::ClearRegisteredBenchmarks(); }
+
+  MemoryManager::Result Run() {
+    TestReporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    EXPECT_EQ(reporter.results.size(), 1u);
+    return reporter.results.empty() ? MemoryManager::Result()
+                                    : reporter.results[0];
+  }
+};
+
+TEST_F(MemoryTrackerTest, CountsAllocations) {
+  benchmark::RegisterBenchmark("BM_New",
+                               [](benchmark::State& state) {
+                                 for (auto _ : state) {
+                                   std::unique_ptr<char[]> p(new char[100]);
+                                   benchmark::DoNotOptimize(p.get());
+                                 }
+                               })
+      ->Iterations(32);
+  const MemoryManager::Result result = Run();
+  EXPECT_EQ(result.memory_iterations, 16);
+  EXPECT_GE(result.num_allocs, 16);
+  EXPECT_GE(result.total_allocated_bytes, 16 * 100);
+  EXPECT_GE(result.max_bytes_used, 100);
+  // 100 bytes fall in [64, 128).
+  EXPECT_GE(result.allocation_sizes[7], 16);
+  EXPECT_NE(result.page_faults, MemoryManager::TombstoneValue);
+}
+
+TEST_F(MemoryTrackerTest, TracksHeapGrowth) {
+  static std::vector<void*>* blocks = new std::vector<void*>();
+  blocks->reserve(64);
+  benchmark::RegisterBenchmark("BM_Leak",
+                               [](benchmark::State& state) {
+                                 for (auto _ : state) {
+                                   blocks->push_back(malloc(4096));
+                                 }
+                               })
+      ->Iterations(16);
+  const MemoryManager::Result result = Run();
+  EXPECT_GE(result.net_heap_growth, 16 * 4096);
+  EXPECT_GE(result.max_bytes_used, 16 * 4096);
+  EXPECT_GE(result.allocation_sizes[13], 16);
+  for (void* block : *blocks) {
+    free(block);
+  }
+}
+
+}  // namespace
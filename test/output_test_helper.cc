@@ -165,6 +165,19 @@ class TestReporter : public benchmark::BenchmarkReporter {
       rep->ReportRuns(report);
     }
   }
+  bool ReportRepetition(const Run& run) override {
+    bool last_ret = false;
+    bool first = true;
+    for (auto* rep : reporters_) {
+      bool new_ret = rep->ReportRepetition(run);
+      BM_CHECK(first || new_ret == last_ret)
+          << "Reports return different values for ReportRepetition";
+      first = false;
+      last_ret = new_ret;
+    }
+    (void)first;
+    return last_ret;
+  }
   void Finalize() override {
     for (auto* rep : reporters_) {
       rep->Finalize();
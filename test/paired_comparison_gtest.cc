@@ -0,0 +1,134 @@
+#include <string>
+#include <vector>
+
+#include "../src/commandlineflags.h"
+#include "../src/statistics.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_string(benchmark_filter);
+
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(PairedComparisonTest, ConsistentSpeedup) {
+  const PairedStats stats =
+      ComputePairedStats({10, 12, 10, 11, 10, 12}, {9, 10.8, 9, 9.9, 9, 10.8});
+  EXPECT_NEAR(stats.median_diff, -0.1, 1e-12);
+  EXPECT_LE(stats.ci_low, stats.median_diff);
+  EXPECT_GE(stats.ci_high, stats.median_diff);
+  EXPECT_LT(stats.ci_high, 0);
+  // All six pairs agree: 2 * 0.5^6.
+  EXPECT_DOUBLE_EQ(stats.sign_p, 0.03125);
+}
+
+TEST(PairedComparisonTest, NoDifference) {
+  const PairedStats stats = ComputePairedStats({5, 6, 7}, {5, 6, 7});
+  EXPECT_DOUBLE_EQ(stats.median_diff, 0);
+  EXPECT_DOUBLE_EQ(stats.ci_low, 0);
+  EXPECT_DOUBLE_EQ(stats.ci_high, 0);
+  EXPECT_DOUBLE_EQ(stats.sign_p, 1);
+}
+
+std::vector<std::string>* const order = new std::vector<std::string>();
+
+void BM_Old(State& state) {
+  order->push_back("old");
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_Old)->Repetitions(4)->Iterations(10);
+
+void BM_New(State& state) {
+  order->push_back("new");
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_New)->Repetitions(4)->Iterations(10)->CompareTo("BM_Old");
+
+class CapturingReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    runs.insert(runs.end(), report.begin(), report.end());
+    batches.push_back(report);
+  }
+  std::vector<Run> runs;
+  std::vector<std::vector<Run>> batches;
+};
+
+TEST(PairedComparisonTest, RepetitionsAreInterleavedAndCompared) {
+  order->clear();
+  FLAGS_benchmark_filter = "BM_Old|BM_New";
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+
+  EXPECT_THAT(*order, ElementsAre("new", "old", "old", "new", "new", "old",
+                                  "old", "new"));
+
+  std::vector<std::string> paired;
+  for (const BenchmarkReporter::Run& run : reporter.runs) {
+    if (run.aggregate_name.rfind("paired_", 0) == 0) {
+      paired.push_back(run.aggregate_name);
+      EXPECT_EQ(run.run_name.function_name, "BM_New");
+      EXPECT_EQ(run.report_label, "vs BM_Old/iterations:10/repeats:4");
+      EXPECT_EQ(run.iterations, 4);
+      EXPECT_EQ(run.aggregate_unit, run.aggregate_name == "paired_sign_p"
+                                        ? StatisticUnit::kProbability
+                                        : StatisticUnit::kPercentage);
+    }
+  }
+  EXPECT_THAT(paired, ElementsAre("paired_diff", "paired_ci_low",
+                                  "paired_ci_high", "paired_sign_p"));
+}
+
+void BM_LongBaseline(State& state) {
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_LongBaseline)->Repetitions(6)->Iterations(10);
+
+void BM_ShortCandidate(State& state) {
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_ShortCandidate)
+    ->Repetitions(3)
+    ->Iterations(10)
+    ->CompareTo("BM_LongBaseline");
+
+TEST(PairedComparisonTest, StatsBelongToTheCandidateThatFinishesFirst) {
+  FLAGS_benchmark_filter = "BM_LongBaseline|BM_ShortCandidate";
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+
+  // The candidate is reported after the baseline, together with the paired
+  // statistics: the repetitions and then the aggregates of each.
+  ASSERT_EQ(reporter.batches.size(), 4u);
+  for (size_t i = 0; i < reporter.batches.size(); ++i) {
+    for (const BenchmarkReporter::Run& run : reporter.batches[i]) {
+      EXPECT_EQ(run.run_name.function_name,
+                i < 2 ? "BM_LongBaseline" : "BM_ShortCandidate");
+    }
+  }
+  std::vector<std::string> paired;
+  for (const BenchmarkReporter::Run& run : reporter.batches[3]) {
+    if (run.aggregate_name.rfind("paired_", 0) == 0) {
+      paired.push_back(run.aggregate_name);
+    }
+  }
+  EXPECT_THAT(paired, ElementsAre("paired_diff", "paired_ci_low",
+                                  "paired_ci_high", "paired_sign_p"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/commandlineflags.h"
+#include "../src/isolation.h"
+#include "../src/parallel_jobs.h"
+#include "../src/timers.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_string(benchmark_filter);
+BM_DECLARE_int32(benchmark_parallel_jobs);
+
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+LogicalCpu MakeCpu(int id, int package, int core, int smt_rank) {
+  LogicalCpu cpu;
+  cpu.id = id;
+  cpu.package = package;
+  cpu.core = core;
+  cpu.node = package;
+  cpu.smt_rank = smt_rank;
+  return cpu;
+}
+
+// Two packages with two cores of two hardware threads each.
+std::vector<LogicalCpu> TwoSocketTopology() {
+  return {MakeCpu(0, 0, 0, 0), MakeCpu(1, 0, 1, 0), MakeCpu(2, 1, 0, 0),
+          MakeCpu(3, 1, 1, 0), MakeCpu(4, 0, 0, 1), MakeCpu(5, 0, 1, 1),
+          MakeCpu(6, 1, 0, 1), MakeCpu(7, 1, 1, 1)};
+}
+
+TEST(ParallelJobsTest, OneJobPerPhysicalCore) {
+  EXPECT_THAT(PlanParallelJobCpus(2, TwoSocketTopology()), ElementsAre(0, 2));
+  EXPECT_THAT(PlanParallelJobCpus(4, TwoSocketTopology()),
+              ElementsAre(0, 2, 1, 3));
+  // SMT siblings are never used.
+  EXPECT_THAT(PlanParallelJobCpus(8, TwoSocketTopology()),
+              ElementsAre(0, 2, 1, 3));
+}
+
+// A job that records which slot it ran in, and when.
+ChildJob TimedJob(double seconds, bool exclusive) {
+  ChildJob job;
+  job.exclusive = exclusive;
+  job.fn = [seconds](int slot) {
+    BenchmarkReporter::Run run;
+    run.iterations = slot;
+    run.real_accumulated_time = ChronoClockNow();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    run.cpu_accumulated_time = ChronoClockNow();
+    RunResults results;
+    results.non_aggregates.push_back(run);
+    return results;
+  };
+  return job;
+}
+
+TEST(ParallelJobsTest, RunsJobsInParallelAndReportsInOrder) {
+  if (!IsolationSupported()) {
+    GTEST_SKIP();
+  }
+  const std::vector<ChildJob> jobs = {
+      TimedJob(0.3, false), TimedJob(0.1, false), TimedJob(0.1, false),
+      TimedJob(0.1, true), TimedJob(0.1, false)};
+  std::vector<size_t> order;
+  std::vector<BenchmarkReporter::Run> runs;
+  RunInChildProcesses(jobs, 3, 0,
+                      [&](size_t job, bool ok, RunResults& results,
+                          const std::string& error) {
+                        ASSERT_TRUE(ok) << error;
+                        order.push_back(job);
+                        runs.push_back(results.non_aggregates[0]);
+                      });
+  ASSERT_THAT(order, ElementsAre(0, 1, 2, 3, 4));
+
+  // The first three ran at the same time, in slots of their own.
+  EXPECT_THAT(std::vector<int64_t>({runs[0].iterations, runs[1].iterations,
+                                    runs[2].iterations}),
+              ::testing::UnorderedElementsAre(0, 1, 2));
+  EXPECT_LT(runs[1].real_accumulated_time, runs[0].cpu_accumulated_time);
+  EXPECT_LT(runs[2].real_accumulated_time, runs[0].cpu_accumulated_time);
+  // The exclusive job ran alone, after the others and before the next one.
+  EXPECT_EQ(runs[3].iterations, -1);
+  for (size_t i : {0u, 1u, 2u}) {
+    EXPECT_GE(runs[3].real_accumulated_time, runs[i].cpu_accumulated_time);
+  }
+  EXPECT_GE(runs[4].real_accumulated_time, runs[3].cpu_accumulated_time);
+}
+
+TEST(ParallelJobsTest, SlowdownIsMeasured) {
+  if (!IsolationSupported()) {
+    GTEST_SKIP();
+  }
+  EXPECT_EQ(MeasureParallelSlowdown({0}), 0.0);
+  EXPECT_GE(MeasureParallelSlowdown({-1, -1}), 0.0);
+}
+
+class CapturingReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    for (const Run& run : report) {
+      names.push_back(run.benchmark_name());
+    }
+  }
+  std::vector<std::string> names;
+};
+
+void BM_Parallel(State& state) {
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_Parallel)->Arg(1)->Arg(2)->Arg(3)->Iterations(10);
+BENCHMARK(BM_Parallel)->Arg(4)->Threads(2)->Iterations(10);
+
+TEST(ParallelJobsTest, ResultsAreReportedInOrder) {
+  if (!IsolationSupported()) {
+    GTEST_SKIP();
+  }
+  FLAGS_benchmark_filter = "BM_Parallel";
+  FLAGS_benchmark_parallel_jobs = 2;
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+  FLAGS_benchmark_parallel_jobs = 1;
+  EXPECT_THAT(reporter.names,
+              ElementsAre("BM_Parallel/1/iterations:10",
+                          "BM_Parallel/2/iterations:10",
+                          "BM_Parallel/3/iterations:10",
+                          "BM_Parallel/4/iterations:10/threads:2"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -398,4 +398,114 @@ TEST(PerfCountersTest, HardwareLimits) {
   EXPECT_TRUE(counter.Stop(measurements));
 }
 
+TEST(PerfCountersTest, MultiplexedCountersAreScaled) {
+  if (!HasRequiredPerfCounters({kGenericPerfEvent1, kGenericPerfEvent2})) {
+    GTEST_SKIP() << "Requested performance counters are not available.";
+  }
+  // Ask for more counters than any PMU holds at once, so that they end up in
+  // several groups taking turns.
+  std::vector<std::string> names;
+  for (int i = 0; i < 12; ++i) {
+    names.push_back(i % 2 == 0 ? kGenericPerfEvent1 : kGenericPerfEvent2);
+  }
+  auto counters = PerfCounters::Create(names);
+  ASSERT_GT(counters.num_counters(), 0);
+  PerfCounterValues values(counters.num_counters());
+  ASSERT_TRUE(counters.Snapshot(&values));
+  for (size_t i = 0; i < counters.num_counters(); ++i) {
+    EXPECT_LE(values.time_running(i), values.time_enabled(i));
+    EXPECT_LT(counters.group(i), counters.num_groups());
+  }
+
+  PerfCountersMeasurement measurement(names);
+  std::vector<std::pair<std::string, double>> measurements;
+  measurement.ResetRunningFraction();
+  measurement.Start();
+  do_work();
+  EXPECT_TRUE(measurement.Stop(measurements));
+  EXPECT_EQ(measurements.size(), measurement.num_counters());
+  for (size_t i = 0; i < measurement.num_counters(); ++i) {
+    EXPECT_GE(measurement.running_fraction(i), 0.0);
+    EXPECT_LE(measurement.running_fraction(i), 1.0);
+  }
+}
+
+TEST(PerfCountersTest, RotateGroups) {
+  if (!HasRequiredPerfCounters({kGenericPerfEvent1, kGenericPerfEvent2})) {
+    GTEST_SKIP() << "Requested performance counters are not available.";
+  }
+  std::vector<std::string> names;
+  for (int i = 0; i < 12; ++i) {
+    names.push_back(i % 2 == 0 ? kGenericPerfEvent1 : kGenericPerfEvent2);
+  }
+  PerfCountersMeasurement measurement(names);
+  if (measurement.num_groups() < 2) {
+    GTEST_SKIP() << "All counters fit in one group on this PMU.";
+  }
+  for (size_t repetition = 0; repetition < measurement.num_groups();
+       ++repetition) {
+    measurement.RotateGroups(repetition);
+    measurement.ResetRunningFraction();
+    std::vector<std::pair<std::string, double>> measurements;
+    measurement.Start();
+    do_work();
+    EXPECT_TRUE(measurement.Stop(measurements));
+    size_t num_measured = 0;
+    for (size_t i = 0; i < measurement.num_counters(); ++i) {
+      if (!measurement.IsMeasured(i)) continue;
+      ++num_measured;
+      // The group has the PMU to itself, so it is counting all the time.
+      EXPECT_DOUBLE_EQ(measurement.running_fraction(i), 1.0);
+    }
+    EXPECT_GT(num_measured, 0);
+    EXPECT_LT(num_measured, measurement.num_counters());
+    EXPECT_EQ(measurements.size(), num_measured);
+  }
+}
+
+TEST(PerfCountersTest, UserSpaceReadsAgreeWithRead) {
+  if (!HasRequiredPerfCounters({kGenericPerfEvent1, kGenericPerfEvent2})) {
+    GTEST_SKIP() << "Requested performance counters are not available.";
+  }
+  auto counters =
+      PerfCounters::Create({kGenericPerfEvent1, kGenericPerfEvent2});
+  if (!counters.user_space_reads()) {
+    GTEST_SKIP() << "rdpmc is not available.";
+  }
+  PerfCounterValues fast(counters.num_counters());
+  ASSERT_TRUE(counters.Snapshot(&fast));
+  do_work();
+
+  // Another thread cannot use rdpmc on our counters and has to fall back.
+  EXPECT_TRUE(counters.CanReadUserSpace());
+  PerfCounterValues other_thread(counters.num_counters());
+  bool other_thread_ok = false;
+  bool other_thread_rdpmc = true;
+  std::thread([&] {
+    other_thread_rdpmc = counters.CanReadUserSpace();
+    other_thread_ok = counters.Snapshot(&other_thread);
+  }).join();
+  EXPECT_FALSE(other_thread_rdpmc);
+  ASSERT_TRUE(other_thread_ok);
+
+  counters.DisableUserSpaceReads();
+  EXPECT_FALSE(counters.user_space_reads());
+  PerfCounterValues slow(counters.num_counters());
+  ASSERT_TRUE(counters.Snapshot(&slow));
+  for (size_t i = 0; i < counters.num_counters(); ++i) {
+    EXPECT_GT(other_thread[i], fast[i]);
+    EXPECT_GE(slow[i], other_thread[i]);
+  }
+}
+
+TEST(PerfCountersTest, NoCountersAreNotMultiplexed) {
+  PerfCountersMeasurement measurement({});
+  EXPECT_EQ(measurement.num_groups(), 0);
+  measurement.RotateGroups(1);
+  std::vector<std::pair<std::string, double>> measurements;
+  EXPECT_TRUE(measurement.Start());
+  EXPECT_TRUE(measurement.Stop(measurements));
+  EXPECT_TRUE(measurements.empty());
+}
+
 }  // namespace
@@ -87,12 +87,38 @@ BENCHMARK(BM_WithPauseResume);
 
 ADD_CASES(TC_JSONOut, {{"\"name\": \"BM_WithPauseResume\",$"}});
 
+// Every thread counts with its own counters, so the values per iteration do
+// not depend on the number of threads.
+BENCHMARK(BM_WithoutPauseResume)->Threads(2)->ReportPerThread();
+ADD_CASES(TC_JSONOut,
+          {{"\"name\": \"BM_WithoutPauseResume/threads:2\",$"},
+           {"\"per_thread\": \\[$"}});
+
+// The cost of a snapshot of the counters, read with rdpmc where possible
+// (arg 1) or always with read() (arg 0).
+void BM_Snapshot(benchmark::State& state) {
+  auto counters = benchmark::internal::PerfCounters::Create(
+      {kGenericPerfEvent1, kGenericPerfEvent2});
+  if (state.range(0) == 0) {
+    counters.DisableUserSpaceReads();
+  }
+  state.SetLabel(counters.user_space_reads() ? "rdpmc" : "read");
+  benchmark::internal::PerfCounterValues values(counters.num_counters());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(counters.Snapshot(&values));
+  }
+}
+BENCHMARK(BM_Snapshot)->Arg(0)->Arg(1);
+ADD_CASES(TC_JSONOut, {{"\"name\": \"BM_Snapshot/0\",$"},
+                       {"\"name\": \"BM_Snapshot/1\",$"}});
+
 static void CheckSimple(Results const& e) {
   CHECK_COUNTER_VALUE(e, double, kGenericPerfEvent1, GT, 0);
 }
 
 double withoutPauseResumeInstrCount = 0.0;
 double withPauseResumeInstrCount = 0.0;
+double threadedInstrCount = 0.0;
 
 void SaveInstrCountWithoutResume(Results const& e) {
   withoutPauseResumeInstrCount = e.GetAs<double>(kGenericPerfEvent2);
@@ -102,9 +128,15 @@ void SaveInstrCountWithResume(Results const& e) {
   withPauseResumeInstrCount = e.GetAs<double>(kGenericPerfEvent2);
 }
 
+void SaveInstrCountThreaded(Results const& e) {
+  threadedInstrCount = e.GetAs<double>(kGenericPerfEvent2);
+}
+
 CHECK_BENCHMARK_RESULTS("BM_Simple", &CheckSimple);
 CHECK_BENCHMARK_RESULTS("BM_WithoutPauseResume", &SaveInstrCountWithoutResume);
 CHECK_BENCHMARK_RESULTS("BM_WithPauseResume", &SaveInstrCountWithResume);
+CHECK_BENCHMARK_RESULTS("BM_WithoutPauseResume/threads:2",
+                        &SaveInstrCountThreaded);
 }  // end namespace
 
 int main(int argc, char* argv[]) {
@@ -120,4 +152,6 @@ int main(int argc, char* argv[]) {
   BM_CHECK_GT(withPauseResumeInstrCount, kIters);
   BM_CHECK_GT(withoutPauseResumeInstrCount, kIters);
   BM_CHECK_LT(withPauseResumeInstrCount, 1.5 * withoutPauseResumeInstrCount);
+  BM_CHECK_GT(threadedInstrCount, kIters);
+  BM_CHECK_LT(threadedInstrCount, 1.5 * withoutPauseResumeInstrCount);
 }
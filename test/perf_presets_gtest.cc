@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../src/perf_presets.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+bool AllSupported(const std::string&) { return true; }
+
+// A CPU without Intel's top-down events.
+bool GenericOnly(const std::string& event) {
+  return event.find(':') == std::string::npos ||
+         event.compare(0, 10, "PERF_COUNT") == 0;
+}
+
+bool NoneSupported(const std::string&) { return false; }
+
+TEST(PerfPresetsTest, RawNamesArePassedThrough) {
+  std::vector<const PerfCounterPresetVariant*> presets;
+  EXPECT_THAT(ExpandPerfCounterPresets({"CYCLES", "INSTRUCTIONS", "CYCLES"},
+                                       &presets, &AllSupported),
+              ElementsAre("CYCLES", "INSTRUCTIONS"));
+  EXPECT_THAT(presets, IsEmpty());
+}
+
+TEST(PerfPresetsTest, ExpandsFirstSupportedVariant) {
+  std::vector<const PerfCounterPresetVariant*> presets;
+  EXPECT_THAT(
+      ExpandPerfCounterPresets({"@topdown"}, &presets, &AllSupported),
+      ElementsAre("CYCLES", "INSTRUCTIONS", "IDQ_UOPS_NOT_DELIVERED:CORE",
+                  "UOPS_ISSUED:ANY", "UOPS_RETIRED:RETIRE_SLOTS",
+                  "INT_MISC:RECOVERY_CYCLES"));
+  ASSERT_EQ(presets.size(), 1u);
+
+  presets.clear();
+  EXPECT_THAT(ExpandPerfCounterPresets({"@topdown"}, &presets, &GenericOnly),
+              ElementsAre("CYCLES", "INSTRUCTIONS",
+                          "PERF_COUNT_HW_STALLED_CYCLES_FRONTEND",
+                          "PERF_COUNT_HW_STALLED_CYCLES_BACKEND"));
+  ASSERT_EQ(presets.size(), 1u);
+}
+
+TEST(PerfPresetsTest, SharedEventsAreCountedOnce) {
+  std::vector<const PerfCounterPresetVariant*> presets;
+  const std::vector<std::string> events = ExpandPerfCounterPresets(
+      {"INSTRUCTIONS", "@branch", "@memory"}, &presets, &AllSupported);
+  EXPECT_EQ(std::count(events.begin(), events.end(), "INSTRUCTIONS"), 1);
+  EXPECT_EQ(events.front(), "INSTRUCTIONS");
+  EXPECT_EQ(events.size(), 7u);
+  EXPECT_EQ(presets.size(), 2u);
+}
+
+TEST(PerfPresetsTest, UnknownAndUnsupportedPresetsAreDropped) {
+  std::vector<const PerfCounterPresetVariant*> presets;
+  EXPECT_THAT(ExpandPerfCounterPresets({"@nope", "CYCLES"}, &presets,
+                                       &AllSupported),
+              ElementsAre("CYCLES"));
+  EXPECT_THAT(ExpandPerfCounterPresets({"@branch"}, &presets, &NoneSupported),
+              IsEmpty());
+  EXPECT_THAT(presets, IsEmpty());
+}
+
+TEST(PerfPresetsTest, DerivesTopdownMetrics) {
+  std::vector<const PerfCounterPresetVariant*> presets;
+  ExpandPerfCounterPresets({"@topdown"}, &presets, &AllSupported);
+  UserCounters counters{{"CYCLES", 1000},
+                        {"INSTRUCTIONS", 2000},
+                        {"IDQ_UOPS_NOT_DELIVERED:CORE", 400},
+                        {"UOPS_ISSUED:ANY", 2600},
+                        {"UOPS_RETIRED:RETIRE_SLOTS", 2400},
+                        {"INT_MISC:RECOVERY_CYCLES", 50}};
+  AddPerfCounterMetrics(presets, &counters);
+  EXPECT_DOUBLE_EQ(counters["ipc"].value, 2.0);
+  EXPECT_DOUBLE_EQ(counters["frontend_bound"].value, 0.1);
+  EXPECT_DOUBLE_EQ(counters["bad_speculation"].value, 0.1);
+  EXPECT_DOUBLE_EQ(counters["retiring"].value, 0.6);
+  EXPECT_NEAR(counters["backend_bound"].value, 0.2, 1e-12);
+}
+
+TEST(PerfPresetsTest, SkipsMetricsOfMissingEvents) {
+  std::vector<const PerfCounterPresetVariant*> presets;
+  ExpandPerfCounterPresets({"@memory"}, &presets, &AllSupported);
+  UserCounters counters{{"INSTRUCTIONS", 1e6},
+                        {"PERF_COUNT_HW_CACHE_L1D:READ:ACCESS", 4e5},
+                        {"PERF_COUNT_HW_CACHE_L1D:READ:MISS", 2e4},
+                        {"PERF_COUNT_HW_CACHE_LL:READ:ACCESS", 0}};
+  AddPerfCounterMetrics(presets, &counters);
+  EXPECT_DOUBLE_EQ(counters["l1d_miss_rate"].value, 0.05);
+  EXPECT_DOUBLE_EQ(counters["l1d_mpki"].value, 20);
+  EXPECT_EQ(counters.count("llc_miss_rate"), 0u);
+  EXPECT_EQ(counters.count("llc_mpki"), 0u);
+}
+
+TEST(PerfPresetsTest, KeepsExistingCounters) {
+  std::vector<const PerfCounterPresetVariant*> presets;
+  ExpandPerfCounterPresets({"@branch"}, &presets, &AllSupported);
+  UserCounters counters{{"INSTRUCTIONS", 1000},
+                        {"PERF_COUNT_HW_BRANCH_INSTRUCTIONS", 200},
+                        {"PERF_COUNT_HW_BRANCH_MISSES", 10},
+                        {"branch_mpki", 42}};
+  AddPerfCounterMetrics(presets, &counters);
+  EXPECT_DOUBLE_EQ(counters["branch_miss_rate"].value, 0.05);
+  EXPECT_DOUBLE_EQ(counters["branch_mpki"].value, 42);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -1132,6 +1132,39 @@ void BM_CSV_Format(benchmark::State& state) {
 }
 BENCHMARK(BM_CSV_Format);
 ADD_CASES(TC_CSVOut, {{"^\"BM_CSV_Format\",,,,,,,,true,\"\"\"freedom\"\"\"$"}});
+
+// ========================================================================= //
+// ------------------------ Testing Per-Thread Output ---------------------- //
+// ========================================================================= //
+
+void BM_per_thread(benchmark::State& state) {
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_per_thread)->Threads(2)->ReportPerThread();
+
+ADD_CASES(TC_JSONOut,
+          {{"\"name\": \"BM_per_thread/threads:2\",$"},
+           {"\"threads\": 2,$"},
+           {"\"iterations\": %int,$", MR_Next},
+           {"\"real_time\": %float,$", MR_Next},
+           {"\"cpu_time\": %float,$", MR_Next},
+           {"\"time_unit\": \"ns\",$", MR_Next},
+           {"\"per_thread\": [[]$", MR_Next},
+           {"[{]\"thread_index\": 0, \"iterations\": %int, \"real_time\": "
+            "%float, \"cpu_time\": %float, "
+            "\"barrier_wait_time\": %float, \"start_delay\": %float[}],$",
+            MR_Next},
+           {"[{]\"thread_index\": 1, \"iterations\": %int, \"real_time\": "
+            "%float, \"cpu_time\": %float, "
+            "\"barrier_wait_time\": %float, \"start_delay\": %float[}]$",
+            MR_Next},
+           {"^[ ]*[]],$", MR_Next},
+           {"\"thread_max_min_ratio\": %float,$", MR_Next},
+           {"\"thread_straggler_time\": %float,$", MR_Next},
+           {"\"thread_barrier_wait_time\": %float,$", MR_Next},
+           {"\"thread_start_skew\": %float$", MR_Next},
+           {"}", MR_Next}});
 }  // end namespace
 
 // ========================================================================= //
@@ -0,0 +1,85 @@
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "../src/sampling_profiler.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(SamplingProfilerTest, ParsesCallchain) {
+  ProfileCallchain callchain = PC_None;
+  EXPECT_TRUE(ParseProfileCallchain("fp", &callchain));
+  EXPECT_EQ(callchain, PC_FramePointer);
+  EXPECT_TRUE(ParseProfileCallchain("lbr", &callchain));
+  EXPECT_EQ(callchain, PC_LBR);
+  EXPECT_TRUE(ParseProfileCallchain("none", &callchain));
+  EXPECT_EQ(callchain, PC_None);
+  EXPECT_FALSE(ParseProfileCallchain("dwarf", &callchain));
+  EXPECT_FALSE(ParseProfileCallchain("", &callchain));
+}
+
+TEST(SamplingProfilerTest, SanitizesFileName) {
+  EXPECT_EQ(ProfileFileName("BM_Copy/8/real_time"),
+            "BM_Copy_8_real_time.folded");
+  EXPECT_EQ(ProfileFileName("BM_Template<int, 2>/threads:4"),
+            "BM_Template_int__2__threads_4.folded");
+  EXPECT_EQ(ProfileFileName("BM_Range/x=1"), "BM_Range_x=1.folded");
+}
+
+#ifdef BENCHMARK_OS_LINUX
+std::string ReadFile(const std::string& path) {
+  std::ifstream in(path);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+TEST(SamplingProfilerTest, WritesSymbolizedCollapsedStacks) {
+  const uint64_t getpid_address = reinterpret_cast<uint64_t>(&getpid);
+  SampledStacks stacks;
+  stacks[{getpid_address, 0x10}] = 3;
+  const std::string path = ::testing::TempDir() + "sampling_profiler.folded";
+  ASSERT_TRUE(WriteFoldedStacks(stacks, path));
+  const std::string folded = ReadFile(path);
+  std::remove(path.c_str());
+  // The outermost frame comes first.
+  EXPECT_EQ(folded.compare(0, 5, "0x10;"), 0) << folded;
+  EXPECT_THAT(folded, HasSubstr("getpid 3\n"));
+}
+
+volatile uint64_t sink;
+
+TEST(SamplingProfilerTest, SamplesProfilingPass) {
+  if (!SamplingProfiler::IsSupported()) {
+    GTEST_SKIP() << "perf_event_open is not available";
+  }
+  SamplingProfiler profiler(PC_FramePointer);
+  profiler.AfterSetupStart();
+  uint64_t x = 1;
+  for (uint64_t i = 0; i < 200000000; ++i) {
+    x = x * 6364136223846793005u + 1442695040888963407u;
+  }
+  sink = x;
+  profiler.BeforeTeardownStop();
+  SampledStacks stacks;
+  profiler.TakeSamples(&stacks);
+  EXPECT_FALSE(stacks.empty());
+  SampledStacks again;
+  profiler.TakeSamples(&again);
+  EXPECT_TRUE(again.empty());
+}
+#endif
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
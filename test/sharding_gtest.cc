@@ -0,0 +1,118 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/baseline.h"
+#include "../src/benchmark_api_internal.h"
+#include "../src/sharding.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/state.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(ShardingTest, BalancesHeaviestFirst) {
+  EXPECT_THAT(BalanceShards({1, 5, 3, 2, 2}, 2), ElementsAre(1, 0, 1, 1, 0));
+  EXPECT_THAT(BalanceShards({1, 1, 1, 1}, 3), ElementsAre(0, 1, 2, 0));
+  EXPECT_THAT(BalanceShards({}, 2), IsEmpty());
+}
+
+TEST(ShardingTest, ParsesDurations) {
+  const std::string run =
+      "{\"name\": \"BM_A\", \"run_name\": \"BM_A\", \"run_type\": "
+      "\"iteration\", \"iterations\": 1000, \"real_time\": 2.0, "
+      "\"cpu_time\": 1.0, \"time_unit\": \"us\"}";
+  const std::string mean =
+      "{\"name\": \"BM_A_mean\", \"run_name\": \"BM_A\", \"run_type\": "
+      "\"aggregate\", \"aggregate_name\": \"mean\", \"iterations\": 2, "
+      "\"real_time\": 2.0, \"cpu_time\": 1.0, \"time_unit\": \"us\"}";
+
+  RunDurations durations;
+  std::string error;
+  ASSERT_TRUE(ParseRunDurations("{\"context\": {}, \"benchmarks\": [" + run +
+                                    ", " + run + ", " + mean + "]}",
+                                &durations, &error))
+      << error;
+  ASSERT_EQ(durations.size(), 1u);
+  EXPECT_DOUBLE_EQ(durations["BM_A"], 4e-3);
+
+  ASSERT_TRUE(ParseRunDurations("{\"context\": {}}\n" + run + "\n",
+                                &durations, &error))
+      << error;
+  EXPECT_DOUBLE_EQ(durations["BM_A"], 2e-3);
+  EXPECT_FALSE(ParseRunDurations("not json", &durations, &error));
+}
+
+void BM_ShardDummy(State& state) {
+  for (auto _ : state) {
+  }
+}
+
+std::vector<BenchmarkInstance> FindShardBenchmarks() {
+  static Benchmark* const families[] = {
+      RegisterBenchmark("BM_Shard", BM_ShardDummy)->DenseRange(1, 4),
+      RegisterBenchmark("BM_ShardComplexity", BM_ShardDummy)
+          ->DenseRange(1, 3)
+          ->Complexity(),
+      RegisterBenchmark("BM_ShardCandidate", BM_ShardDummy)
+          ->Arg(1)
+          ->CompareTo("BM_Shard"),
+  };
+  (void)families;
+  std::vector<BenchmarkInstance> benchmarks;
+  std::ostringstream err;
+  EXPECT_TRUE(FindBenchmarksInternal("^BM_Shard", &benchmarks, &err));
+  return benchmarks;
+}
+
+std::vector<std::string> ShardNames(
+    const std::vector<BenchmarkInstance>& benchmarks,
+    const RunDurations& durations, int shard_index, int shard_count) {
+  std::vector<std::string> names;
+  for (size_t i :
+       SelectShard(benchmarks, durations, shard_index, shard_count)) {
+    names.push_back(benchmarks[i].name().str());
+  }
+  return names;
+}
+
+TEST(ShardingTest, KeepsGroupsTogether) {
+  const std::vector<BenchmarkInstance> benchmarks = FindShardBenchmarks();
+  ASSERT_EQ(benchmarks.size(), 8u);
+  // Without durations, the groups are {BM_Shard/1, BM_ShardCandidate/1},
+  // BM_Shard/2, BM_Shard/3, BM_Shard/4 and the three complexity instances.
+  EXPECT_THAT(ShardNames(benchmarks, {}, 0, 2),
+              ElementsAre("BM_Shard/3", "BM_ShardComplexity/1",
+                          "BM_ShardComplexity/2", "BM_ShardComplexity/3"));
+  EXPECT_THAT(ShardNames(benchmarks, {}, 1, 2),
+              ElementsAre("BM_Shard/1", "BM_Shard/2", "BM_Shard/4",
+                          "BM_ShardCandidate/1"));
+}
+
+TEST(ShardingTest, BalancesDurations) {
+  const std::vector<BenchmarkInstance> benchmarks = FindShardBenchmarks();
+  // The instances missing from the durations count as their average, 4.8.
+  const RunDurations durations = {{"BM_Shard/4", 20},
+                                  {"BM_Shard/2", 1},
+                                  {"BM_ShardComplexity/1", 1},
+                                  {"BM_ShardComplexity/2", 1},
+                                  {"BM_ShardComplexity/3", 1},
+                                  {"BM_Missing", 100}};
+  EXPECT_THAT(ShardNames(benchmarks, durations, 0, 2),
+              ElementsAre("BM_Shard/4"));
+  EXPECT_THAT(ShardNames(benchmarks, durations, 1, 2),
+              ElementsAre("BM_Shard/1", "BM_Shard/2", "BM_Shard/3",
+                          "BM_ShardComplexity/1", "BM_ShardComplexity/2",
+                          "BM_ShardComplexity/3", "BM_ShardCandidate/1"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -2,6 +2,8 @@
 // statistics_test - Unit tests for src/statistics.cc
 //===---------------------------------------------------------------------===//
 
+#include <cmath>
+
 #include "../src/statistics.h"
 #include "gtest/gtest.h"
 
@@ -32,4 +34,12 @@ TEST(StatisticsTest, CV) {
               0.32888184094918121, 1e-15);
 }
 
+TEST(StatisticsTest, RelCI) {
+  EXPECT_DOUBLE_EQ(benchmark::StatisticsRelCI({101}), 0.0);
+  EXPECT_DOUBLE_EQ(benchmark::StatisticsRelCI({101, 101, 101, 101}), 0.0);
+  // t(0.975, 2) * stddev / sqrt(n) / mean
+  ASSERT_NEAR(benchmark::StatisticsRelCI({1, 2, 3}),
+              4.303 * 1.0 / std::sqrt(3.0) / 2.0, 1e-12);
+}
+
 }  // end namespace
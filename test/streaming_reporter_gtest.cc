@@ -0,0 +1,154 @@
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/commandlineflags.h"
+#include "../src/string_util.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_string(benchmark_filter);
+BM_DECLARE_bool(benchmark_report_aggregates_only);
+BM_DECLARE_double(benchmark_target_rel_ci);
+BM_DECLARE_double(benchmark_target_rel_ci_max_time);
+
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Everything the benchmark and the reporter saw, in order.
+std::vector<std::string>* const events = new std::vector<std::string>();
+
+void BM_Repeated(State& state) {
+  events->push_back("run");
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_Repeated)->Repetitions(2)->Iterations(10);
+
+class RecordingReporter : public BenchmarkReporter {
+ public:
+  explicit RecordingReporter(bool streams) : streams_(streams) {}
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    for (const Run& run : report) {
+      events->push_back(StrCat("runs:", run.run_type == Run::RT_Aggregate
+                                            ? run.aggregate_name
+                                            : "iteration"));
+    }
+  }
+  bool ReportRepetition(const Run& run) override {
+    if (!streams_) {
+      return false;
+    }
+    events->push_back(StrCat("repetition:", run.repetition_index));
+    return true;
+  }
+
+ private:
+  const bool streams_;
+};
+
+TEST(StreamingReporterTest, RepetitionsAreReportedAsTheyFinish) {
+  events->clear();
+  FLAGS_benchmark_filter = "BM_Repeated";
+  RecordingReporter reporter(/*streams=*/true);
+  RunSpecifiedBenchmarks(&reporter);
+  EXPECT_THAT(*events,
+              ElementsAre("run", "repetition:0", "run", "repetition:1",
+                          "runs:mean", "runs:median",
+                          "runs:stddev", "runs:cv"));
+}
+
+TEST(StreamingReporterTest, DefaultReportsInBulk) {
+  events->clear();
+  FLAGS_benchmark_filter = "BM_Repeated";
+  RecordingReporter reporter(/*streams=*/false);
+  RunSpecifiedBenchmarks(&reporter);
+  EXPECT_THAT(*events,
+              ElementsAre("run", "run", "runs:iteration", "runs:iteration",
+                          "runs:mean", "runs:median",
+                          "runs:stddev", "runs:cv"));
+}
+
+TEST(StreamingReporterTest, AggregatesOnlyIsNotStreamed) {
+  events->clear();
+  FLAGS_benchmark_filter = "BM_Repeated";
+  FLAGS_benchmark_report_aggregates_only = true;
+  RecordingReporter reporter(/*streams=*/true);
+  RunSpecifiedBenchmarks(&reporter);
+  FLAGS_benchmark_report_aggregates_only = false;
+  EXPECT_THAT(*events,
+              ElementsAre("run", "run", "runs:mean",
+                          "runs:median", "runs:stddev",
+                          "runs:cv"));
+}
+
+TEST(StreamingReporterTest, JSONLinesHasOneObjectPerLine) {
+  FLAGS_benchmark_filter = "BM_Repeated";
+  std::stringstream out;
+  JSONReporter reporter(JSONReporter::OF_Lines);
+  reporter.SetOutputStream(&out);
+  RunSpecifiedBenchmarks(&reporter);
+
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(out, line)) {
+    lines.push_back(line);
+  }
+  // The context, two repetitions and four aggregates.
+  ASSERT_EQ(lines.size(), 7u);
+  EXPECT_EQ(lines[0].rfind("{\"context\": {", 0), 0u);
+  for (size_t i = 1; i < lines.size(); ++i) {
+    EXPECT_EQ(lines[i].rfind("{\"name\": \"BM_Repeated/", 0), 0u) << lines[i];
+    EXPECT_EQ(lines[i].back(), '}') << lines[i];
+  }
+  EXPECT_THAT(lines[2], ::testing::HasSubstr("\"repetition_index\": 1,"));
+  EXPECT_THAT(lines[3], ::testing::HasSubstr("\"aggregate_name\": \"mean\","));
+}
+
+// Records the `repetitions` of every repetition, however it is reported.
+class RepetitionsReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    for (const Run& run : report) {
+      if (run.run_type == Run::RT_Iteration) {
+        repetitions.push_back(run.repetitions);
+      }
+    }
+  }
+  bool ReportRepetition(const Run& run) override {
+    repetitions.push_back(run.repetitions);
+    return true;
+  }
+  std::vector<int64_t> repetitions;
+};
+
+TEST(StreamingReporterTest, AdaptiveRepetitionsHaveTheFinalCount) {
+  FLAGS_benchmark_filter = "BM_Repeated";
+  FLAGS_benchmark_target_rel_ci = 1e-12;
+  FLAGS_benchmark_target_rel_ci_max_time = 0.05;
+  RepetitionsReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+  FLAGS_benchmark_target_rel_ci = 0;
+  FLAGS_benchmark_target_rel_ci_max_time = 5.0;
+
+  // The target cannot be met, so repetitions are added past the two planned.
+  ASSERT_GT(reporter.repetitions.size(), 2u);
+  for (int64_t repetitions : reporter.repetitions) {
+    EXPECT_EQ(repetitions, static_cast<int64_t>(reporter.repetitions.size()));
+  }
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
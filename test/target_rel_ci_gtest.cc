@@ -0,0 +1,114 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/benchmark_api_internal.h"
+#include "../src/benchmark_runner.h"
+#include "../src/commandlineflags.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_string(benchmark_filter);
+BM_DECLARE_string(benchmark_min_time);
+BM_DECLARE_double(benchmark_target_rel_ci);
+BM_DECLARE_double(benchmark_target_rel_ci_max_time);
+
+namespace internal {
+namespace {
+
+class CapturingReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    for (const Run& run : report) {
+      if (run.run_type == Run::RT_Iteration) {
+        runs.push_back(run);
+      } else {
+        aggregates.push_back(run);
+      }
+    }
+  }
+  const Run* FindAggregate(const std::string& name) const {
+    for (const Run& run : aggregates) {
+      if (run.aggregate_name == name) {
+        return &run;
+      }
+    }
+    return nullptr;
+  }
+  std::vector<Run> runs;
+  std::vector<Run> aggregates;
+};
+
+void BM_RelCI(State& state) {
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_RelCI)->Iterations(1000);
+
+void RunWithTarget(double target, double max_time,
+                   CapturingReporter* reporter) {
+  FLAGS_benchmark_filter = "BM_RelCI";
+  FLAGS_benchmark_target_rel_ci = target;
+  FLAGS_benchmark_target_rel_ci_max_time = max_time;
+  RunSpecifiedBenchmarks(reporter);
+  FLAGS_benchmark_target_rel_ci = 0;
+  FLAGS_benchmark_target_rel_ci_max_time = 5.0;
+}
+
+TEST(TargetRelCITest, StopsOnceConverged) {
+  CapturingReporter reporter;
+  RunWithTarget(/*target=*/1e9, /*max_time=*/5.0, &reporter);
+  ASSERT_EQ(reporter.runs.size(), 3u);
+  for (const auto& run : reporter.runs) {
+    EXPECT_EQ(run.repetitions, 3);
+  }
+  const BenchmarkReporter::Run* rel_ci = reporter.FindAggregate("rel_ci");
+  ASSERT_NE(rel_ci, nullptr);
+  EXPECT_EQ(rel_ci->aggregate_unit, StatisticUnit::kPercentage);
+  EXPECT_EQ(rel_ci->repetitions, 3);
+  EXPECT_NE(reporter.FindAggregate("mean"), nullptr);
+}
+
+TEST(TargetRelCITest, StopsAtMaxTime) {
+  CapturingReporter reporter;
+  RunWithTarget(/*target=*/1e-12, /*max_time=*/0.05, &reporter);
+  ASSERT_GT(reporter.runs.size(), 3u);
+  const int64_t repetitions = static_cast<int64_t>(reporter.runs.size());
+  for (const auto& run : reporter.runs) {
+    EXPECT_EQ(run.repetitions, repetitions);
+  }
+  const BenchmarkReporter::Run* rel_ci = reporter.FindAggregate("rel_ci");
+  ASSERT_NE(rel_ci, nullptr);
+  EXPECT_GT(rel_ci->real_accumulated_time, 1e-12);
+}
+
+TEST(TargetRelCITest, ShortensOnlyTheDefaultMinTime) {
+  std::vector<BenchmarkInstance> benchmarks;
+  std::ostringstream err;
+  ASSERT_TRUE(FindBenchmarksInternal("^BM_RelCI/", &benchmarks, &err));
+  ASSERT_EQ(benchmarks.size(), 1u);
+
+  FLAGS_benchmark_target_rel_ci = 0.01;
+  EXPECT_DOUBLE_EQ(
+      BenchmarkRunner(benchmarks[0], nullptr, nullptr).GetMinTime(), 0.05);
+  // Given explicitly, even the default is used as is.
+  FLAGS_benchmark_min_time = "0.5s";
+  EXPECT_DOUBLE_EQ(
+      BenchmarkRunner(benchmarks[0], nullptr, nullptr).GetMinTime(), 0.5);
+  FLAGS_benchmark_target_rel_ci = 0;
+  EXPECT_DOUBLE_EQ(
+      BenchmarkRunner(benchmarks[0], nullptr, nullptr).GetMinTime(), 0.5);
+  FLAGS_benchmark_min_time = "";
+  EXPECT_DOUBLE_EQ(
+      BenchmarkRunner(benchmarks[0], nullptr, nullptr).GetMinTime(), 0.5);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,135 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "../src/cycleclock.h"
+#include "../src/thread_manager.h"
+#include "benchmark/reporter.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+TEST(ThreadManagerTest, SlotsArePaddedToCacheLines) {
+  ThreadManager manager(2);
+  const auto first =
+      reinterpret_cast<std::uintptr_t>(&manager.GetThreadResult(0));
+  const auto second =
+      reinterpret_cast<std::uintptr_t>(&manager.GetThreadResult(1));
+  EXPECT_EQ(first % BENCHMARK_INTERNAL_CACHELINE_SIZE, 0u);
+  EXPECT_GE(second - first,
+            static_cast<std::uintptr_t>(BENCHMARK_INTERNAL_CACHELINE_SIZE));
+}
+
+TEST(ThreadManagerTest, ThreadImbalanceWaitIsNotPerIteration) {
+  BenchmarkReporter::Run run;
+  run.time_unit = kMillisecond;
+  run.per_thread.resize(2);
+  run.per_thread[0].iterations = 1000;
+  run.per_thread[0].real_accumulated_time = 1.0;
+  run.per_thread[0].barrier_wait_time = 0.002;
+  run.per_thread[1].iterations = 500;
+  run.per_thread[1].real_accumulated_time = 1.0;
+  run.per_thread[1].barrier_wait_time = 0.004;
+
+  const BenchmarkReporter::Run::ThreadImbalance imbalance =
+      run.GetThreadImbalance();
+  EXPECT_DOUBLE_EQ(imbalance.max_min_ratio, 2.0);
+  EXPECT_DOUBLE_EQ(imbalance.straggler_time, 0.5);
+  EXPECT_DOUBLE_EQ(imbalance.barrier_wait_time, 3.0);
+}
+
+TEST(ThreadManagerTest, TakeResultsReducesAllThreads) {
+  ThreadManager manager(3);
+  for (int i = 0; i < 3; ++i) {
+    ThreadManager::ThreadResult& r = manager.GetThreadResult(i);
+    r.iterations = 10 * (i + 1);
+    r.real_time_used = 1.0 + i;
+    r.cpu_time_used = 0.5;
+    r.complexity_n = 1;
+    r.counters["items"] = Counter(i);
+  }
+  {
+    MutexLock l(manager.GetBenchmarkMutex());
+    manager.results.report_label_ = "label";
+  }
+
+  const ThreadManager::Result result = manager.TakeResults();
+  EXPECT_EQ(result.iterations, 60);
+  EXPECT_DOUBLE_EQ(result.real_time_used, 6.0);
+  EXPECT_DOUBLE_EQ(result.cpu_time_used, 1.5);
+  EXPECT_EQ(result.complexity_n, 3);
+  EXPECT_DOUBLE_EQ(result.counters.at("items").value, 3.0);
+  EXPECT_EQ(result.report_label_, "label");
+
+  ASSERT_EQ(result.per_thread.size(), 3u);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(result.per_thread[static_cast<size_t>(i)].iterations,
+              10 * (i + 1));
+  }
+}
+
+// Runs `num_threads` threads through `phases` barrier phases. Every thread
+// checks that no other one is still in the previous phase.
+void RunPhases(Barrier* barrier, int num_threads, int phases) {
+  std::atomic<int> arrived{0};
+  std::atomic<int> last_threads{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&] {
+      for (int phase = 0; phase < phases; ++phase) {
+        arrived.fetch_add(1);
+        if (barrier->wait()) last_threads.fetch_add(1);
+        EXPECT_GE(arrived.load(), (phase + 1) * num_threads);
+      }
+      barrier->removeThread();
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(last_threads.load(), phases);
+}
+
+TEST(BarrierTest, BlockingPhases) {
+  Barrier barrier(3);
+  RunPhases(&barrier, 3, 20);
+}
+
+TEST(BarrierTest, SpinningPhases) {
+  // Long enough to spin, short enough to also block on a loaded machine.
+  Barrier barrier(3, /*spin_cycles=*/100000);
+  RunPhases(&barrier, 3, 20);
+}
+
+TEST(BarrierTest, SpinningThreadsLeaveOnTheDeadline) {
+  constexpr int64_t kSpinCycles = 1000000;
+  Barrier barrier(2, kSpinCycles);
+  int64_t left = 0;
+  std::thread other([&] {
+    barrier.wait();
+    left = cycleclock::Now();
+    barrier.removeThread();
+  });
+  const int64_t entered = cycleclock::Now();
+  barrier.wait();
+  const int64_t now = cycleclock::Now();
+  other.join();
+  // The last thread to arrive waits for the deadline too.
+  EXPECT_GE(now - entered, kSpinCycles / 16);
+  EXPECT_GT(left, 0);
+}
+
+TEST(BarrierTest, RemovedThreadReleasesWaiters) {
+  Barrier barrier(2, /*spin_cycles=*/1000);
+  std::thread waiter([&] { barrier.wait(); });
+  // The other thread gives up without entering the barrier.
+  barrier.removeThread();
+  waiter.join();
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
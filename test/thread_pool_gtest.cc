@@ -0,0 +1,111 @@
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "../src/commandlineflags.h"
+#include "../src/thread_pool.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_bool(benchmark_thread_pool);
+BM_DECLARE_string(benchmark_filter);
+BM_DECLARE_int32(benchmark_repetitions);
+
+namespace internal {
+namespace {
+
+TEST(ThreadPoolTest, RunsEveryThreadIndexOnce) {
+  ThreadPool& pool = ThreadPool::Get();
+  // Each thread index only touches its own element.
+  std::vector<int> calls(8, 0);
+  pool.Run(8, [&](int thread_index) { ++calls[thread_index]; });
+  for (int c : calls) {
+    EXPECT_EQ(c, 1);
+  }
+}
+
+TEST(ThreadPoolTest, SingleThreadRunsInline) {
+  ThreadPool& pool = ThreadPool::Get();
+  const ThreadPool::Stats before = pool.GetStats();
+  std::thread::id id;
+  pool.Run(1, [&](int) { id = std::this_thread::get_id(); });
+  EXPECT_EQ(id, std::this_thread::get_id());
+  const ThreadPool::Stats after = pool.GetStats();
+  EXPECT_EQ(after.threads_created, before.threads_created);
+  EXPECT_EQ(after.threads_reused, before.threads_reused);
+}
+
+TEST(ThreadPoolTest, ReusesWorkersAndGrowsOnDemand) {
+  ThreadPool& pool = ThreadPool::Get();
+  pool.Run(4, [](int) {});
+  const int alive = pool.NumWorkers();
+  ASSERT_GE(alive, 3);
+
+  const ThreadPool::Stats before = pool.GetStats();
+  std::vector<std::thread::id> first(4);
+  std::vector<std::thread::id> second(4);
+  pool.Run(4, [&](int i) { first[i] = std::this_thread::get_id(); });
+  pool.Run(4, [&](int i) { second[i] = std::this_thread::get_id(); });
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(std::set<std::thread::id>(first.begin(), first.end()).size(), 4u);
+
+  ThreadPool::Stats after = pool.GetStats();
+  EXPECT_EQ(after.threads_created, before.threads_created);
+  EXPECT_EQ(after.threads_reused, before.threads_reused + 6);
+
+  const int wanted = alive + 3;
+  pool.Run(wanted, [](int) {});
+  after = pool.GetStats();
+  EXPECT_EQ(pool.NumWorkers(), wanted - 1);
+  EXPECT_EQ(after.threads_created, before.threads_created + 2);
+}
+
+class NullReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& /* report */) override {}
+};
+
+std::mutex ids_mutex;
+std::map<int, std::set<std::thread::id>>* const ids_by_index =
+    new std::map<int, std::set<std::thread::id>>();
+
+void BM_RecordThreadIds(State& state) {
+  {
+    std::lock_guard<std::mutex> l(ids_mutex);
+    (*ids_by_index)[state.thread_index()].insert(std::this_thread::get_id());
+  }
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_RecordThreadIds)->ThreadRange(2, 4)->Iterations(100);
+
+TEST(ThreadPoolTest, BenchmarkThreadsAreReusedAcrossRuns) {
+  ids_by_index->clear();
+  FLAGS_benchmark_thread_pool = true;
+  FLAGS_benchmark_filter = "BM_RecordThreadIds";
+  FLAGS_benchmark_repetitions = 3;
+  std::unique_ptr<BenchmarkReporter> reporter(new NullReporter());
+  RunSpecifiedBenchmarks(reporter.get());
+  FLAGS_benchmark_thread_pool = false;
+  FLAGS_benchmark_repetitions = 1;
+
+  // Every repetition of both instances has been served by the same thread for
+  // a given thread index.
+  ASSERT_EQ(ids_by_index->size(), 4u);
+  for (const auto& kv : *ids_by_index) {
+    EXPECT_EQ(kv.second.size(), 1u) << "thread index " << kv.first;
+  }
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
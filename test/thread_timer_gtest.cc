@@ -0,0 +1,88 @@
+#include <memory>
+#include <vector>
+
+#include "../src/commandlineflags.h"
+#include "../src/thread_timer.h"
+#include "../src/timers.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_bool(benchmark_fast_timing);
+BM_DECLARE_string(benchmark_filter);
+
+namespace internal {
+namespace {
+
+void Spin(double seconds) {
+  const double start = ChronoClockNow();
+  while (ChronoClockNow() - start < seconds) {
+  }
+}
+
+TEST(ThreadTimerTest, CycleClockCalibration) {
+  const CycleClockTimerCalibration& calibration =
+      GetCycleClockTimerCalibration();
+  EXPECT_GT(calibration.window_ticks, 0);
+  EXPECT_GE(calibration.overhead_ticks, 0);
+  EXPECT_GE(calibration.overhead, 0.0);
+  EXPECT_LE(calibration.residual_overhead, calibration.overhead);
+}
+
+TEST(ThreadTimerTest, CycleClockTimerExcludesPausedTime) {
+  ThreadTimer timer = ThreadTimer::CreateCycleClock(
+      /*measure_process_cpu_time_=*/false);
+  const double start = ChronoClockNow();
+  for (int i = 0; i < 10; ++i) {
+    timer.StartTimer();
+    Spin(1e-3);
+    timer.StopTimer();
+    Spin(1e-3);
+  }
+  timer.Finish();
+  const double elapsed = ChronoClockNow() - start;
+  // At least the ten timed milliseconds, but none of the ten paused ones. A
+  // loaded machine can stretch either, so there is no fixed upper bound.
+  EXPECT_GT(timer.real_time_used(), 0.009);
+  EXPECT_LT(timer.real_time_used(), elapsed - 0.009);
+  EXPECT_GT(timer.cpu_time_used(), 0.0);
+  EXPECT_LE(timer.cpu_time_used(), timer.real_time_used() * 1.5);
+}
+
+class CapturingReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& /*context*/) override { return true; }
+  void ReportRuns(const std::vector<Run>& report) override {
+    runs.insert(runs.end(), report.begin(), report.end());
+  }
+  std::vector<Run> runs;
+};
+
+void BM_FastPauseResume(State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_FastPauseResume)->Iterations(1000);
+
+TEST(ThreadTimerTest, FastTimingRunsBenchmarks) {
+  FLAGS_benchmark_fast_timing = true;
+  FLAGS_benchmark_filter = "BM_FastPauseResume";
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+  FLAGS_benchmark_fast_timing = false;
+
+  ASSERT_EQ(reporter.runs.size(), 1u);
+  EXPECT_EQ(reporter.runs[0].skipped, internal::NotSkipped);
+  EXPECT_EQ(reporter.runs[0].iterations, 1000);
+  EXPECT_GE(reporter.runs[0].real_accumulated_time, 0.0);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
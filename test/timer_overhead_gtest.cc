@@ -0,0 +1,107 @@
+#include <vector>
+
+#include "../src/commandlineflags.h"
+#include "../src/thread_manager.h"
+#include "../src/timer_overhead.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+
+BM_DECLARE_bool(benchmark_subtract_overhead);
+BM_DECLARE_string(benchmark_filter);
+
+namespace internal {
+namespace {
+
+TEST(TimerOverheadTest, Calibration) {
+  for (bool fast_timing : {false, true}) {
+    const TimerOverhead& overhead = GetTimerOverhead(fast_timing);
+    EXPECT_GT(overhead.empty_loop, 0.0);
+    EXPECT_LT(overhead.empty_loop, 1e-6);
+    EXPECT_GE(overhead.pause_resume, 0.0);
+    EXPECT_LT(overhead.pause_resume, 1e-3);
+    EXPECT_FALSE(overhead.subtracted);
+    // Calibrated only once.
+    EXPECT_EQ(&overhead, &GetTimerOverhead(fast_timing));
+  }
+}
+
+TEST(TimerOverheadTest, SubtractsPerIterationAndPerPause) {
+  TimerOverhead overhead;
+  overhead.empty_loop = 1.0;
+  overhead.pause_resume = 10.0;
+
+  ThreadManager::Result results;
+  results.per_thread.resize(2);
+  results.per_thread[0].iterations = 5;
+  results.per_thread[0].timer_slices = 3;
+  results.per_thread[0].real_time_used = 100;
+  results.per_thread[0].cpu_time_used = 50;
+  // Never goes below zero.
+  results.per_thread[1].iterations = 5;
+  results.per_thread[1].timer_slices = 1;
+  results.per_thread[1].real_time_used = 2;
+  results.per_thread[1].cpu_time_used = 2;
+
+  SubtractTimerOverhead(overhead, &results);
+  EXPECT_DOUBLE_EQ(results.per_thread[0].real_time_used, 75);
+  EXPECT_DOUBLE_EQ(results.per_thread[0].cpu_time_used, 25);
+  EXPECT_DOUBLE_EQ(results.per_thread[1].real_time_used, 0);
+  EXPECT_DOUBLE_EQ(results.per_thread[1].cpu_time_used, 0);
+  EXPECT_DOUBLE_EQ(results.real_time_used, 75);
+  EXPECT_DOUBLE_EQ(results.cpu_time_used, 25);
+}
+
+class CapturingReporter : public BenchmarkReporter {
+ public:
+  bool ReportContext(const Context& context) override {
+    overhead = context.timer_overhead;
+    return true;
+  }
+  void ReportRuns(const std::vector<Run>& report) override {
+    runs.insert(runs.end(), report.begin(), report.end());
+  }
+  TimerOverhead overhead;
+  std::vector<Run> runs;
+};
+
+void BM_Overhead(State& state) {
+  for (auto _ : state) {
+  }
+}
+BENCHMARK(BM_Overhead)->Iterations(1000);
+BENCHMARK(BM_Overhead)->Iterations(1000)->UseManualTime();
+
+TEST(TimerOverheadTest, RunsAreMarked) {
+  FLAGS_benchmark_filter = "BM_Overhead";
+  FLAGS_benchmark_subtract_overhead = true;
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+  FLAGS_benchmark_subtract_overhead = false;
+
+  EXPECT_TRUE(reporter.overhead.subtracted);
+  ASSERT_EQ(reporter.runs.size(), 2u);
+  EXPECT_TRUE(reporter.runs[0].overhead_subtracted);
+  EXPECT_GE(reporter.runs[0].real_accumulated_time, 0.0);
+  EXPECT_FALSE(reporter.runs[1].overhead_subtracted);
+}
+
+TEST(TimerOverheadTest, NotCalibratedUnlessSubtracted) {
+  FLAGS_benchmark_filter = "BM_Overhead";
+  CapturingReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+
+  EXPECT_FALSE(reporter.overhead.subtracted);
+  EXPECT_EQ(reporter.overhead.empty_loop, 0.0);
+  EXPECT_EQ(reporter.overhead.pause_resume, 0.0);
+  ASSERT_EQ(reporter.runs.size(), 2u);
+  EXPECT_FALSE(reporter.runs[0].overhead_subtracted);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../src/working_set.h"
+#include "benchmark/benchmark_api.h"
+#include "benchmark/registration.h"
+#include "benchmark/reporter.h"
+#include "benchmark/state.h"
+#include "benchmark/sysinfo.h"
+#include "benchmark/utils.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace benchmark {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::vector<CPUInfo::CacheInfo> TestCaches() {
+  return {{"Data", 1, 32 << 10, 1},
+          {"Instruction", 1, 32 << 10, 1},
+          {"Unified", 2, 1 << 20, 2},
+          {"Unified", 3, 16 << 20, 8}};
+}
+
+TEST(WorkingSetTest, SizesStraddleEveryLevel) {
+  EXPECT_THAT(WorkingSetSizes(TestCaches()),
+              ElementsAre(16 << 10, 64 << 10, 512 << 10, 2 << 20, 8 << 20,
+                          32 << 20));
+}
+
+TEST(WorkingSetTest, SizesWithoutCacheInfo) {
+  EXPECT_THAT(WorkingSetSizes({}),
+              ElementsAre(16 << 10, 64 << 10, 512 << 10, 2 << 20, 16 << 20,
+                          64 << 20));
+}
+
+TEST(WorkingSetTest, CacheLevelOf) {
+  const std::vector<CPUInfo::CacheInfo> caches = TestCaches();
+  EXPECT_EQ(CacheLevelOf(1, 1, caches), "L1");
+  EXPECT_EQ(CacheLevelOf(32 << 10, 1, caches), "L1");
+  EXPECT_EQ(CacheLevelOf((32 << 10) + 1, 1, caches), "L2");
+  EXPECT_EQ(CacheLevelOf(2 << 20, 1, caches), "L3");
+  EXPECT_EQ(CacheLevelOf(64 << 20, 1, caches), "DRAM");
+  EXPECT_EQ(CacheLevelOf(64 << 20, 1, {}), "");
+}
+
+TEST(WorkingSetTest, CacheLevelOfThreads) {
+  const std::vector<CPUInfo::CacheInfo> caches = TestCaches();
+  // Every thread has an L1 of its own.
+  EXPECT_EQ(CacheLevelOf(24 << 10, 4, caches), "L1");
+  // Two cores share an L2, and eight an L3.
+  EXPECT_EQ(CacheLevelOf(600 << 10, 1, caches), "L2");
+  EXPECT_EQ(CacheLevelOf(600 << 10, 4, caches), "L3");
+  EXPECT_EQ(CacheLevelOf(4 << 20, 4, caches), "L3");
+  EXPECT_EQ(CacheLevelOf(4 << 20, 8, caches), "DRAM");
+  EXPECT_EQ(CacheLevelOf(4 << 20, 16, caches), "DRAM");
+
+  // With two hardware threads per core, the L3 is shared by eight cores.
+  const std::vector<CPUInfo::CacheInfo> smt_caches = {
+      {"Data", 1, 32 << 10, 2},
+      {"Unified", 2, 1 << 20, 2},
+      {"Unified", 3, 16 << 20, 16}};
+  EXPECT_EQ(CacheLevelOf(600 << 10, 4, smt_caches), "L2");
+  EXPECT_EQ(CacheLevelOf(2 << 20, 8, smt_caches), "L3");
+  EXPECT_EQ(CacheLevelOf(2 << 20, 16, smt_caches), "L3");
+}
+
+TEST(WorkingSetTest, CreateWorkingSetRangeDividesByElementSize) {
+  const std::vector<int64_t> bytes = CreateWorkingSetRange(1);
+  const std::vector<int64_t> doubles = CreateWorkingSetRange(8);
+  ASSERT_EQ(bytes.size(), doubles.size());
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    EXPECT_EQ(doubles[i], bytes[i] / 8);
+    if (i > 0) {
+      EXPECT_GT(bytes[i], bytes[i - 1]);
+    }
+  }
+}
+
+class TestReporter : public ConsoleReporter {
+ public:
+  bool ReportContext(const Context& /*unused*/) override { return true; }
+  void PrintHeader(const Run&) override {}
+  void PrintRunData(const Run& run) override { runs.push_back(run); }
+
+  std::vector<Run> runs;
+};
+
+TEST(WorkingSetTest, AnnotatesRuns) {
+  RegisterBenchmark("BM_WorkingSet",
+                    [](State& state) {
+                      std::vector<char> data(4096);
+                      for (auto _ : state) {
+                        DoNotOptimize(data.data());
+                      }
+                      state.SetWorkingSetBytes(4096);
+                      state.SetBytesProcessed(state.iterations() * 4096);
+                    })
+      ->Iterations(1000);
+  TestReporter reporter;
+  RunSpecifiedBenchmarks(&reporter);
+  ClearRegisteredBenchmarks();
+  ASSERT_EQ(reporter.runs.size(), 1u);
+  const BenchmarkReporter::Run& run = reporter.runs[0];
+  EXPECT_EQ(run.working_set_bytes, 4096);
+  EXPECT_EQ(run.cache_level, CacheLevelOf(4096, 1, CPUInfo::Get().caches));
+  EXPECT_GT(run.peak_memory_bandwidth, 0);
+  EXPECT_EQ(run.counters.count("bandwidth_utilization"), 1u);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace benchmark
@@ -1458,6 +1458,148 @@ class TestReportDifferenceForPercentageAggregates(unittest.TestCase):
             assert_measurements(self, out, expected)
 
 
+class TestReadJsonResults(unittest.TestCase):
+    def read(self, text):
+        import io
+
+        import util
+
+        return util.read_json_results(io.StringIO(text))
+
+    def test_json_on_one_line(self):
+        results = self.read(
+            '{"context": {"a": 1}, "benchmarks": [{"name": "BM_A"}, '
+            '{"name": "BM_B"}]}'
+        )
+        self.assertEqual(results["context"], {"a": 1})
+        self.assertEqual(
+            [b["name"] for b in results["benchmarks"]], ["BM_A", "BM_B"]
+        )
+
+    def test_json_lines(self):
+        results = self.read(
+            '{"context": {"a": 1}}\n{"name": "BM_A"}\n{"name": "BM_B"}\n'
+            '{"name": "BM_'
+        )
+        self.assertEqual(results["context"], {"a": 1})
+        self.assertEqual(
+            [b["name"] for b in results["benchmarks"]], ["BM_A", "BM_B"]
+        )
+
+    def test_json_lines_without_benchmarks(self):
+        results = self.read('{"context": {"a": 1}}\n')
+        self.assertEqual(results, {"context": {"a": 1}, "benchmarks": []})
+
+
+class TestMergeShards(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        import importlib.util
+
+        path = os.path.join(
+            os.path.dirname(os.path.dirname(os.path.realpath(__file__))),
+            "merge_shards.py",
+        )
+        spec = importlib.util.spec_from_file_location("merge_shards", path)
+        cls.merge_shards = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(cls.merge_shards)
+
+    @staticmethod
+    def shard(index, count, benchmarks):
+        return {
+            "context": {"a": 1, "shard_index": index, "shard_count": count},
+            "benchmarks": benchmarks,
+        }
+
+    @staticmethod
+    def result(name, family, instance, aggregate=None):
+        run = {
+            "name": name,
+            "family_index": family,
+            "per_family_instance_index": instance,
+        }
+        if aggregate is not None:
+            run["aggregate_name"] = aggregate
+        return run
+
+    def test_unsharded_order(self):
+        run = self.result
+        shard0 = self.shard(
+            0,
+            2,
+            [
+                run("BM_A/1", 0, 0),
+                run("BM_A/2", 0, 1),
+                run("BM_A_BigO", 0, 0, "BigO"),
+                run("BM_A_RMS", 0, 0, "RMS"),
+                run("BM_C/2", 2, 1),
+            ],
+        )
+        shard1 = self.shard(
+            1,
+            2,
+            [
+                run("BM_B", 1, 0),
+                run("BM_B_mean", 1, 0, "mean"),
+                run("BM_C/1", 2, 0),
+            ],
+        )
+        merged = self.merge_shards.merge_reports([shard1, shard0])
+        self.assertEqual(merged["context"], {"a": 1})
+        self.assertEqual(
+            [b["name"] for b in merged["benchmarks"]],
+            [
+                "BM_A/1",
+                "BM_A/2",
+                "BM_A_BigO",
+                "BM_A_RMS",
+                "BM_B",
+                "BM_B_mean",
+                "BM_C/1",
+                "BM_C/2",
+            ],
+        )
+
+    def test_missing_shard(self):
+        with self.assertRaisesRegex(ValueError, "missing shards: 1, 2"):
+            self.merge_shards.merge_reports([self.shard(0, 3, [])])
+
+    def test_duplicate_shard(self):
+        with self.assertRaisesRegex(ValueError, "shard 0 is given twice"):
+            self.merge_shards.merge_reports(
+                [self.shard(0, 2, []), self.shard(0, 2, [])]
+            )
+
+    def test_unsharded_report(self):
+        with self.assertRaisesRegex(ValueError, "unsharded"):
+            self.merge_shards.merge_reports(
+                [{"context": {}, "benchmarks": []}]
+            )
+
+    def test_json_lines(self):
+        import tempfile
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "shard.jsonl")
+            with open(path, "w") as f:
+                f.write(
+                    '{"context": {"shard_index": 0, "shard_count": 1}}\n'
+                    '{"name": "BM_A", "family_index": 0, '
+                    '"per_family_instance_index": 0}\n'
+                )
+            report = self.merge_shards.read_report(path)
+            self.assertEqual(
+                [b["name"] for b in report["benchmarks"]], ["BM_A"]
+            )
+
+            with open(path, "w") as f:
+                f.write('{"context": {"shard_index": 0, "shard_count": 1}}\n')
+            report = self.merge_shards.read_report(path)
+            self.assertEqual(report["benchmarks"], [])
+            merged = self.merge_shards.merge_reports([report])
+            self.assertEqual(merged, {"context": {}, "benchmarks": []})
+
+
 class TestReportSorting(unittest.TestCase):
     @classmethod
     def setUpClass(cls):
@@ -42,14 +42,58 @@ def is_executable_file(filename):
         return magic_bytes == b"\x7fELF"
 
 
+def read_json_results(f):
+    """
+    Read benchmark output in either the JSON or the JSON Lines format from the
+    open file 'f' and return it as the JSON object.
+
+    JSON Lines output holds the context and then one benchmark per line. It is
+    converted to the same object as the JSON output. A truncated last line, as
+    left behind by a run that did not finish, is ignored.
+    """
+    text = f.read()
+    try:
+        results = json.loads(text)
+    except ValueError:
+        results = None
+    if isinstance(results, dict):
+        # JSON Lines output of no benchmarks is just the context.
+        results.setdefault("benchmarks", [])
+        return results
+
+    lines = text.splitlines()
+    try:
+        first = json.loads(lines[0]) if lines else None
+    except ValueError:
+        first = None
+    if not isinstance(first, dict):
+        return json.loads(text)
+
+    results = {"benchmarks": []}
+    for i, line in enumerate(lines):
+        if not line.strip():
+            continue
+        try:
+            entry = json.loads(line)
+        except ValueError:
+            if i == len(lines) - 1:
+                break
+            raise
+        if "context" in entry:
+            results["context"] = entry["context"]
+        else:
+            results["benchmarks"].append(entry)
+    return results
+
+
 def is_json_file(filename):
     """
-    Returns 'True' if 'filename' names a valid JSON output file.
+    Returns 'True' if 'filename' names a valid JSON or JSON Lines output file.
     'False' otherwise.
     """
     try:
         with open(filename) as f:
-            json.load(f)
+            read_json_results(f)
         return True
     except BaseException:
         pass
@@ -128,7 +172,8 @@ def load_benchmark_results(fname, benchmark_filter):
     one used by the C++ code, which may produce different results
     in complex cases.
 
-    REQUIRES: 'fname' names a file containing JSON benchmark output.
+    REQUIRES: 'fname' names a file containing JSON or JSON Lines benchmark
+    output.
     """
 
     def benchmark_wanted(benchmark):
@@ -138,7 +183,7 @@ def load_benchmark_results(fname, benchmark_filter):
         return re.search(benchmark_filter, name) is not None
 
     with open(fname) as f:
-        results = json.load(f)
+        results = read_json_results(f)
         if "json_schema_version" in results.get("context", {}):
             json_schema_version = results["context"]["json_schema_version"]
             if json_schema_version != 1:
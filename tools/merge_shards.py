@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+
+"""
+merge_shards.py - merge the JSON reports of the shards of a benchmark suite
+"""
+
+import argparse
+import json
+import sys
+
+
+def read_report(path):
+    """
+    Read a report written by the JSON reporter, in either of its formats.
+    """
+    with open(path) as f:
+        text = f.read()
+    try:
+        report = json.loads(text)
+        # A JSON Lines report of no runs is just the context.
+        report.setdefault("benchmarks", [])
+        return report
+    except json.JSONDecodeError:
+        pass
+    # JSON Lines: the context, then one run per line.
+    context = None
+    benchmarks = []
+    for line in text.splitlines():
+        if not line.strip():
+            continue
+        value = json.loads(line)
+        if "context" in value:
+            context = value["context"]
+        else:
+            benchmarks.append(value)
+    return {"context": context, "benchmarks": benchmarks}
+
+
+def merge_reports(reports):
+    """
+    Merge the reports of all the shards of a run into one report, with the
+    runs in the order in which an unsharded run would report them. Raises
+    ValueError if the reports are not the shards of one run.
+    """
+    shards = {}
+    count = None
+    for report in reports:
+        context = report.get("context") or {}
+        if "shard_index" not in context or "shard_count" not in context:
+            raise ValueError("report of an unsharded run")
+        index = int(context["shard_index"])
+        if count is None:
+            count = int(context["shard_count"])
+        elif int(context["shard_count"]) != count:
+            raise ValueError("reports of different shard counts")
+        if index in shards:
+            raise ValueError("shard %d is given twice" % index)
+        shards[index] = report
+    missing = sorted(set(range(count or 0)) - set(shards))
+    if missing:
+        raise ValueError(
+            "missing shards: %s" % ", ".join(str(i) for i in missing)
+        )
+
+    context = dict(shards[0]["context"])
+    del context["shard_index"]
+    del context["shard_count"]
+    benchmarks = [run for i in range(count) for run in shards[i]["benchmarks"]]
+    # The family indices are those of the unsharded run. The sort is stable,
+    # so the repetitions and aggregates of an instance stay in order.
+    benchmarks.sort(key=unsharded_order)
+    return {"context": context, "benchmarks": benchmarks}
+
+
+def unsharded_order(run):
+    """
+    Sort key that puts the runs of a report in the order of an unsharded run.
+    """
+    # The complexity of a family is reported after all of its instances, but
+    # has the instance index of the first one.
+    is_complexity = run.get("aggregate_name") in ("BigO", "RMS")
+    return (
+        run["family_index"],
+        is_complexity,
+        run["per_family_instance_index"],
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Merge the JSON reports of the shards of a benchmark "
+        "suite, run with --benchmark_shard_index and --benchmark_shard_count, "
+        "into one report."
+    )
+    parser.add_argument("reports", nargs="+", help="the report of every shard")
+    parser.add_argument(
+        "-o",
+        "--output",
+        default="-",
+        help="where to write the merged report; standard output by default",
+    )
+    args = parser.parse_args()
+
+    try:
+        merged = merge_reports([read_report(path) for path in args.reports])
+    except (OSError, ValueError, KeyError) as e:
+        print("merge_shards.py: error: %s" % e, file=sys.stderr)
+        return 1
+    if args.output == "-":
+        json.dump(merged, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+    else:
+        with open(args.output, "w") as f:
+            json.dump(merged, f, indent=2)
+            f.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())